@@ -0,0 +1,46 @@
+#include <benchmark/benchmark.h>
+
+#include <metrics/counter.hpp>
+#include <metrics/registry.hpp>
+
+namespace metrics {
+namespace benchmarks {
+namespace {
+
+const registry_t registry;
+
+auto atomic_inc(benchmark::State& state) -> void {
+    static auto counter = registry.counter<std::int64_t>("metrics.benchmarks.atomic");
+
+    for (auto _ : state) {
+        counter->fetch_add(1, std::memory_order_relaxed);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+auto striped_inc(benchmark::State& state) -> void {
+    static auto counter = registry.striped_counter("metrics.benchmarks.striped");
+
+    for (auto _ : state) {
+        counter->inc();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+auto striped_get(benchmark::State& state) -> void {
+    static auto counter = registry.striped_counter("metrics.benchmarks.striped");
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(counter->get());
+    }
+}
+
+BENCHMARK(atomic_inc)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(striped_inc)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(striped_get);
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace metrics
@@ -0,0 +1,86 @@
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <random>
+
+#include <benchmark/benchmark.h>
+
+#include <metrics/accumulator/decaying/exponentially.hpp>
+
+namespace metrics {
+namespace benchmarks {
+namespace {
+
+/// The previous map-based reservoir, kept as a baseline. Rescaling is omitted, because it never
+/// happens during the benchmark.
+class map_reservoir_t {
+    typedef accumulator::decaying::exponentially_t::clock_type clock_type;
+    typedef accumulator::decaying::exponentially_t::sample_type sample_type;
+
+    std::size_t size;
+    double alpha;
+    clock_type::time_point start_time;
+
+    std::map<double, sample_type> samples;
+    std::mt19937 gen;
+    std::uniform_real_distribution<> uniform_dist;
+    std::mutex mutex;
+
+public:
+    map_reservoir_t(std::size_t size, double alpha) :
+        size(size),
+        alpha(alpha),
+        start_time(clock_type::now()),
+        gen(100500),
+        uniform_dist(0.0, 1.0)
+    {}
+
+    auto update(std::uint64_t value) -> void {
+        const auto u = uniform_dist(gen);
+        if (u == 0.0) {
+            return;
+        }
+
+        const auto diff = std::chrono::duration_cast<std::chrono::seconds>(clock_type::now() - start_time);
+        const auto w = std::exp(alpha * diff.count());
+        const auto prior = w / u;
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        samples.emplace(prior, sample_type{value, w});
+
+        if (samples.size() > size) {
+            samples.erase(std::begin(samples));
+        }
+    }
+};
+
+auto map_reservoir_update(benchmark::State& state) -> void {
+    map_reservoir_t reservoir(1024, 0.015);
+
+    std::uint64_t value = 0;
+    for (auto _ : state) {
+        reservoir.update(value++);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+auto exponentially_update(benchmark::State& state) -> void {
+    static accumulator::decaying::exponentially_t reservoir(1024, 0.015, std::chrono::hours(1), 100500);
+
+    std::uint64_t value = 0;
+    for (auto _ : state) {
+        reservoir.update(value++);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(map_reservoir_update);
+BENCHMARK(exponentially_update)->ThreadRange(1, 8)->UseRealTime();
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace metrics
@@ -0,0 +1,141 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include <metrics/accumulator/hdr/histogram.hpp>
+#include <metrics/accumulator/sketch/ddsketch.hpp>
+#include <metrics/accumulator/sketch/tdigest.hpp>
+#include <metrics/accumulator/sliding/time_window.hpp>
+#include <metrics/accumulator/sliding/window.hpp>
+
+namespace metrics {
+namespace benchmarks {
+namespace {
+
+auto hdr_update(benchmark::State& state) -> void {
+    static accumulator::hdr::histogram_t histogram;
+
+    std::uint64_t value = 0;
+    for (auto _ : state) {
+        histogram.update(value);
+        value += 997;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+auto time_window_update(benchmark::State& state) -> void {
+    static accumulator::sliding::time_window_t window;
+
+    std::uint64_t value = 0;
+    for (auto _ : state) {
+        window.update(value);
+        value += 997;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+auto ddsketch_update(benchmark::State& state) -> void {
+    static accumulator::sketch::ddsketch_t sketch;
+
+    std::uint64_t value = 0;
+    for (auto _ : state) {
+        sketch.update(value);
+        value += 997;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+auto tdigest_update(benchmark::State& state) -> void {
+    static accumulator::sketch::tdigest_t digest;
+
+    std::uint64_t value = 0;
+    for (auto _ : state) {
+        digest.update(value);
+        value += 997;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+/// Returns durations of a batch, that are close to each other, as they usually are.
+auto batch(std::size_t size) -> std::vector<std::uint64_t> {
+    std::vector<std::uint64_t> result(size);
+    for (std::size_t id = 0; id < size; ++id) {
+        result[id] = 1000000 + (id * 7919) % 100000;
+    }
+
+    return result;
+}
+
+template<class Accumulate>
+auto single_update(benchmark::State& state) -> void {
+    Accumulate accumulator;
+    const auto values = batch(static_cast<std::size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        for (auto value : values) {
+            accumulator.update(value);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<class Accumulate>
+auto batch_update(benchmark::State& state) -> void {
+    Accumulate accumulator;
+    const auto values = batch(static_cast<std::size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        accumulator.update(values.data(), values.size());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+auto hdr_snapshot(benchmark::State& state) -> void {
+    accumulator::hdr::histogram_t histogram;
+    for (std::uint64_t value = 0; value < 1000000; ++value) {
+        histogram.update(value * 997);
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(histogram.snapshot().p99());
+    }
+}
+
+auto window_snapshot(benchmark::State& state) -> void {
+    accumulator::sliding::window_t window;
+    for (std::uint64_t value = 0; value < 1000000; ++value) {
+        window.update(value * 997);
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(window.snapshot().p99());
+    }
+}
+
+BENCHMARK(hdr_update)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(ddsketch_update)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(tdigest_update)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(hdr_snapshot);
+BENCHMARK(window_snapshot);
+BENCHMARK(time_window_update)->ThreadRange(1, 8)->UseRealTime();
+
+BENCHMARK_TEMPLATE(single_update, accumulator::sliding::window_t)->Arg(256);
+BENCHMARK_TEMPLATE(batch_update, accumulator::sliding::window_t)->Arg(256);
+BENCHMARK_TEMPLATE(single_update, accumulator::hdr::histogram_t)->Arg(256);
+BENCHMARK_TEMPLATE(batch_update, accumulator::hdr::histogram_t)->Arg(256);
+BENCHMARK_TEMPLATE(single_update, accumulator::sliding::time_window_t)->Arg(256);
+BENCHMARK_TEMPLATE(batch_update, accumulator::sliding::time_window_t)->Arg(256);
+BENCHMARK_TEMPLATE(single_update, accumulator::sketch::ddsketch_t)->Arg(256);
+BENCHMARK_TEMPLATE(batch_update, accumulator::sketch::ddsketch_t)->Arg(256);
+BENCHMARK_TEMPLATE(single_update, accumulator::sketch::tdigest_t)->Arg(256);
+BENCHMARK_TEMPLATE(batch_update, accumulator::sketch::tdigest_t)->Arg(256);
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace metrics
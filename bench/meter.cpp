@@ -0,0 +1,38 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+
+#include <metrics/ticker.hpp>
+
+#include <src/meter.hpp>
+
+namespace metrics {
+namespace benchmarks {
+namespace {
+
+auto meter_mark(benchmark::State& state) -> void {
+    static detail::meter_t meter;
+
+    for (auto _ : state) {
+        meter.mark();
+    }
+}
+
+auto meter_mark_ticked(benchmark::State& state) -> void {
+    static const auto meter = [] {
+        std::unique_ptr<detail::meter_t> result(new detail::meter_t);
+        result->attach(std::make_shared<ticker_t>());
+        return result;
+    }();
+
+    for (auto _ : state) {
+        meter->mark();
+    }
+}
+
+BENCHMARK(meter_mark)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(meter_mark_ticked)->ThreadRange(1, 8)->UseRealTime();
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace metrics
@@ -0,0 +1,132 @@
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <boost/optional/optional.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <metrics/accumulator/sliding/window.hpp>
+#include <metrics/registry.hpp>
+#include <metrics/timer.hpp>
+
+namespace {
+
+/// Number of heap allocations made by the current thread, used to report allocations per lookup.
+thread_local std::size_t allocations = 0;
+
+}  // namespace
+
+// Both replacements must not be inlined, otherwise GCC complains about mismatched new/free pair.
+__attribute__((noinline)) auto operator new(std::size_t size) -> void* {
+    ++allocations;
+
+    if (auto ptr = std::malloc(size)) {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) auto operator delete(void* ptr) noexcept -> void {
+    std::free(ptr);
+}
+
+namespace metrics {
+namespace benchmarks {
+namespace {
+
+const registry_t registry;
+
+auto timer_lookup(benchmark::State& state) -> void {
+    auto timer = registry.timer("metrics.benchmarks.timer", {{"source", "node"}, {"service", "storage"}});
+
+    const auto before = allocations;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(registry.timer("metrics.benchmarks.timer", {
+            {"source", "node"},
+            {"service", "storage"}
+        }));
+    }
+
+    state.counters["allocations"] = benchmark::Counter(
+        allocations - before, benchmark::Counter::kAvgIterations
+    );
+}
+
+auto timer_lookup_view(benchmark::State& state) -> void {
+    auto timer = registry.timer("metrics.benchmarks.timer", {{"source", "node"}, {"service", "storage"}});
+
+    const tags_view_t::value_type tags[] = {{"source", "node"}, {"service", "storage"}};
+    const tags_view_t view("metrics.benchmarks.timer", tags);
+
+    const auto before = allocations;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(registry.timer(view));
+    }
+
+    state.counters["allocations"] = benchmark::Counter(
+        allocations - before, benchmark::Counter::kAvgIterations
+    );
+}
+
+auto timer_handle(benchmark::State& state) -> void {
+    const auto before = allocations;
+    for (auto _ : state) {
+        auto& timer = METRICS_CACHED(registry, timer("metrics.benchmarks.timer", {
+            {"source", "node"},
+            {"service", "storage"}
+        }));
+
+        benchmark::DoNotOptimize(timer.get());
+    }
+
+    state.counters["allocations"] = benchmark::Counter(
+        allocations - before, benchmark::Counter::kAvgIterations
+    );
+}
+
+/// Registers lots of counters, a few of which are tagged with `source=node`.
+auto populate(registry_t& registry, int size) -> std::vector<shared_metric<std::atomic<std::int64_t>>> {
+    std::vector<shared_metric<std::atomic<std::int64_t>>> result;
+    for (int id = 0; id < size; ++id) {
+        result.push_back(registry.counter<std::int64_t>("metrics.benchmarks.counter", {
+            {"id", std::to_string(id)},
+            {"source", id % 1000 == 0 ? "node" : "other"}
+        }));
+    }
+
+    return result;
+}
+
+auto select_query(benchmark::State& state) -> void {
+    registry_t registry;
+    const auto metrics = populate(registry, state.range(0));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(registry.select([](const tagged_t& metric) -> bool {
+            return metric.tag("source") && *metric.tag("source") == "node";
+        }));
+    }
+}
+
+auto select_filter(benchmark::State& state) -> void {
+    registry_t registry;
+    const auto metrics = populate(registry, state.range(0));
+
+    const auto filter = filter_t::eq("source", "node");
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(registry.select(filter));
+    }
+}
+
+BENCHMARK(timer_lookup)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(timer_lookup_view)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(timer_handle)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(select_query)->Arg(1000)->Arg(100000);
+BENCHMARK(select_filter)->Arg(1000)->Arg(100000);
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace metrics
@@ -0,0 +1,96 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <src/stats.hpp>
+
+namespace metrics {
+namespace benchmarks {
+namespace {
+
+auto generate(std::size_t size) -> std::vector<std::uint64_t> {
+    std::mt19937_64 gen(100500);
+    std::uniform_int_distribution<std::uint64_t> dist(1000000, 10000000);
+
+    std::vector<std::uint64_t> result(size);
+    for (auto& value : result) {
+        value = dist(gen);
+    }
+
+    return result;
+}
+
+/// Baseline, which walks the values separately for min and max and the sum, and then again for
+/// the standard deviation.
+auto stats_two_pass(benchmark::State& state) -> void {
+    const auto values = generate(static_cast<std::size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        std::uint64_t min = values[0];
+        std::uint64_t max = values[0];
+        double sum = 0.0;
+        for (auto value : values) {
+            min = std::min(min, value);
+            max = std::max(max, value);
+            sum += value;
+        }
+
+        const auto mean = sum / values.size();
+
+        double m2 = 0.0;
+        for (auto value : values) {
+            const auto diff = value - mean;
+            m2 += diff * diff;
+        }
+
+        benchmark::DoNotOptimize(min);
+        benchmark::DoNotOptimize(max);
+        benchmark::DoNotOptimize(m2);
+    }
+}
+
+auto stats_scalar(benchmark::State& state) -> void {
+    const auto values = generate(static_cast<std::size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(detail::scalar::moments(values.data(), values.size()));
+    }
+}
+
+auto stats_vectorized(benchmark::State& state) -> void {
+    const auto values = generate(static_cast<std::size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(detail::moments(values.data(), values.size()));
+    }
+}
+
+auto weighted_stats_scalar(benchmark::State& state) -> void {
+    const auto values = generate(static_cast<std::size_t>(state.range(0)));
+    const std::vector<double> weights(values.size(), 1.0 / values.size());
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(detail::scalar::moments(values.data(), weights.data(), values.size()));
+    }
+}
+
+auto weighted_stats_vectorized(benchmark::State& state) -> void {
+    const auto values = generate(static_cast<std::size_t>(state.range(0)));
+    const std::vector<double> weights(values.size(), 1.0 / values.size());
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(detail::moments(values.data(), weights.data(), values.size()));
+    }
+}
+
+BENCHMARK(stats_two_pass)->Range(1 << 10, 1 << 16);
+BENCHMARK(stats_scalar)->Range(1 << 10, 1 << 16);
+BENCHMARK(stats_vectorized)->Range(1 << 10, 1 << 16);
+BENCHMARK(weighted_stats_scalar)->Range(1 << 10, 1 << 16);
+BENCHMARK(weighted_stats_vectorized)->Range(1 << 10, 1 << 16);
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace metrics
@@ -0,0 +1,43 @@
+#include <benchmark/benchmark.h>
+
+#include <metrics/tags.hpp>
+
+namespace metrics {
+namespace benchmarks {
+namespace {
+
+auto tags_construct(benchmark::State& state) -> void {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tags_t("metrics.benchmarks.tags", {
+            {"source", "node"},
+            {"service", "storage"},
+            {"type", "timer"}
+        }));
+    }
+}
+
+auto tags_equal(benchmark::State& state) -> void {
+    const tags_t tags1("metrics.benchmarks.tags", {{"source", "node"}, {"service", "storage"}});
+    const tags_t tags2("metrics.benchmarks.tags", {{"source", "node"}, {"service", "storage"}});
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tags1 == tags2);
+    }
+}
+
+auto tags_less(benchmark::State& state) -> void {
+    const tags_t tags1("metrics.benchmarks.tags", {{"source", "node"}, {"service", "storage"}});
+    const tags_t tags2("metrics.benchmarks.tags", {{"source", "node"}, {"service", "storage2"}});
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tags1 < tags2);
+    }
+}
+
+BENCHMARK(tags_construct);
+BENCHMARK(tags_equal);
+BENCHMARK(tags_less);
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace metrics
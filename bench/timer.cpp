@@ -0,0 +1,118 @@
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <vector>
+
+#include <metrics/accumulator/hdr/histogram.hpp>
+#include <metrics/clock.hpp>
+#include <metrics/registry.hpp>
+#include <metrics/timer.hpp>
+
+namespace metrics {
+namespace benchmarks {
+namespace {
+
+template<typename Clock>
+auto clock_now(benchmark::State& state) -> void {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Clock::now());
+    }
+}
+
+auto tsc_ticks(benchmark::State& state) -> void {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tsc_clock_t::ticks());
+    }
+}
+
+auto timer_context(benchmark::State& state) -> void {
+    registry_t registry;
+    auto timer = registry.timer<accumulator::hdr::histogram_t>("timer");
+
+    for (auto _ : state) {
+        timer->context();
+    }
+}
+
+auto tsc_timer_context(benchmark::State& state) -> void {
+    registry_t registry;
+    auto timer = registry.tsc_timer<accumulator::hdr::histogram_t>("timer");
+
+    for (auto _ : state) {
+        timer->context();
+    }
+}
+
+auto sampled_timer_context(benchmark::State& state) -> void {
+    registry_t registry;
+    auto timer = registry.timer<accumulator::hdr::histogram_t>("timer", {}, state.range(0));
+
+    for (auto _ : state) {
+        timer->context();
+    }
+}
+
+auto timer_update(benchmark::State& state) -> void {
+    registry_t registry;
+    auto timer = registry.timer<accumulator::hdr::histogram_t>("timer");
+
+    const std::vector<timer_t::duration_type> durations(256, std::chrono::milliseconds(1));
+
+    for (auto _ : state) {
+        for (auto duration : durations) {
+            timer->update(duration);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(durations.size()));
+}
+
+auto timer_batch_update(benchmark::State& state) -> void {
+    registry_t registry;
+    auto timer = registry.timer<accumulator::hdr::histogram_t>("timer");
+
+    const std::vector<timer_t::duration_type> durations(256, std::chrono::milliseconds(1));
+
+    for (auto _ : state) {
+        timer->update(durations.data(), durations.size());
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(durations.size()));
+}
+
+auto static_timer_context(benchmark::State& state) -> void {
+    registry_t registry;
+    auto timer = registry.static_timer<accumulator::hdr::histogram_t>("timer");
+
+    for (auto _ : state) {
+        timer->context();
+    }
+}
+
+auto static_tsc_timer_context(benchmark::State& state) -> void {
+    registry_t registry;
+    // The registry keeps timers weakly, so the original one must outlive the benchmark.
+    auto origin = registry.tsc_timer<accumulator::hdr::histogram_t>("timer");
+    auto timer = registry.static_timer<accumulator::hdr::histogram_t>("timer");
+
+    for (auto _ : state) {
+        timer->context();
+    }
+}
+
+BENCHMARK_TEMPLATE(clock_now, std::chrono::high_resolution_clock);
+BENCHMARK_TEMPLATE(clock_now, std::chrono::steady_clock);
+BENCHMARK_TEMPLATE(clock_now, coarse_clock_t);
+BENCHMARK_TEMPLATE(clock_now, tsc_clock_t);
+BENCHMARK(tsc_ticks);
+BENCHMARK(timer_context);
+BENCHMARK(tsc_timer_context);
+BENCHMARK(sampled_timer_context)->Arg(1)->Arg(10)->Arg(100);
+BENCHMARK(timer_update);
+BENCHMARK(timer_batch_update);
+BENCHMARK(static_timer_context);
+BENCHMARK(static_tsc_timer_context);
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace metrics
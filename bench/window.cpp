@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <metrics/accumulator/sliding/window.hpp>
+
+namespace metrics {
+namespace benchmarks {
+namespace {
+
+/// The previous mutex-based sliding window, kept as a baseline.
+class locked_window_t {
+    std::vector<std::uint64_t> measurements;
+    std::size_t count;
+    mutable std::mutex mutex;
+
+public:
+    explicit locked_window_t(std::size_t size) :
+        measurements(size),
+        count(0)
+    {}
+
+    auto update(std::uint64_t value) -> void {
+        std::lock_guard<std::mutex> lock(mutex);
+        measurements[count++ % measurements.size()] = value;
+    }
+
+    auto snapshot() const -> accumulator::snapshot::uniform_t {
+        std::unique_lock<std::mutex> lock(mutex);
+        std::vector<std::uint64_t> result(
+            measurements.begin(),
+            measurements.begin() + std::min(count, measurements.size())
+        );
+        lock.unlock();
+
+        return accumulator::snapshot::uniform_t(std::move(result));
+    }
+};
+
+auto locked_window_update(benchmark::State& state) -> void {
+    static locked_window_t window(1024);
+
+    std::uint64_t value = 0;
+    for (auto _ : state) {
+        window.update(value++);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+auto window_update(benchmark::State& state) -> void {
+    static accumulator::sliding::window_t window(1024);
+
+    std::uint64_t value = 0;
+    for (auto _ : state) {
+        window.update(value++);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+/// Writers contending with a snapshotting thread.
+auto locked_window_update_snapshot(benchmark::State& state) -> void {
+    static locked_window_t window(1024);
+
+    std::uint64_t value = 0;
+    for (auto _ : state) {
+        if (state.thread_index() == 0) {
+            benchmark::DoNotOptimize(window.snapshot());
+        } else {
+            window.update(value++);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+auto window_update_snapshot(benchmark::State& state) -> void {
+    static accumulator::sliding::window_t window(1024);
+
+    std::uint64_t value = 0;
+    for (auto _ : state) {
+        if (state.thread_index() == 0) {
+            benchmark::DoNotOptimize(window.snapshot());
+        } else {
+            window.update(value++);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+auto locked_window_snapshot(benchmark::State& state) -> void {
+    locked_window_t window(static_cast<std::size_t>(state.range(0)));
+
+    std::uint64_t value = 0;
+    for (auto _ : state) {
+        for (int id = 0; id < 16; ++id) {
+            window.update(value++ * 997 % 1000);
+        }
+
+        benchmark::DoNotOptimize(window.snapshot().p99());
+    }
+}
+
+/// Exporting timers, that have not changed since the previous export.
+auto window_snapshot_unchanged(benchmark::State& state) -> void {
+    accumulator::sliding::window_t window(1024);
+    for (std::uint64_t value = 0; value < 1024; ++value) {
+        window.update(value * 997 % 1000);
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(window.snapshot().p99());
+    }
+}
+
+/// Exporting timers, that have been updated a few times since the previous export.
+auto window_snapshot_patched(benchmark::State& state) -> void {
+    accumulator::sliding::window_t window(static_cast<std::size_t>(state.range(0)));
+
+    std::uint64_t value = 0;
+    for (auto _ : state) {
+        for (int id = 0; id < 16; ++id) {
+            window.update(value++ * 997 % 1000);
+        }
+
+        benchmark::DoNotOptimize(window.snapshot().p99());
+    }
+}
+
+/// Values of a large window, that are exported using the usual set of quantiles.
+auto window_values(std::size_t size) -> std::vector<std::uint64_t> {
+    std::vector<std::uint64_t> result;
+    for (std::uint64_t value = 0; value < size; ++value) {
+        result.push_back(value * 7919 % 100000);
+    }
+
+    return result;
+}
+
+auto export_quantiles(const accumulator::snapshot::uniform_t& snapshot) -> void {
+    benchmark::DoNotOptimize(snapshot.median());
+    benchmark::DoNotOptimize(snapshot.p75());
+    benchmark::DoNotOptimize(snapshot.p90());
+    benchmark::DoNotOptimize(snapshot.p95());
+    benchmark::DoNotOptimize(snapshot.p98());
+    benchmark::DoNotOptimize(snapshot.p99());
+    benchmark::DoNotOptimize(snapshot.max());
+}
+
+/// The previous sort-on-construction snapshot, kept as a baseline.
+auto uniform_sort(benchmark::State& state) -> void {
+    const auto values = window_values(static_cast<std::size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        auto copy = values;
+        std::sort(copy.begin(), copy.end());
+        export_quantiles(accumulator::snapshot::uniform_t(accumulator::snapshot::uniform_t::sorted_t(), std::move(copy)));
+    }
+}
+
+auto uniform_select(benchmark::State& state) -> void {
+    const auto values = window_values(static_cast<std::size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        export_quantiles(accumulator::snapshot::uniform_t(values));
+    }
+}
+
+auto uniform_select_batch(benchmark::State& state) -> void {
+    const auto values = window_values(static_cast<std::size_t>(state.range(0)));
+    const std::vector<double> quantiles{0.5, 0.75, 0.9, 0.95, 0.98, 0.99};
+
+    for (auto _ : state) {
+        const accumulator::snapshot::uniform_t snapshot(values);
+        benchmark::DoNotOptimize(snapshot.value(quantiles));
+        benchmark::DoNotOptimize(snapshot.max());
+    }
+}
+
+BENCHMARK(locked_window_update)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(window_update)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(locked_window_update_snapshot)->ThreadRange(2, 8)->UseRealTime();
+BENCHMARK(window_update_snapshot)->ThreadRange(2, 8)->UseRealTime();
+BENCHMARK(locked_window_snapshot)->Range(1 << 10, 1 << 16);
+BENCHMARK(window_snapshot_unchanged);
+BENCHMARK(window_snapshot_patched)->Range(1 << 10, 1 << 16);
+BENCHMARK(uniform_sort)->Range(1 << 10, 1 << 16);
+BENCHMARK(uniform_select)->Range(1 << 10, 1 << 16);
+BENCHMARK(uniform_select_batch)->Range(1 << 10, 1 << 16);
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace metrics
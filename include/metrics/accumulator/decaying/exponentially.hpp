@@ -2,15 +2,16 @@
 
 #include <atomic>
 #include <chrono>
-#include <map>
 #include <mutex>
-#include <random>
+#include <vector>
 
 #include <cstddef>
+#include <cstdint>
 
 #include <boost/optional.hpp>
 
 #include "metrics/accumulator/snapshot/weighted.hpp"
+#include "metrics/clock.hpp"
 
 namespace metrics {
 namespace accumulator {
@@ -18,7 +19,9 @@ namespace decaying {
 
 class exponentially_t {
 public:
-    typedef std::chrono::high_resolution_clock clock_type;
+    /// Millisecond precision is more than enough for exponential decay, which is measured in
+    /// seconds.
+    typedef coarse_clock_t clock_type;
     typedef clock_type::time_point time_point;
     typedef clock_type::duration duration_type;
 
@@ -30,7 +33,14 @@ public:
     typedef snapshot::weighted_t snapshot_type;
     typedef snapshot_type::sample_t sample_type;
 
-    typedef std::map<double, sample_type> samples_mapping_type;
+    /// Reservoir entry, i.e. a sample together with its priority.
+    struct entry_type {
+        double priority;
+        sample_type sample;
+    };
+
+    /// Reservoir, which is a preallocated min-heap ordered by priority.
+    typedef std::vector<entry_type> samples_mapping_type;
 
 private:
     size_t sample_size;
@@ -40,15 +50,21 @@ private:
     // Note: all time difference computations are done within seconds resolution,
     //       but `rescale_time` stored and adjusted in microseconds resolution
     //       in order to be compatible with tiny rescale periods.
-    time_point start_time;
+    //       Stored as the number of clock ticks since epoch, because it's
+    //       read concurrently with rescaling.
+    std::atomic<duration_type::rep> start_time;
     const duration_type rescale_threshold;
     std::atomic<us_int_type> rescale_time;
 
     samples_mapping_type samples;
 
-    std::mt19937 gen;
-    std::uniform_real_distribution<> uniform_dist;
-    typedef std::uniform_real_distribution<>::result_type distr_real_type;
+    /// Minimum priority in the reservoir once it's full, zero otherwise. Samples with lower
+    /// priority are rejected without locking, which is the common case after warming up.
+    std::atomic<double> threshold;
+
+    /// Key mixed into per-thread random streams, which allows to update the accumulator from
+    /// multiple threads without sharing generator state.
+    std::uint64_t key;
 
     // should be shared_mutex or probably atomic based logic someday
     mutable std::mutex samples_mut;
@@ -62,11 +78,13 @@ public:
     /// \param rescale_period upon that time interval rescaling should be done,
     ///     note that rescaling is done on value update, but before value sampling
     ///     into reservoir.
-    /// \param seed to random device (std::random_device is used in case of boost::none),
-    ///     provided mostly for debug and testing.
+    /// \param key key mixed into random numbers (std::random_device is used in case of
+    ///     boost::none). It is not a seed: random streams are per-thread, shared by all
+    ///     accumulators updated from the thread and started from a unique point, so the sequence
+    ///     of sampled values is not reproducible, even for a fixed key on a single thread.
     exponentially_t(std::size_t size, double alpha,
                     duration_type rescale_period = std::chrono::hours(1),
-                    boost::optional<std::mt19937::result_type> seed = boost::none);
+                    boost::optional<std::uint64_t> key = boost::none);
 
     /// Creates a decaying accumulator with size = 1024 and alpha = 0.015
     exponentially_t();
@@ -74,12 +92,34 @@ public:
     auto update(std::uint64_t value, time_point timestamp = clock_type::now()) -> void;
     auto operator()(std::uint64_t value, time_point timestamp = clock_type::now()) -> void;
 
+    /// Records the given value with `count` times the weight of a single value, so that it
+    /// represents that many values in the reservoir.
+    auto update_n(std::uint64_t value, std::uint64_t count, time_point timestamp = clock_type::now())
+        -> void;
+
+    /// Records the given values, all of which are considered to occur at the same timestamp.
+    ///
+    /// Priorities are computed without locking and the reservoir is locked at most once per
+    /// batch, when the first value passing the threshold is found.
+    auto update(const std::uint64_t* values, std::size_t size, time_point timestamp = clock_type::now())
+        -> void;
+
     auto snapshot() const -> snapshot_type;
 
     auto size() const noexcept -> size_t;
 
 private:
     auto rescale(time_point current, us_int_type next) -> void;
+
+    /// Inserts the value with the given priority and weight into the reservoir, evicting the
+    /// lowest priority sample if it's full.
+    ///
+    /// \pre the reservoir mutex must be acquired.
+    auto insert(double priority, std::uint64_t value, double weight) -> void;
+
+    /// Returns the non-normalized weight of a value with the given timestamp relative to the
+    /// given forward decay starting point.
+    auto weight(time_point timestamp, duration_type::rep start) const -> double;
 };
 
 } // namespace decaying
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "metrics/accumulator/snapshot/histogram.hpp"
+
+namespace metrics {
+namespace accumulator {
+namespace hdr {
+
+/// An accumulator implementation backed by a High Dynamic Range histogram, that records values
+/// into log-linear buckets with the configured number of significant decimal digits.
+///
+/// Values are grouped into power-of-two ranges, each of which is split into the same number of
+/// linear sub-buckets, so the relative error is bounded regardless of the value magnitude. The
+/// bucket index is computed using count-leading-zeros arithmetic, which makes updates O(1) and
+/// wait-free, consisting of two relaxed atomic increments.
+///
+/// The memory footprint is fixed on construction and does not depend on the traffic. Values
+/// exceeding the highest trackable value are recorded as the highest trackable value.
+class histogram_t {
+public:
+    typedef std::uint64_t value_type;
+    typedef snapshot::histogram_t snapshot_type;
+
+private:
+    struct {
+        value_type highest;
+        /// Number of sub-buckets in the upper half of each range, as a power of two.
+        unsigned int magnitude;
+        std::size_t size;
+        std::unique_ptr<std::atomic<std::uint64_t>[]> counts;
+        std::atomic<std::uint64_t> sum;
+    } d;
+
+public:
+    /// Creates a new HDR histogram with two significant digits, that tracks values up to one
+    /// hour in nanoseconds, which requires about 36KB of memory.
+    histogram_t();
+
+    /// Creates a new HDR histogram.
+    ///
+    /// \param `digits` the number of significant decimal digits to maintain, in [1; 5] range.
+    /// \param `highest` the highest value to be tracked, at least 2.
+    /// \throws std::invalid_argument if parameters are out of range.
+    histogram_t(int digits, value_type highest);
+
+    /// Returns the number of buckets.
+    auto size() const noexcept -> std::size_t;
+
+    /// Returns the highest trackable value.
+    auto highest() const noexcept -> value_type;
+
+    auto snapshot() const -> snapshot_type;
+
+    /// Forgets all recorded values.
+    ///
+    /// \note updates performed concurrently with resetting may be partially lost.
+    auto reset() noexcept -> void;
+
+    auto update(value_type value) noexcept -> void;
+    auto operator()(value_type value) noexcept -> void;
+
+    /// Records the given value `count` times at the cost of a single update, which allows to
+    /// weight sampled values.
+    auto update_n(value_type value, std::uint64_t count) noexcept -> void;
+
+    /// Records the given values.
+    ///
+    /// Bucket indexes are computed in chunks, using vector instructions where the CPU supports
+    /// them, and runs of values falling into the same bucket are counted with a single atomic
+    /// increment, while the sum is updated once per batch.
+    auto update(const value_type* values, std::size_t size) noexcept -> void;
+
+private:
+    auto index(value_type value) const noexcept -> std::size_t;
+
+    /// Computes bucket indexes of the given values clamped to the highest trackable value and
+    /// returns the sum of clamped values.
+    auto indexes(const value_type* values, std::size_t size, std::uint64_t* result) const noexcept
+        -> value_type;
+
+    /// Returns the lowest value that is mapped into the bucket with the given index.
+    auto lowest_equivalent(std::size_t index) const noexcept -> value_type;
+
+    /// Returns the width of the bucket with the given index.
+    auto width(std::size_t index) const noexcept -> value_type;
+};
+
+} // namespace hdr
+} // namespace accumulator
+} // namespace metrics
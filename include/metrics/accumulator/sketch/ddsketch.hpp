@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "metrics/accumulator/snapshot/histogram.hpp"
+
+namespace metrics {
+namespace accumulator {
+namespace sketch {
+
+/// An accumulator implementation backed by a DDSketch, that records values into logarithmic
+/// buckets with the configured relative accuracy.
+///
+/// Each bucket covers the (gamma^(k - 1); gamma^k] range, where gamma = (1 + a) / (1 - a), so any
+/// quantile is estimated with the relative error of at most `a`. Zero values are counted
+/// separately.
+///
+/// The number of buckets is bounded: once exceeded, the lowest buckets are collapsed into one,
+/// which sacrifices the accuracy of low quantiles only, which rarely matter for latencies.
+///
+/// Unlike sampling accumulators, sketches with equal accuracy can be merged without any loss of
+/// precision, which allows to aggregate distributions across hosts. Sketches can be transferred
+/// using the compact binary encoding.
+class ddsketch_t {
+public:
+    typedef std::uint64_t value_type;
+    typedef snapshot::histogram_t snapshot_type;
+
+private:
+    struct {
+        double accuracy;
+        double gamma;
+        /// Inversed natural logarithm of gamma.
+        double multiplier;
+        std::size_t max_bins;
+
+        /// Key of the first bin.
+        std::int64_t offset;
+        std::vector<std::uint64_t> bins;
+        std::uint64_t zero;
+        std::uint64_t sum;
+
+        mutable std::mutex mutex;
+    } d;
+
+public:
+    /// Creates a new DDSketch with 1% relative accuracy and at most 2048 buckets, which is enough
+    /// to cover the range from one nanosecond to several years without collapsing.
+    ddsketch_t();
+
+    /// Creates a new DDSketch.
+    ///
+    /// \param `accuracy` the relative accuracy, in (0; 1) range.
+    /// \param `max_bins` the maximum number of buckets, at least 1.
+    /// \throws std::invalid_argument if parameters are out of range.
+    ddsketch_t(double accuracy, std::size_t max_bins);
+
+    /// Creates a copy of the given sketch, which may be updated concurrently.
+    ddsketch_t(const ddsketch_t& other);
+
+    auto operator=(const ddsketch_t& other) -> ddsketch_t& = delete;
+
+    /// Returns the relative accuracy.
+    auto accuracy() const noexcept -> double;
+
+    /// Returns the maximum number of buckets.
+    auto max_bins() const noexcept -> std::size_t;
+
+    /// Returns the number of recorded values.
+    auto size() const -> std::uint64_t;
+
+    auto snapshot() const -> snapshot_type;
+
+    auto update(value_type value) -> void;
+    auto operator()(value_type value) -> void;
+
+    /// Records the given value `count` times at the cost of a single update.
+    auto update_n(value_type value, std::uint64_t count) -> void;
+
+    /// Records the given values, computing their keys without locking and then locking once per
+    /// chunk of values.
+    auto update(const value_type* values, std::size_t size) -> void;
+
+    /// Merges the given sketch into this one.
+    ///
+    /// \throws std::invalid_argument if the sketches have different accuracy.
+    auto merge(const ddsketch_t& other) -> void;
+
+    /// Returns the compact binary representation of the sketch.
+    auto encode() const -> std::string;
+
+    /// Restores a sketch from its binary representation.
+    ///
+    /// \throws std::invalid_argument if the given data is malformed, including sketches with more
+    ///     than 65536 maximum buckets.
+    static auto decode(const std::string& data) -> ddsketch_t;
+
+private:
+    /// Returns the key of the bucket the given non-zero value falls into.
+    auto key(value_type value) const noexcept -> std::int64_t;
+
+    /// Makes the bins cover the given key range, collapsing the lowest ones if required, and
+    /// returns the lowest key that is actually covered.
+    ///
+    /// \pre the mutex must be acquired.
+    auto extend(std::int64_t lowest, std::int64_t highest) -> std::int64_t;
+};
+
+} // namespace sketch
+} // namespace accumulator
+} // namespace metrics
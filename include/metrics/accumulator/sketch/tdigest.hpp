@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "metrics/accumulator/snapshot/digest.hpp"
+
+namespace metrics {
+namespace accumulator {
+namespace sketch {
+
+/// An accumulator implementation backed by a merging t-digest, that summarizes values into a
+/// bounded number of centroids, which are small near the tails of the distribution and large
+/// near the median, making extreme quantiles like p99.9 and p99.99 accurate.
+///
+/// Incoming values are appended to a lock-free buffer: a writer claims a slot with a single
+/// atomic increment and stores the value into it. The writer that finds the buffer full
+/// compresses it into the digest in one batch, so the cost of sorting and merging is amortized
+/// over the buffer size.
+///
+/// Digests can be merged, which allows to aggregate distributions across hosts.
+class tdigest_t {
+public:
+    typedef std::uint64_t value_type;
+    typedef snapshot::digest_t snapshot_type;
+    typedef snapshot_type::centroid_t centroid_type;
+
+private:
+    struct {
+        double compression;
+
+        std::unique_ptr<std::atomic<value_type>[]> buffer;
+        std::size_t buffer_size;
+        /// Number of claimed buffer slots, may exceed the buffer size.
+        std::atomic<std::size_t> position;
+
+        /// Compressed centroids sorted by mean, guarded by the mutex.
+        std::vector<centroid_type> centroids;
+        /// Values recorded with weights, which bypass the buffer, guarded by the mutex.
+        std::vector<centroid_type> weighted;
+        value_type min;
+        value_type max;
+
+        mutable std::mutex mutex;
+    } d;
+
+public:
+    /// Creates a new t-digest with the compression of 100, which keeps about a hundred centroids,
+    /// and the buffer of 512 values.
+    tdigest_t();
+
+    /// Creates a new t-digest.
+    ///
+    /// \param `compression` the compression factor, the higher the factor the more centroids are
+    ///     kept, which improves accuracy. Must be at least 1.
+    /// \param `buffer` the number of values buffered before compression, at least 1.
+    /// \throws std::invalid_argument if parameters are out of range.
+    tdigest_t(double compression, std::size_t buffer);
+
+    /// Returns the compression factor.
+    auto compression() const noexcept -> double;
+
+    auto snapshot() const -> snapshot_type;
+
+    auto update(value_type value) -> void;
+    auto operator()(value_type value) -> void;
+
+    /// Records the given value `count` times as a single centroid.
+    ///
+    /// Weighted values don't fit into the lock-free buffer, so they are collected under the lock
+    /// and compressed into the digest once there are as many of them as the buffer holds.
+    auto update_n(value_type value, std::uint64_t count) -> void;
+
+    /// Records the given values, claiming buffer slots for all of them with a single atomic
+    /// increment. Values, that don't fit into the buffer, are compressed into the digest at once.
+    auto update(const value_type* values, std::size_t size) -> void;
+
+    /// Merges the given digest into this one.
+    auto merge(const tdigest_t& other) -> void;
+
+private:
+    /// Returns both compressed centroids and buffered values, together with the exact extremes
+    /// and the number of leading centroids, that are sorted by mean.
+    auto collect(value_type& min, value_type& max, std::size_t& sorted) const ->
+        std::vector<centroid_type>;
+
+    /// Compresses the given centroids sorted by mean into the digest.
+    ///
+    /// \pre the mutex must be acquired.
+    auto absorb(std::vector<centroid_type> centroids, value_type min, value_type max) -> void;
+
+    /// Compresses collected weighted values into the digest.
+    ///
+    /// \pre the mutex must be acquired.
+    auto drain() -> void;
+
+    /// Moves all buffered values into the digest and makes the buffer available again.
+    ///
+    /// \pre the mutex must be acquired and the buffer must be fully claimed.
+    auto flush() -> void;
+};
+
+} // namespace sketch
+} // namespace accumulator
+} // namespace metrics
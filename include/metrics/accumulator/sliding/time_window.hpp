@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include "metrics/accumulator/hdr/histogram.hpp"
+#include "metrics/accumulator/snapshot/histogram.hpp"
+#include "metrics/clock.hpp"
+
+namespace metrics {
+namespace accumulator {
+namespace sliding {
+
+/// An accumulator implementation backed by a sliding time window, that summarizes values
+/// recorded during the last N seconds.
+///
+/// Unlike `window_t`, which covers a traffic-dependent time span, the window duration is fixed,
+/// which makes percentiles comparable across differently loaded services.
+///
+/// The window is a ring of per-second HDR sub-histograms. An update records the value into the
+/// sub-histogram of the current second, resetting it first if it still holds values from the
+/// previous lap, which makes updates O(1). Snapshots merge live sub-histograms only.
+///
+/// Sub-histograms are allocated on the first update of their second, so idle accumulators take
+/// almost no memory, while the footprint never exceeds the one of the whole ring.
+class time_window_t {
+public:
+    typedef coarse_clock_t clock_type;
+    typedef clock_type::time_point time_point;
+
+    typedef std::uint64_t value_type;
+    typedef snapshot::histogram_t snapshot_type;
+
+private:
+    struct slot_t {
+        /// The second this sub-histogram belongs to.
+        std::atomic<std::int64_t> tick;
+        hdr::histogram_t histogram;
+
+        slot_t(int digits, value_type highest);
+    };
+
+    struct {
+        int digits;
+        value_type highest;
+        /// Sub-histograms, which are allocated lazily and never freed until destruction.
+        std::unique_ptr<std::atomic<slot_t*>[]> slots;
+        std::size_t size;
+    } d;
+
+public:
+    /// Creates a new sliding time window accumulator covering the last 10 seconds, that tracks
+    /// values up to one hour in nanoseconds with two significant digits, i.e. with about 1%
+    /// relative error, like the default HDR histogram does.
+    ///
+    /// Each second takes about 36KB once it has seen a value, so up to about 360KB in total.
+    time_window_t();
+
+    time_window_t(const time_window_t& other) = delete;
+
+    ~time_window_t();
+
+    auto operator=(const time_window_t& other) -> time_window_t& = delete;
+
+    /// Creates a new sliding time window accumulator.
+    ///
+    /// \param `window` the window duration, at least one second.
+    /// \param `digits` the number of significant decimal digits of each sub-histogram, which
+    ///     bounds the relative error of quantiles by 10^-digits, e.g. 10% for one digit.
+    /// \param `highest` the highest value to be tracked.
+    /// \throws std::invalid_argument if parameters are out of range.
+    time_window_t(std::chrono::seconds window, int digits, value_type highest);
+
+    /// Returns the window duration.
+    auto window() const noexcept -> std::chrono::seconds;
+
+    auto snapshot(time_point timestamp = clock_type::now()) const -> snapshot_type;
+
+    auto update(value_type value, time_point timestamp = clock_type::now()) -> void;
+    auto operator()(value_type value, time_point timestamp = clock_type::now()) -> void;
+
+    /// Records the given value `count` times at the cost of a single update.
+    auto update_n(value_type value, std::uint64_t count, time_point timestamp = clock_type::now())
+        -> void;
+
+    /// Records the given values, all of which are considered to occur at the same timestamp, so
+    /// the current sub-histogram is looked up once per batch.
+    auto update(const value_type* values, std::size_t size, time_point timestamp = clock_type::now())
+        -> void;
+
+private:
+    /// Returns the sub-histogram of the second the given timestamp belongs to, allocating or
+    /// resetting it if required, or nullptr if the timestamp is out of window.
+    auto acquire(time_point timestamp) -> slot_t*;
+
+    /// Returns the sub-histogram with the given index, allocating it on the first call.
+    auto allocate(std::size_t id) -> slot_t&;
+};
+
+} // namespace sliding
+} // namespace accumulator
+} // namespace metrics
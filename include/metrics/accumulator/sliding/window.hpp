@@ -1,7 +1,9 @@
 #pragma once
 
 #include <atomic>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 #include "metrics/accumulator/snapshot/uniform.hpp"
 
@@ -10,15 +12,53 @@ namespace accumulator {
 namespace sliding {
 
 /// An accumulator implementation backed by a sliding window that stores the last N measurements.
+///
+/// The accumulator is lock-free: writers claim a slot with a single atomic increment and then
+/// store the value into it followed by the claim sequence number, while snapshots never block
+/// writers.
+///
+/// Snapshots are cached using the number of claimed slots as the window version, so repeated
+/// snapshots of an unchanged window share the same values. When only a few slots have changed,
+/// the cached sorted values are patched in linear time instead of being sorted again. Sequence
+/// numbers tell which of the claimed slots are still being stored into, so these are read again
+/// by the next snapshot regardless of how far the window has moved since.
+///
+/// The window itself takes 16 bytes per slot. The cache is allocated on the first snapshot and
+/// takes about the same: a copy of slot values, a presence bit per slot and the sorted values
+/// shared with the last snapshot.
 class window_t {
 public:
     typedef std::uint64_t value_type;
     typedef snapshot::uniform_t snapshot_type;
 
-    std::vector<std::uint64_t> measurements;
+private:
+    std::vector<std::atomic<value_type>> measurements;
     std::atomic<std::size_t> count;
+    /// Sequence number of the last claim stored into each slot, plus one, zero if none.
+    std::vector<std::atomic<std::size_t>> sequences;
 
+    /// The last snapshot.
+    struct cache_t {
+        /// Window version the snapshot has been taken at.
+        std::size_t count;
+        /// Slot values observed while taking the snapshot and whether there was a value at all.
+        std::vector<value_type> slots;
+        std::vector<bool> present;
+        /// Slots, which last claim has not been stored into while taking the snapshot.
+        std::vector<std::size_t> pending;
+        /// Values sorted in ascending order.
+        snapshot_type snapshot;
+
+        /// Creates an empty cache for the given number of slots.
+        explicit cache_t(std::size_t size);
+    };
+
+    /// Guards the cache, which is created on the first snapshot.
     mutable std::mutex mutex;
+    mutable std::unique_ptr<cache_t> cache;
+
+    /// Grants tests access to the slots, for example to simulate stalled writers.
+    friend struct window_access;
 
 public:
     /// Creates a new sliding window accumulator which stores the last 1024 measurements.
@@ -35,6 +75,33 @@ public:
 
     auto update(value_type value) noexcept -> void;
     auto operator()(value_type value) noexcept -> void;
+
+    /// Records the given values, claiming slots for all of them with a single atomic increment.
+    auto update(const value_type* values, std::size_t size) noexcept -> void;
+
+private:
+    /// Stores the value of the claim with the given sequence number.
+    auto store(std::size_t id, value_type value) noexcept -> void;
+
+    /// Returns the sequence number, plus one, of the last of the given number of claims, that
+    /// maps into the given slot, zero if there is no such claim.
+    auto expected(std::size_t slot, std::size_t count) const noexcept -> std::size_t;
+
+    /// Reads the given slot, returning false if its last claim before the given version is still
+    /// being stored into.
+    auto read(std::size_t slot, std::size_t count, value_type& value, std::size_t& sequence) const
+        noexcept -> bool;
+
+    /// Reads all slots claimed before the given version and sorts their values.
+    ///
+    /// \pre the cache mutex must be acquired.
+    auto rebuild(std::size_t count) const -> void;
+
+    /// Reads slots claimed in the given range together with pending ones and patches the sorted
+    /// values with them.
+    ///
+    /// \pre the cache mutex must be acquired.
+    auto patch(std::size_t from, std::size_t to) const -> void;
 };
 
 } // namespace sliding
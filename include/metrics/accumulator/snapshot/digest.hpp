@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "metrics/accumulator/snapshot/weighted.hpp"
+
+namespace metrics {
+namespace accumulator {
+namespace snapshot {
+
+/// A snapshot of a t-digest, which represents a distribution as a sorted list of centroids.
+///
+/// Quantiles are interpolated between centroid means, and between the extreme centroids and the
+/// exact lowest and highest values, which makes tail quantiles accurate.
+class digest_t : public snapshot<digest_t> {
+public:
+    /// A cluster of nearby values, represented by their mean.
+    struct centroid_t {
+        double mean;
+        std::uint64_t weight;
+    };
+
+private:
+    struct {
+        std::vector<centroid_t> centroids;
+        std::uint64_t count;
+        std::uint64_t min;
+        std::uint64_t max;
+    } d;
+
+public:
+    /// Creates a new snapshot with the given centroids.
+    ///
+    /// \param centroids non-empty centroids sorted by mean.
+    /// \param min the exact lowest value.
+    /// \param max the exact highest value.
+    digest_t(std::vector<centroid_t> centroids, std::uint64_t min, std::uint64_t max);
+
+    /// Returns the number of values in the snapshot.
+    auto size() const noexcept -> std::uint64_t;
+
+    /// Returns a reference to the centroids in the snapshot.
+    auto centroids() const noexcept -> const std::vector<centroid_t>&;
+
+    /// Returns the value at the given quantile.
+    ///
+    /// \param quantile a given quantile, in [0..1].
+    /// \return the value in the distribution at quantile.
+    auto value(double quantile) const -> double;
+
+    /// Reverse of this->value(quantile)
+    ///
+    /// \param value value to found a quantile for.
+    /// \return the proportion of values lower than the given one, in [0..1].
+    auto phi(double value) const -> double;
+
+    /// Returns the lowest value in the snapshot.
+    auto min() const -> std::uint64_t;
+
+    /// Returns the highest value in the snapshot.
+    auto max() const -> std::uint64_t;
+
+    /// Returns the arithmetic mean of the values in the snapshot.
+    auto mean() const -> double;
+
+    /// Returns the standard deviation of the values in the snapshot, estimated using centroids.
+    auto stddev() const -> double;
+};
+
+} // namespace snapshot
+} // namespace accumulator
+} // namespace metrics
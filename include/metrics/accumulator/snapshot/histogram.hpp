@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace metrics {
+namespace accumulator {
+namespace snapshot {
+
+/// A snapshot of bucketed accumulators, which represents a distribution as a sorted list of
+/// buckets, each with a representative value and the number of values in it.
+///
+/// Unlike `uniform_t` this snapshot does not depend on the number of recorded values, which
+/// allows to take it cheaply and to estimate extreme quantiles reliably.
+class histogram_t {
+public:
+    typedef std::uint64_t value_type;
+
+    /// Bucket representative value and the number of recorded values in it.
+    typedef std::pair<value_type, std::uint64_t> bucket_type;
+
+private:
+    struct {
+        std::vector<bucket_type> buckets;
+        std::uint64_t count;
+        double sum;
+    } d;
+
+public:
+    /// Creates a new histogram snapshot with the given buckets.
+    ///
+    /// \param `buckets` non-empty buckets sorted by value.
+    explicit histogram_t(std::vector<bucket_type> buckets);
+
+    /// Creates a new histogram snapshot with the given buckets and the exact sum of values, which
+    /// allows to calculate the mean precisely.
+    ///
+    /// \param `buckets` non-empty buckets sorted by value.
+    /// \param `sum` the sum of all recorded values.
+    histogram_t(std::vector<bucket_type> buckets, double sum);
+
+    /// Returns the number of values in the snapshot.
+    std::uint64_t size() const noexcept;
+
+    /// Returns a reference to the buckets in the snapshot.
+    const std::vector<bucket_type>& buckets() const noexcept;
+
+    /// Returns the lowest value in the snapshot.
+    std::uint64_t min() const;
+
+    /// Returns the highest value in the snapshot.
+    std::uint64_t max() const;
+
+    /// Returns the arithmetic mean of the values in the snapshot.
+    double mean() const;
+
+    /// Returns the standard deviation of the values in the snapshot.
+    double stddev() const;
+
+    double median() const {
+        return value(0.5);
+    }
+
+    double p75() const {
+        return value(0.75);
+    }
+
+    double p90() const {
+        return value(0.90);
+    }
+
+    double p95() const {
+        return value(0.95);
+    }
+
+    double p98() const {
+        return value(0.98);
+    }
+
+    double p99() const {
+        return value(0.99);
+    }
+
+    double p999() const {
+        return value(0.999);
+    }
+
+    /// Returns the value at the given quantile, i.e. the value of the bucket containing the value
+    /// with the corresponding rank.
+    ///
+    /// \param quantile a given quantile, in [0; 1] range.
+    double value(double quantile) const;
+
+    /// Merges the given snapshot into this one, adding up counts of buckets with equal values.
+    void merge(const histogram_t& other);
+};
+
+} // namespace snapshot
+} // namespace accumulator
+} // namespace metrics
@@ -1,19 +1,35 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 namespace metrics {
 namespace accumulator {
 namespace snapshot {
 
+/// A snapshot of uniformly sampled values.
+///
+/// Values are sorted lazily, only when requested in order using `values()`. Quantiles are
+/// evaluated using selection instead, which takes linear time, and each selected rank narrows
+/// the range, which must be partitioned to select the next one. Other statistics are calculated
+/// together in a single vectorized pass on construction.
+///
+/// Copies share the same values, and it is safe to use them concurrently.
 class uniform_t {
 public:
     typedef std::uint64_t value_type;
 
+    /// Tag, that marks values as already sorted.
+    struct sorted_t {};
+
 private:
+    struct data_t;
+
     struct {
-        std::vector<value_type> values;
+        std::shared_ptr<data_t> data;
+        /// Number of values each stored value stands for.
+        std::uint64_t weight;
     } d;
 
 public:
@@ -22,11 +38,24 @@ public:
     /// \param `values` an unordered set of values in the accumulator.
     explicit uniform_t(std::vector<value_type> values);
 
-    /// Returns the number of values in the snapshot.
+    /// Create a new uniform snapshot with the given values, that are already sorted, which
+    /// allows to skip sorting.
+    ///
+    /// \param `values` values sorted in ascending order.
+    uniform_t(sorted_t, std::vector<value_type> values);
+
+    /// Returns a copy of the snapshot, which values share the given weight, i.e. each of them
+    /// stands for `weight` values. This allows sampled histograms to report the size of the
+    /// whole population, while values and statistics stay shared and unaffected.
+    uniform_t scaled(std::uint64_t weight) const;
+
+    /// Returns the number of values the snapshot represents, i.e. the number of stored values
+    /// multiplied by their weight, which is 1 unless the snapshot is scaled.
     std::size_t size() const noexcept;
 
-    /// Returns a reference for the entire set of values in the snapshot.
-    const std::vector<value_type>& values() const noexcept;
+    /// Returns a reference for the entire set of values in the snapshot sorted in ascending
+    /// order, sorting them on the first call.
+    const std::vector<value_type>& values() const;
 
     /// Returns the lowest value in the snapshot.
     std::uint64_t min() const;
@@ -69,6 +98,12 @@ public:
     ///
     /// \param quantile a given quantile, in [0; 1] range.
     double value(double quantile) const;
+
+    /// Returns values at the given quantiles, which is cheaper than requesting them one by one
+    /// if the values are not sorted yet.
+    ///
+    /// \param quantiles given quantiles, each in [0; 1] range.
+    std::vector<double> value(const std::vector<double>& quantiles) const;
 };
 
 } // namespace snapshot
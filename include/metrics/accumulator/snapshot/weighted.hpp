@@ -53,6 +53,13 @@ public:
         return self().value(0.99);
     }
 
+    /// Returns the value at the 99.9th percentile in the distribution.
+    ///
+    /// \return the value at the 99.9th percentile.
+    auto p999() const -> double {
+        return self().value(0.999);
+    }
+
 private:
     auto self() const -> const T& {
         return static_cast<const T&>(*this);
@@ -71,6 +78,12 @@ private:
     std::vector<double> weights;
     std::vector<double> quantiles;
 
+    /// Statistics, calculated in a single pass on construction.
+    struct {
+        double mean;
+        double stddev;
+    } stats;
+
 public:
     /// Creates a new snapshot with the given values.
     ///
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace metrics {
+
+/// A steady clock, which trades precision for speed.
+///
+/// Where available, reads the kernel timestamp cached on each scheduler tick, which takes a few
+/// nanoseconds without ever entering the kernel, but has the resolution of a few milliseconds.
+/// It's enough for rate decay, decaying reservoirs and time windows, but not for measuring
+/// durations, so timers use precise clocks instead.
+///
+/// Falls back to `std::chrono::steady_clock` on systems without a coarse clock source.
+///
+/// Meets `TrivialClock` requirements.
+class coarse_clock_t {
+public:
+    typedef std::chrono::nanoseconds duration;
+    typedef duration::rep rep;
+    typedef duration::period period;
+    typedef std::chrono::time_point<coarse_clock_t> time_point;
+
+    static constexpr bool is_steady = true;
+
+    static auto now() noexcept -> time_point {
+#ifdef CLOCK_MONOTONIC_COARSE
+        timespec ts;
+        ::clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+
+        return time_point(std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec));
+#else
+        return time_point(std::chrono::duration_cast<duration>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ));
+#endif
+    }
+};
+
+/// A clock, which reads the CPU time-stamp counter, falling back to `std::chrono::steady_clock`
+/// on other architectures.
+///
+/// Reading the counter takes a few nanoseconds, which makes it suitable for measuring sub-
+/// microsecond spans, where the cost of the regular clock would dominate the measured value.
+/// Ticks are converted to nanoseconds using the ratio calibrated against the steady clock once,
+/// which blocks the caller for about 10 ms. Call `calibrate()` beforehand, out of the measured
+/// path, otherwise the first conversion does it.
+///
+/// \warning the result is meaningful only if the counter is invariant, i.e. it ticks at a
+///     constant rate regardless of frequency scaling and is synchronized across cores, which is
+///     reported by `invariant()`.
+///
+/// Meets `TrivialClock` requirements.
+class tsc_clock_t {
+public:
+    typedef std::chrono::nanoseconds duration;
+    typedef duration::rep rep;
+    typedef duration::period period;
+    typedef std::chrono::time_point<tsc_clock_t> time_point;
+
+    static constexpr bool is_steady = true;
+
+    static auto now() noexcept -> time_point {
+        return time_point(to_duration(ticks()));
+    }
+
+    /// Returns the raw counter value.
+    static auto ticks() noexcept -> std::uint64_t {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<duration>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count());
+#endif
+    }
+
+    /// Converts the given number of ticks into nanoseconds.
+    static auto to_duration(std::uint64_t ticks) noexcept -> duration;
+
+    /// Calibrates the counter unless already calibrated.
+    static auto calibrate() noexcept -> void;
+
+    /// Checks whether the counter is invariant, querying the CPU once.
+    static auto invariant() noexcept -> bool;
+};
+
+/// A clock of registered timers, which reads either the regular precise clock or the time-stamp
+/// counter, as selected on construction.
+///
+/// Besides the regular `now()`, provides a pair of methods for measuring spans, which return the
+/// time-stamp counter in raw ticks, so they are converted only once per measured span.
+class timer_clock_t {
+public:
+    typedef std::chrono::high_resolution_clock precise_type;
+
+    typedef precise_type::duration duration;
+    typedef precise_type::rep rep;
+    typedef precise_type::period period;
+    typedef precise_type::time_point time_point;
+
+    static constexpr bool is_steady = precise_type::is_steady;
+
+private:
+    bool tsc;
+
+public:
+    /// Creates a new clock, which reads the time-stamp counter if `tsc` is true and the counter
+    /// is invariant, falling back to the precise clock otherwise.
+    explicit timer_clock_t(bool tsc = false) noexcept :
+        timer_clock_t(tsc, tsc && tsc_clock_t::invariant())
+    {}
+
+    /// Creates a new clock, which reads the time-stamp counter if both `tsc` and `invariant` are
+    /// true, calibrating the counter beforehand, so that measurements never do.
+    timer_clock_t(bool tsc, bool invariant) noexcept :
+        tsc(tsc && invariant)
+    {
+        if (this->tsc) {
+            tsc_clock_t::calibrate();
+        }
+    }
+
+    /// Returns true if the clock reads the time-stamp counter.
+    auto reads_tsc() const noexcept -> bool {
+        return tsc;
+    }
+
+    auto now() const noexcept -> time_point {
+        if (tsc) {
+            return time_point(std::chrono::duration_cast<duration>(
+                tsc_clock_t::now().time_since_epoch()
+            ));
+        }
+
+        return precise_type::now();
+    }
+
+    /// Returns an opaque timestamp, that is meaningful only for passing to `elapsed()`.
+    auto stamp() const noexcept -> time_point {
+        if (tsc) {
+            return time_point(duration(static_cast<rep>(tsc_clock_t::ticks())));
+        }
+
+        return precise_type::now();
+    }
+
+    /// Returns the time elapsed since the given timestamp returned by `stamp()`.
+    auto elapsed(time_point start) const noexcept -> duration {
+        if (tsc) {
+            const auto start_ticks = static_cast<std::uint64_t>(start.time_since_epoch().count());
+            const auto ticks = tsc_clock_t::ticks() - start_ticks;
+            return std::chrono::duration_cast<duration>(tsc_clock_t::to_duration(ticks));
+        }
+
+        return precise_type::now() - start;
+    }
+};
+
+} // namespace metrics
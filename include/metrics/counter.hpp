@@ -1,10 +1,18 @@
 #pragma once
 
+#include <cstdint>
+
 #include "fwd.hpp"
 
 namespace metrics {
 inline namespace v2 {
 
+/// A counter is a metric that can be incremented and decremented, much like `std::atomic<T>`,
+/// but which is not required to provide a globally ordered value on each modification.
+///
+/// This allows implementations to spread concurrent modifications across several memory
+/// locations, making updates from many threads almost free of cache line contention at the cost
+/// of more expensive reads.
 class counter_t {
 public:
     typedef std::int64_t value_type;
@@ -12,15 +20,22 @@ public:
 public:
     virtual ~counter_t() = default;
 
-    virtual auto get() const -> value_type;
+    /// Returns the current counter value.
+    ///
+    /// \note the returned value is not an atomic snapshot if there are concurrent updates.
+    virtual auto get() const -> value_type = 0;
 
-    virtual auto inc() -> value_type = 0;
+    /// Increments the counter by one.
+    virtual auto inc() -> void = 0;
 
-    virtual auto inc(value_type value) -> value_type = 0;
+    /// Increments the counter by the given value.
+    virtual auto inc(value_type value) -> void = 0;
 
-    virtual auto dec() -> value_type = 0;
+    /// Decrements the counter by one.
+    virtual auto dec() -> void = 0;
 
-    virtual auto dec(value_type value) -> value_type = 0;
+    /// Decrements the counter by the given value.
+    virtual auto dec(value_type value) -> void = 0;
 };
 
 } // namespace v2
@@ -9,6 +9,9 @@ namespace metrics {
 /// Represents a factory for standalone non-tagged isolated metrics.
 class factory_t {
 public:
+    /// Creates default counter implementation.
+    auto counter() const -> std::unique_ptr<counter_t>;
+
     /// Creates default meter implementation.
     auto meter() const -> std::unique_ptr<meter_t>;
 
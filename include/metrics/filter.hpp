@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "fwd.hpp"
+
+namespace metrics {
+
+/// A structured metric query, which is a conjunction of tag clauses.
+///
+/// Unlike arbitrary `query_t` predicates, filters can be answered using the registry tag index in
+/// time proportional to the result size rather than to the number of registered metrics.
+///
+/// An empty filter matches all metrics.
+class filter_t {
+public:
+    /// A single tag clause.
+    struct clause_t {
+        enum class kind_t {
+            /// The tag value must be equal to the given value.
+            eq,
+            /// The tag value must start with the given value.
+            prefix
+        };
+
+        kind_t kind;
+        std::string key;
+        std::string value;
+    };
+
+private:
+    std::vector<clause_t> d;
+
+public:
+    /// Constructs an empty filter, that matches all metrics.
+    filter_t() = default;
+
+    /// Returns a filter, that matches metrics having the given tag with exactly the given value.
+    static auto eq(std::string key, std::string value) -> filter_t;
+
+    /// Returns a filter, that matches metrics having the given tag, which value starts with the
+    /// given prefix.
+    static auto prefix(std::string key, std::string prefix) -> filter_t;
+
+    /// Returns the conjunction of clauses of both filters.
+    auto operator&&(const filter_t& other) const -> filter_t;
+
+    auto empty() const noexcept -> bool;
+
+    auto clauses() const noexcept -> const std::vector<clause_t>&;
+
+    /// Checks whether the given tags match all clauses.
+    auto match(const tags_t& tags) const -> bool;
+
+    /// Allows to use filters wherever generic queries are expected.
+    auto operator()(const tagged_t& metric) const -> bool;
+};
+
+} // namespace metrics
@@ -11,6 +11,7 @@ inline namespace v2 {
 template<typename T>
 using gauge = std::function<T()>;
 
+class counter_t;
 class meter_t;
 
 } // namespace v2
@@ -20,12 +21,18 @@ inline namespace v3 { class visitor_t; } // namespace v3
 template<class Accumulate>
 class timer;
 
+template<class Accumulate>
+class static_timer;
+
+class ticker_t;
+
 /// Accumulators and shapshots.
 
 namespace accumulator {
 namespace sliding {
 
 class window_t;
+class time_window_t;
 
 } // namespace sliding
 namespace decaying {
@@ -33,11 +40,24 @@ namespace decaying {
 class exponentially_t;
 
 } // namespace decaying
+namespace sketch {
+
+class ddsketch_t;
+class tdigest_t;
+
+} // namespace sketch
+namespace hdr {
+
+class histogram_t;
+
+} // namespace hdr
 } // namespace accumulator
 
 /// Metric wrappers.
 
 class tags_t;
+class tags_view_t;
+class filter_t;
 class tagged_t;
 
 template<typename T>
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "fwd.hpp"
+
+namespace metrics {
+
+/// Registry generation, which is advanced every time a metric is removed from the registry or
+/// the registry itself is destroyed.
+///
+/// Handles remember the generation they were resolved in, which allows to cheaply detect that
+/// the metric they refer to may no longer be registered.
+class generation_t {
+    std::atomic<std::uint64_t> value;
+
+public:
+    generation_t() noexcept :
+        value(0)
+    {}
+
+    generation_t(const generation_t& other) = delete;
+
+    auto operator=(const generation_t& other) -> generation_t& = delete;
+
+    /// Returns the current generation.
+    auto get() const noexcept -> std::uint64_t {
+        return value.load(std::memory_order_acquire);
+    }
+
+    /// Advances the generation, invalidating all handles resolved before.
+    auto advance() noexcept -> void {
+        value.fetch_add(1, std::memory_order_acq_rel);
+    }
+};
+
+/// A pre-resolved reference to a registered metric.
+///
+/// Unlike `shared_metric`, a handle carries no tags and is intended to be resolved once and then
+/// used for frequent updates, which never touch the registry again.
+///
+/// A handle always keeps its metric alive, so it's safe to use it after the metric has been
+/// removed from the registry; updates then go to the detached instance. Use `valid()` to check
+/// whether the handle should be resolved again.
+template<typename T>
+class handle {
+public:
+    typedef T value_type;
+
+private:
+    struct {
+        std::shared_ptr<T> inner;
+        std::shared_ptr<const generation_t> generation;
+        std::uint64_t value;
+    } d;
+
+public:
+    /// Constructs an empty handle, which is never valid.
+    handle() :
+        d{nullptr, nullptr, 0}
+    {}
+
+    /// Constructs a handle to the given metric, which was resolved in the given generation.
+    handle(std::shared_ptr<T> inner,
+           std::shared_ptr<const generation_t> generation,
+           std::uint64_t value) :
+        d{std::move(inner), std::move(generation), value}
+    {}
+
+    /// Checks whether no metric was removed from the registry since the handle was resolved.
+    ///
+    /// This is a single atomic load of a rarely modified value, so it's cheap enough to be called
+    /// on every update.
+    auto valid() const noexcept -> bool {
+        return d.inner != nullptr && d.generation->get() == d.value;
+    }
+
+    /// Checks whether the handle was resolved using the registry with the given generation.
+    auto issued_by(const generation_t& generation) const noexcept -> bool {
+        return d.generation.get() == &generation;
+    }
+
+    auto get() const noexcept -> const std::shared_ptr<T>& {
+        return d.inner;
+    }
+
+    auto operator->() const noexcept -> T* {
+        return d.inner.get();
+    }
+
+    auto operator*() const noexcept -> T& {
+        return *d.inner;
+    }
+};
+
+} // namespace metrics
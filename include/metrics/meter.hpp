@@ -9,6 +9,19 @@ inline namespace v2 {
 ///
 /// Just like the Unix load averages visible in `top`.
 class meter_t {
+public:
+    /// All meter values read at once, using a single clock read.
+    struct summary_t {
+        /// The number of events which have been marked.
+        std::uint64_t count;
+        /// The mean rate since the meter was created.
+        double mean_rate;
+        /// One-, five- and fifteen-minute exponentially-weighted moving average rates.
+        double m01rate;
+        double m05rate;
+        double m15rate;
+    };
+
 public:
     virtual ~meter_t() = 0;
 
@@ -30,6 +43,12 @@ public:
     /// occurred since the meter was created.
     virtual auto m15rate() const -> double = 0;
 
+    /// Returns all meter values at once.
+    ///
+    /// Unlike calling each getter separately, reads the clock only once, which makes both the
+    /// call cheaper and the returned rates consistent with each other.
+    virtual auto summary() const -> summary_t = 0;
+
     /// Mark the occurrence of an event.
     virtual auto mark() -> void = 0;
 
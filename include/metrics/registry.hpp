@@ -1,13 +1,16 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "filter.hpp"
 #include "fwd.hpp"
 #include "gauge.hpp"
+#include "handle.hpp"
 #include "metric.hpp"
 #include "tags.hpp"
 
@@ -22,9 +25,27 @@ public:
     template<typename T>
     using metric_set = std::map<tags_t, shared_metric<T>>;
 
+    /// Registry memory statistics.
+    struct stats_t {
+        /// Number of registry entries, including expired ones.
+        std::size_t size;
+        /// Number of entries, which metrics have been destroyed, but which are not reclaimed yet.
+        ///
+        /// Expired entries are reclaimed incrementally on each registration and removal.
+        std::size_t expired;
+    };
+
     /// Constructs a new metric registry.
     registry_t();
 
+    /// Constructs a new metric registry, which attaches all meters and timers it creates to the
+    /// given ticker, taking moving average decay off their update path.
+    ///
+    /// \param ticker ticker, which is kept alive until all attached metrics are destroyed.
+    /// \throws std::invalid_argument if the ticker interval isn't 5 seconds, which moving averages
+    ///     of meters and timers expect.
+    explicit registry_t(std::shared_ptr<ticker_t> ticker);
+
     /// Destroys the current metric registry, freeing all its allocated resources.
     ~registry_t();
 
@@ -55,6 +76,9 @@ public:
     template<typename T>
     auto gauges(const query_t& query) const -> metric_set<metrics::gauge<T>>;
 
+    template<typename T>
+    auto gauges(const filter_t& filter) const -> metric_set<metrics::gauge<T>>;
+
     /// Returns the сounter registered under this name and tags; or create and register a new
     /// counter if none is registered.
     ///
@@ -65,12 +89,49 @@ public:
     auto counter(std::string name, tags_t::container_type tags = tags_t::container_type()) const
         -> shared_metric<std::atomic<T>>;
 
+    /// Returns the сounter registered under the given borrowed tags; or create and register a new
+    /// counter if none is registered.
+    ///
+    /// Unlike the overload above, does not allocate if the counter already exists.
+    ///
+    /// \param tags Borrowed counter name and tags.
+    /// \tparam `T` must be either std::int64_t or std::uint64_t.
+    template<typename T>
+    auto counter(const tags_view_t& tags) const -> shared_metric<std::atomic<T>>;
+
     template<typename T>
     auto counters() const -> metric_set<std::atomic<T>>;
 
     template<typename T>
     auto counters(const query_t& query) const -> metric_set<std::atomic<T>>;
 
+    template<typename T>
+    auto counters(const filter_t& filter) const -> metric_set<std::atomic<T>>;
+
+    /// Returns the striped counter registered under this name and tags; or create and register a
+    /// new striped counter if none is registered.
+    ///
+    /// Unlike `counter<T>()`, the returned counter spreads concurrent updates across per-thread
+    /// cells, which makes it suitable for counters incremented from lots of threads at the cost
+    /// of more expensive reads and a larger memory footprint.
+    ///
+    /// \param name Counter name.
+    /// \param tags Optional additional tags.
+    auto striped_counter(std::string name, tags_t::container_type tags = tags_t::container_type()) const
+        -> shared_metric<counter_t>;
+
+    /// Returns the striped counter registered under the given borrowed tags; or create and
+    /// register a new striped counter if none is registered.
+    ///
+    /// Does not allocate if the counter already exists.
+    auto striped_counter(const tags_view_t& tags) const -> shared_metric<counter_t>;
+
+    auto striped_counters() const -> metric_set<counter_t>;
+
+    auto striped_counters(const query_t& query) const -> metric_set<counter_t>;
+
+    auto striped_counters(const filter_t& filter) const -> metric_set<counter_t>;
+
     /// Returns a meter shared metric that is mapped to a given tags, performing a creation with
     /// registering if such metric does not already exist.
     ///
@@ -79,13 +140,25 @@ public:
     auto meter(std::string name, tags_t::container_type tags = tags_t::container_type()) const
         -> shared_metric<meter_t>;
 
+    /// Returns a meter shared metric that is mapped to the given borrowed tags, performing a
+    /// creation with registering if such metric does not already exist.
+    ///
+    /// Does not allocate if the meter already exists.
+    ///
+    /// \param tags borrowed meter name and tags.
+    auto meter(const tags_view_t& tags) const -> shared_metric<meter_t>;
+
     auto meters() const -> metric_set<meter_t>;
 
     auto meters(const query_t& query) const -> metric_set<meter_t>;
 
+    auto meters(const filter_t& filter) const -> metric_set<meter_t>;
+
     /// Returns a timer shared metric that is mapped to a given tags, performing a creation with
     /// registering if such metric does not already exist.
     ///
+    /// An already existing timer is returned regardless of its sampling rate.
+    ///
     /// \param name timer name.
     /// \param tags optional additional tags.
     /// \tparam Accumulate must meet Accumulate requirements.
@@ -94,16 +167,104 @@ public:
     auto timer(std::string name, tags_t::container_type tags = tags_t::container_type()) const
         -> shared_metric<timer<Accumulate>>;
 
+    /// Returns a timer shared metric that is mapped to the given borrowed tags, performing a
+    /// creation with registering if such metric does not already exist.
+    ///
+    /// Does not allocate if the timer already exists.
+    ///
+    /// \param tags borrowed timer name and tags.
+    /// \tparam Accumulate must meet Accumulate requirements.
+    template<class Accumulate = accumulator::sliding::window_t>
+    auto timer(const tags_view_t& tags) const -> shared_metric<metrics::timer<Accumulate>>;
+
+    /// Returns a timer shared metric that is mapped to a given tags, performing a creation with
+    /// registering if such metric does not already exist.
+    ///
+    /// Unlike `timer()`, the created timer measures only one of `every` contexts on average,
+    /// chosen randomly, while still counting all of them, so that both `count()` and rates
+    /// reflect every event. Skipped contexts neither read the clock nor update the histogram,
+    /// while each sampled duration is recorded with the weight of `every`, so quantiles and mean
+    /// are unbiased and histogram counts, as seen through `snapshot()` and visitors, reflect every
+    /// event too. The sliding window can't weight values, so its snapshot size is scaled instead.
+    ///
+    /// \param name timer name.
+    /// \param tags additional tags.
+    /// \param every sampling rate, where both 0 and 1 mean measuring every context.
+    /// \throws std::invalid_argument if the timer already exists with another sampling rate.
+    /// \tparam Accumulate must meet Accumulate requirements.
+    template<class Accumulate = accumulator::sliding::window_t>
+    auto timer(std::string name, tags_t::container_type tags, std::uint32_t every) const
+        -> shared_metric<metrics::timer<Accumulate>>;
+
+    /// Returns a timer shared metric that is mapped to a given tags, performing a creation with
+    /// registering if such metric does not already exist.
+    ///
+    /// Unlike `timer()`, the created timer measures contexts using the CPU time-stamp counter,
+    /// which is several times cheaper to read than the regular clock, see `tsc_clock_t`. Falls
+    /// back to the regular clock if the counter isn't invariant. The counter is calibrated on the
+    /// first creation, blocking for about 10 ms, rather than on the first measurement. An already
+    /// existing timer is returned as is, regardless of its clock.
+    ///
+    /// \param name timer name.
+    /// \param tags optional additional tags.
+    /// \tparam Accumulate must meet Accumulate requirements.
+    template<class Accumulate = accumulator::sliding::window_t>
+    auto tsc_timer(std::string name, tags_t::container_type tags = tags_t::container_type()) const
+        -> shared_metric<metrics::timer<Accumulate>>;
+
+    /// Returns a timer shared metric that is mapped to a given tags, performing a creation with
+    /// registering if such metric does not already exist.
+    ///
+    /// Combines both: the created timer reads the time-stamp counter as `tsc_timer()` does and
+    /// measures only one of `every` contexts on average as the sampling `timer()` does.
+    ///
+    /// \param name timer name.
+    /// \param tags additional tags.
+    /// \param every sampling rate, where both 0 and 1 mean measuring every context.
+    /// \throws std::invalid_argument if the timer already exists with another sampling rate.
+    /// \tparam Accumulate must meet Accumulate requirements.
+    template<class Accumulate = accumulator::sliding::window_t>
+    auto tsc_timer(std::string name, tags_t::container_type tags, std::uint32_t every) const
+        -> shared_metric<metrics::timer<Accumulate>>;
+
+    /// Returns the same timer as `timer()` does, but as its concrete final type.
+    ///
+    /// Contexts created through the returned metric are dispatched statically: sampling and
+    /// stamping the start time are inlined into the caller, leaving only the clock read and a
+    /// single non-virtual library call on completion. Useful on hot paths, where a virtual
+    /// context costs comparably to the measured code itself. An already existing timer is
+    /// returned regardless of its clock.
+    ///
+    /// \param name timer name.
+    /// \param tags additional tags.
+    /// \param every sampling rate, where both 0 and 1 mean measuring every context.
+    /// 	hrows std::invalid_argument if the timer already exists with another sampling rate.
+    /// 	param Accumulate must meet Accumulate requirements.
+    template<class Accumulate = accumulator::sliding::window_t>
+    auto static_timer(std::string name,
+                      tags_t::container_type tags = tags_t::container_type(),
+                      std::uint32_t every = 1) const
+        -> shared_metric<metrics::static_timer<Accumulate>>;
+
     template<class Accumulate = accumulator::sliding::window_t>
     auto timers() const -> metric_set<metrics::timer<Accumulate>>;
 
     template<class Accumulate = accumulator::sliding::window_t>
     auto timers(const query_t& query) const -> metric_set<metrics::timer<Accumulate>>;
 
+    template<class Accumulate = accumulator::sliding::window_t>
+    auto timers(const filter_t& filter) const -> metric_set<metrics::timer<Accumulate>>;
+
     auto select() const -> std::vector<std::shared_ptr<tagged_t>>;
 
     auto select(const query_t& query) const -> std::vector<std::shared_ptr<tagged_t>>;
 
+    /// Returns all metrics matching the given filter.
+    ///
+    /// Unlike generic queries, which are checked against every registered metric, filters are
+    /// answered using the tag index in time proportional to the result size.
+    auto select(const filter_t& filter) const -> std::vector<std::shared_ptr<tagged_t>>;
+
     /// Removes the metric with the given name.
     ///
     /// \param name The name of the metric.
@@ -112,15 +273,81 @@ public:
     /// \return Whether or not the metric was removed.
     template<typename T>
     auto remove(const std::string& name, const tags_t::container_type& tags) -> bool;
+
+    /// Returns registry memory statistics.
+    ///
+    /// \note requires to scan the whole registry.
+    auto stats() const -> stats_t;
+
+    /// Returns the current registry generation, which is advanced on every successful metric
+    /// removal and on registry destruction.
+    auto generation() const noexcept -> const generation_t&;
+
+    /// Resolves a metric using the given function and wraps it into a handle, that remains
+    /// valid until some metric is removed from this registry.
+    ///
+    /// \param fn function that accepts this registry and returns a `shared_metric`, for example
+    ///     `[](const registry_t& r) { return r.timer("name"); }`.
+    template<typename F>
+    auto resolve(F fn) const -> handle<typename decltype(fn(*this).get())::element_type> {
+        // Take the generation before resolving, so that a concurrent removal can only make the
+        // handle invalid spuriously, but never makes it outlive the metric registration.
+        auto generation = shared_generation();
+        const auto value = generation->get();
+
+        return {fn(*this).get(), std::move(generation), value};
+    }
+
+private:
+    auto shared_generation() const -> std::shared_ptr<const generation_t>;
 };
 
+/// Returns a handle to the metric resolved by the given function, caching it in a thread-local
+/// variable.
+///
+/// The cache is unique for each function type, so each lambda expression, i.e. each call site,
+/// gets its own cache. The handle is resolved again only when it becomes invalid or when a
+/// different registry is given, so the hot path consists of a thread-local access and an atomic
+/// load.
+///
+/// \note the cached handle keeps its metric alive until it's resolved again or the thread exits.
+template<typename F>
+auto cached(const registry_t& registry, F fn) ->
+    const handle<typename decltype(fn(registry).get())::element_type>&
+{
+    typedef handle<typename decltype(fn(registry).get())::element_type> handle_type;
+
+    static thread_local handle_type result;
+
+    if (!result.valid() || !result.issued_by(registry.generation())) {
+        result = registry.resolve(std::move(fn));
+    }
+
+    return result;
+}
+
 extern template auto registry_t::remove<gauge<std::int64_t>>(const std::string& name, const tags_t::container_type& tags) -> bool;
 extern template auto registry_t::remove<gauge<std::uint64_t>>(const std::string& name, const tags_t::container_type& tags) -> bool;
 extern template auto registry_t::remove<gauge<std::double_t>>(const std::string& name, const tags_t::container_type& tags) -> bool;
 extern template auto registry_t::remove<std::atomic<std::int64_t>>(const std::string& name, const tags_t::container_type& tags) -> bool;
 extern template auto registry_t::remove<std::atomic<std::uint64_t>>(const std::string& name, const tags_t::container_type& tags) -> bool;
+extern template auto registry_t::remove<counter_t>(const std::string& name, const tags_t::container_type& tags) -> bool;
 extern template auto registry_t::remove<meter_t>(const std::string& name, const tags_t::container_type& tags) -> bool;
 extern template auto registry_t::remove<timer<accumulator::sliding::window_t>>(const std::string& name, const tags_t::container_type& tags) -> bool;
 extern template auto registry_t::remove<timer<accumulator::decaying::exponentially_t>>(const std::string& name, const tags_t::container_type& tags) -> bool;
+extern template auto registry_t::remove<timer<accumulator::sketch::tdigest_t>>(const std::string& name, const tags_t::container_type& tags) -> bool;
+extern template auto registry_t::remove<timer<accumulator::sketch::ddsketch_t>>(const std::string& name, const tags_t::container_type& tags) -> bool;
+extern template auto registry_t::remove<timer<accumulator::sliding::time_window_t>>(const std::string& name, const tags_t::container_type& tags) -> bool;
+extern template auto registry_t::remove<timer<accumulator::hdr::histogram_t>>(const std::string& name, const tags_t::container_type& tags) -> bool;
 
 } // namespace metrics
+
+/// Resolves a metric at the call site once per thread and returns a cached handle to it.
+///
+/// Usage: `METRICS_CACHED(registry, timer("name", {{"tag", "value"}}))->context()`. The expression
+/// is evaluated again only after some metric has been removed from the registry, so it should
+/// not depend on arguments that change between calls.
+#define METRICS_CACHED(registry, ...)                                                             \
+    ::metrics::cached((registry), [&](const ::metrics::registry_t& metrics_registry_) {          \
+        return metrics_registry_.__VA_ARGS__;                                                     \
+    })
@@ -1,19 +1,40 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <string>
+#include <utility>
 
 #include <boost/optional/optional_fwd.hpp>
+#include <boost/range/iterator_range.hpp>
+#include <boost/utility/string_ref.hpp>
 
 namespace metrics {
 
 /// The tags struct represents immutable tagged metric name.
+///
+/// Tags are stored as a flat array sorted by key, which strings are interned in a process-wide
+/// pool, so equal strings share the same address. This makes both equality checks and the memory
+/// footprint cheap, because each distinct string is stored once regardless of the number of
+/// metrics using it. Strings are reference counted and leave the pool together with the last
+/// tags using them, so high-cardinality tag values don't accumulate.
+///
+/// Up to 8 tags, including the name, are stored inline in the shared block, so constructing tags
+/// usually costs a single allocation.
+///
+/// Copying is cheap, because the underlying tags are shared between copies.
 class tags_t {
 public:
     typedef std::map<std::string, std::string> container_type;
 
+    /// A single tag as a pair of interned key and value.
+    typedef std::pair<const std::string*, const std::string*> value_type;
+    typedef const value_type* const_iterator;
+    typedef boost::iterator_range<const_iterator> range_type;
+
 private:
-    container_type container;
+    struct data_t;
+    std::shared_ptr<const data_t> d;
 
 public:
     /// Creates a tagged struct with a single `name` tag.
@@ -30,8 +51,25 @@ public:
     /// otherwise.
     auto tag(const std::string& key) const -> boost::optional<const std::string&>;
 
-    /// Returns a const reference to the underlying tags.
-    auto tags() const noexcept -> const container_type&;
+    /// Returns tags range sorted by key, including the name.
+    ///
+    /// The range refers to the underlying tags, so it doesn't allocate, and is valid as long as
+    /// this object is alive.
+    auto tags() const noexcept -> range_type;
+
+    /// Returns a copy of the underlying tags as a map.
+    auto to_map() const -> container_type;
+
+    /// Returns the number of tags, including the name.
+    auto size() const noexcept -> std::size_t;
+
+    /// Returns tags range sorted by key, including the name.
+    auto begin() const noexcept -> const_iterator;
+
+    auto end() const noexcept -> const_iterator;
+
+    /// Returns the hash value of the tags, which is computed once on construction.
+    auto hash() const noexcept -> std::size_t;
 
     /// Partial equality operators.
 
@@ -44,6 +82,61 @@ public:
     auto operator<(const tags_t& other) const -> bool;
 };
 
+/// A non-owning view of a tagged metric name, that allows to look up metrics without
+/// constructing `tags_t` and therefore without allocations.
+///
+/// The view hashes its content on construction, so it's worth to keep it around for frequent
+/// lookups. Both the name and the tags must outlive the view. Tag keys must be unique; the `name`
+/// tag is ignored in favor of the explicitly given name, just like `tags_t` does.
+class tags_view_t {
+public:
+    typedef std::pair<boost::string_ref, boost::string_ref> value_type;
+    typedef const value_type* const_iterator;
+
+private:
+    struct {
+        boost::string_ref name;
+        const value_type* first;
+        const value_type* last;
+        std::size_t hash;
+    } d;
+
+public:
+    /// Creates a view with a single `name` tag.
+    explicit tags_view_t(boost::string_ref name);
+
+    /// Creates a view of the given name and the given tags range.
+    tags_view_t(boost::string_ref name, const value_type* tags, std::size_t size);
+
+    template<std::size_t N>
+    tags_view_t(boost::string_ref name, const value_type (&tags)[N]) :
+        tags_view_t(name, tags, N)
+    {}
+
+    auto name() const noexcept -> boost::string_ref {
+        return d.name;
+    }
+
+    /// Returns the hash value, which is equal to the hash of the equivalent `tags_t`.
+    auto hash() const noexcept -> std::size_t {
+        return d.hash;
+    }
+
+    /// Returns the borrowed tags range, excluding the name.
+    auto begin() const noexcept -> const_iterator {
+        return d.first;
+    }
+
+    auto end() const noexcept -> const_iterator {
+        return d.last;
+    }
+
+    /// Checks whether the view describes the same tagged name as the given tags.
+    auto operator==(const tags_t& other) const -> bool;
+
+    auto operator!=(const tags_t& other) const -> bool;
+};
+
 } // namespace metrics
 
 namespace std {
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace metrics {
+
+/// A background service, which periodically calls subscribed functions from its own thread.
+///
+/// Meters and timers attached to a ticker have their exponentially-weighted moving averages
+/// decayed by the ticker instead of checking the clock on each update and read, which reduces
+/// marking an event to a few atomic additions.
+///
+/// A single ticker may be shared among any number of registries.
+class ticker_t {
+    class inner_t;
+    std::unique_ptr<inner_t> inner;
+
+public:
+    typedef std::uint64_t id_type;
+
+    /// Starts a new ticker thread, which calls subscribers every given interval.
+    ///
+    /// \param interval tick interval, which must be equal to the one moving averages expect,
+    ///     i.e. 5 seconds, for attaching meters and timers, which check it.
+    explicit ticker_t(std::chrono::milliseconds interval = std::chrono::seconds(5));
+
+    ticker_t(const ticker_t& other) = delete;
+
+    /// Stops the ticker thread and waits for it to finish the current tick.
+    ~ticker_t();
+
+    auto operator=(const ticker_t& other) -> ticker_t& = delete;
+
+    /// Returns the tick interval.
+    auto interval() const noexcept -> std::chrono::milliseconds;
+
+    /// Subscribes the given function to be called on each tick, returning the subscription id.
+    ///
+    /// \param fn function, that must be fast and must not throw, because all subscribers are
+    ///     called sequentially from the same thread.
+    auto subscribe(std::function<void()> fn) -> id_type;
+
+    /// Unsubscribes the function with the given id.
+    ///
+    /// After the call returns, the function is guaranteed neither to be running nor to be called
+    /// again, so it's safe to destroy everything it refers to.
+    auto unsubscribe(id_type id) -> void;
+};
+
+} // namespace metrics
@@ -1,7 +1,15 @@
 #pragma once
 
+#include <array>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
 
+#include "metrics/clock.hpp"
 #include "metrics/metric.hpp"
 
 namespace metrics {
@@ -27,6 +35,7 @@ public:
         const time_point timestamp;
 
     public:
+        /// Creates a new context, which is empty unless the parent timer samples it.
         context_t(timer_t* parent);
         context_t(const context_t& other) = delete;
         context_t(context_t&& other) = default;
@@ -51,7 +60,8 @@ public:
 
     /// Creates new measure context and returns it.
     ///
-    /// The timer will be updated automatically on context destruction.
+    /// The timer will be updated automatically on context destruction. Sampling timers return
+    /// empty contexts for skipped events, which neither read the clock nor update the timer.
     ///
     /// \note it's the user responsibility to keep timer instance alive until all detached contexts
     ///     be destroyed.
@@ -66,6 +76,36 @@ public:
 
     /// Adds a manually recorded duration.
     virtual auto update(duration_type duration) -> void = 0;
+
+    /// Adds manually recorded durations at once.
+    ///
+    /// Timers override this to amortize synchronization and clock reads over the whole batch,
+    /// while the default implementation adds durations one by one.
+    ///
+    /// \param durations pointer to the first of `size` durations.
+    virtual auto update(const duration_type* durations, std::size_t size) -> void;
+
+protected:
+    /// Decides whether the next context is measured.
+    ///
+    /// Sampling timers, which skip the context, must count the event here, because empty
+    /// contexts don't notify the timer.
+    virtual auto sample() -> bool {
+        return true;
+    }
+
+    /// Returns an opaque timestamp marking the beginning of a measured context.
+    ///
+    /// Timers, which clocks are cheaper to read in their own units, may return raw ticks here
+    /// and convert only the measured span in `record()`.
+    virtual auto stamp() const -> time_point {
+        return now();
+    }
+
+    /// Records the span since the given timestamp returned by `stamp()`.
+    virtual auto record(time_point start) -> void {
+        update(now() - start);
+    }
 };
 
 /// Represents a timer metric which aggregates timing durations and provides duration statistics,
@@ -82,6 +122,32 @@ public:
     typedef Accumulate accumulator_type;
     typedef typename accumulator_type::snapshot_type snapshot_type;
 
+    /// Timer rates and duration statistics read at once.
+    ///
+    /// Plain old data, so quantiles are kept in a fixed array.
+    struct summary_t {
+        /// The maximum number of quantiles evaluated at once.
+        static constexpr std::size_t max_quantiles = 8;
+
+        /// The number of events which have occurred, including ones skipped by sampling.
+        std::uint64_t count;
+        /// The mean rate since the timer was created.
+        double mean_rate;
+        /// One-, five- and fifteen-minute exponentially-weighted moving average rates.
+        double m01rate;
+        double m05rate;
+        double m15rate;
+        /// Duration statistics in nanoseconds, evaluated over measured events only.
+        std::uint64_t min;
+        std::uint64_t max;
+        double mean;
+        double stddev;
+        /// The number of requested quantiles.
+        std::size_t size;
+        /// Durations at the requested quantiles, in the same order, followed by zeros.
+        std::array<double, max_quantiles> quantiles;
+    };
+
 public:
     /// Returns the number of events which have occurred.
     virtual auto count() const -> std::uint64_t = 0;
@@ -99,7 +165,243 @@ public:
     virtual auto m15rate() const -> double = 0;
 
     /// Returns the full statistics snapshot.
+    ///
+    /// \note sampling timers record measured events only, each weighted by the sampling rate, so
+    ///     the snapshot size estimates the number of events, which is exactly returned by
+    ///     `count()`. Quantiles and the mean stay unbiased estimates, while the extremes may be
+    ///     missed.
     virtual auto snapshot() const -> snapshot_type = 0;
+
+    /// Returns rates and duration statistics at once, taking a single snapshot and reading the
+    /// clock once.
+    ///
+    /// \param quantiles quantiles to evaluate, each in [0; 1] range.
+    /// \throws std::invalid_argument if more than `summary_t::max_quantiles` quantiles requested.
+    virtual auto summary(const std::vector<double>& quantiles) const -> summary_t = 0;
+};
+
+/// Decides which of measured contexts are recorded, choosing each one independently with the
+/// probability of `1 / every` using a thread-local xorshift generator.
+///
+/// Independent draws keep samples unbiased regardless of how contexts of different timers
+/// interleave on the same thread, which a shared countdown wouldn't.
+class sampler_t {
+    std::uint32_t rate;
+    std::uint64_t threshold;
+
+public:
+    /// Creates a new sampler, which chooses one of `every` contexts on average.
+    ///
+    /// \param every sampling rate, where both 0 and 1 mean sampling every context.
+    explicit sampler_t(std::uint32_t every = 1) noexcept :
+        rate(every == 0 ? 1 : every),
+        threshold(std::numeric_limits<std::uint64_t>::max() / rate)
+    {}
+
+    /// Returns the sampling rate.
+    auto every() const noexcept -> std::uint32_t {
+        return rate;
+    }
+
+    /// Returns true if the next context should be measured.
+    auto operator()() const noexcept -> bool {
+        return rate == 1 || next() < threshold;
+    }
+
+private:
+    static auto next() noexcept -> std::uint64_t {
+        thread_local std::uint64_t state = seed();
+
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        return state;
+    }
+
+    /// Mixes the address of the current thread's state with the current time using splitmix64
+    /// finalizer, which also guarantees non-zero seed required by xorshift.
+    static auto seed() noexcept -> std::uint64_t {
+        thread_local char anchor;
+
+        auto z = reinterpret_cast<std::uintptr_t>(&anchor) ^
+            static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        z = z ^ (z >> 31);
+
+        return z == 0 ? 1 : z;
+    }
+};
+
+/// Represents a measured RAII context bound to a timer of the statically known type.
+///
+/// Unlike `timer_t::context_t`, calls the timer directly rather than through the virtual
+/// interface, so for final timer types, like `static_timer`, the compiler is able to inline the
+/// path from taking the timestamp to recording the measured span.
+///
+/// Cannot be copied, but it's okay to move objects of this class.
+///
+/// \tparam `Timer` must provide public `sample()`, which decides whether to measure the context,
+///     `stamp()`, which returns a timestamp, and `record()`, which records the span since the
+///     given timestamp.
+template<class Timer>
+class static_context {
+public:
+    typedef Timer timer_type;
+    typedef decltype(std::declval<const timer_type&>().stamp()) time_point;
+
+private:
+    timer_type* parent;
+    time_point timestamp;
+
+public:
+    explicit static_context(timer_type& parent) :
+        parent(parent.sample() ? &parent : nullptr),
+        timestamp(this->parent != nullptr ? parent.stamp() : time_point())
+    {}
+
+    static_context(const static_context& other) = delete;
+
+    static_context(static_context&& other) noexcept :
+        parent(other.parent),
+        timestamp(other.timestamp)
+    {
+        other.parent = nullptr;
+    }
+
+    ~static_context() {
+        if (parent == nullptr) {
+            return;
+        }
+
+        try {
+            parent->record(timestamp);
+        } catch (...) {
+            // Ignore this, because of destructor exception safety reasons, as the type-erased
+            // context does.
+        }
+    }
+
+    auto operator=(const static_context& other) -> static_context& = delete;
+
+    /// Discards the current context, forcing it not to update the assosiated timer on
+    /// destruction.
+    ///
+    /// Can be safely called multiple times.
+    auto discard() noexcept -> void {
+        parent = nullptr;
+    }
+};
+
+/// A timer, which type is known statically, that allows to measure contexts without virtual calls.
+///
+/// Registered timers are of this type, see `registry_t::static_timer()`. Measured contexts call
+/// it through `static_context`, where sampling and taking timestamps are inlined into the caller,
+/// while recording the measured span, as well as counting a skipped one, is a single direct call
+/// into the library, where accumulators are compiled.
+///
+/// Cannot be copied.
+///
+/// \tparam `Accumulate` must be one of the accumulators provided by the library.
+template<class Accumulate>
+class static_timer final : public timer<Accumulate> {
+public:
+    typedef typename timer<Accumulate>::time_point time_point;
+    typedef typename timer<Accumulate>::duration_type duration_type;
+    typedef typename timer<Accumulate>::snapshot_type snapshot_type;
+    typedef typename timer<Accumulate>::summary_t summary_t;
+
+private:
+    struct data_t;
+
+    struct {
+        timer_clock_t clock;
+        sampler_t sampler;
+        std::unique_ptr<data_t> data;
+    } d;
+
+public:
+    /// Creates a new timer.
+    ///
+    /// \param every sampling rate, see `sampler_t`.
+    /// \param tsc whether to measure contexts using the time-stamp counter, see `timer_clock_t`.
+    explicit static_timer(std::uint32_t every = 1, bool tsc = false);
+
+    static_timer(const static_timer& other) = delete;
+
+    ~static_timer();
+
+    auto operator=(const static_timer& other) -> static_timer& = delete;
+
+    /// Attaches the underlying meter to the given ticker.
+    ///
+    /// \throws std::invalid_argument if the ticker interval isn't 5 seconds.
+    /// \warning must be called before the timer is shared with other threads.
+    auto attach(std::shared_ptr<ticker_t> ticker) -> void;
+
+    /// Returns a const reference to the clock.
+    auto clock() const noexcept -> const timer_clock_t& {
+        return d.clock;
+    }
+
+    /// Returns a const reference to the sampler.
+    auto sampler() const noexcept -> const sampler_t& {
+        return d.sampler;
+    }
+
+    auto now() const -> time_point override;
+
+    auto count() const -> std::uint64_t override;
+
+    auto m01rate() const -> double override;
+    auto m05rate() const -> double override;
+    auto m15rate() const -> double override;
+
+    auto snapshot() const -> snapshot_type override;
+
+    auto summary(const std::vector<double>& quantiles) const -> summary_t override;
+
+    auto update(duration_type duration) -> void override;
+    auto update(const duration_type* durations, std::size_t size) -> void override;
+
+    /// Creates a new measure context, which updates this timer without virtual calls.
+    auto context() -> static_context<static_timer> {
+        return static_context<static_timer>(*this);
+    }
+
+    /// Measures the time consumption of the given callable without virtual calls.
+    template<typename F>
+    auto measure(F fn) -> decltype(fn()) {
+        static_context<static_timer> context(*this);
+        return fn();
+    }
+
+    /// Measured spans, which are public for `static_context`.
+
+    auto sample() -> bool override {
+        if (d.sampler()) {
+            return true;
+        }
+
+        skip();
+        return false;
+    }
+
+    auto stamp() const -> time_point override {
+        return d.clock.stamp();
+    }
+
+    auto record(time_point start) -> void override {
+        record(d.clock.elapsed(start), d.sampler.every());
+    }
+
+private:
+    /// Counts the skipped context.
+    auto skip() -> void;
+
+    /// Records the measured span, that stands for `count` events.
+    auto record(duration_type duration, std::uint64_t count) -> void;
 };
 
 } // namespace metrics
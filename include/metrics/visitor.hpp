@@ -18,9 +18,14 @@ public:
     virtual auto visit(const gauge<std::string>& metric) -> void = 0;
     virtual auto visit(const std::atomic<std::int64_t>& metric) -> void = 0;
     virtual auto visit(const std::atomic<std::uint64_t>& metric) -> void = 0;
+    virtual auto visit(const counter_t& metric) -> void = 0;
     virtual auto visit(const meter_t& metric) -> void = 0;
     virtual auto visit(const timer<accumulator::sliding::window_t>& metric) -> void = 0;
     virtual auto visit(const timer<accumulator::decaying::exponentially_t>& metric) -> void = 0;
+    virtual auto visit(const timer<accumulator::sketch::tdigest_t>& metric) -> void = 0;
+    virtual auto visit(const timer<accumulator::sketch::ddsketch_t>& metric) -> void = 0;
+    virtual auto visit(const timer<accumulator::sliding::time_window_t>& metric) -> void = 0;
+    virtual auto visit(const timer<accumulator::hdr::histogram_t>& metric) -> void = 0;
 };
 
 } // namespace v3
@@ -1,9 +1,12 @@
 #include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <random>
 #include <stdexcept>
 #include <utility>
 
+#include <cstdint>
+
 #include "metrics/accumulator/decaying/exponentially.hpp"
 
 namespace metrics {
@@ -13,15 +16,46 @@ namespace decaying {
 constexpr auto DEFAULT_SIZE = 1024;
 constexpr auto ALPHA_INIT = 0.015;
 
+namespace {
+
+/// Heap comparator, which turns standard max-heap algorithms into min-heap ones.
+auto greater(const exponentially_t::entry_type& lhs, const exponentially_t::entry_type& rhs) -> bool {
+    return lhs.priority > rhs.priority;
+}
+
+/// SplitMix64 finalizer, which is a bijective mixing function.
+auto mix(std::uint64_t value) -> std::uint64_t {
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+    return value ^ (value >> 31);
+}
+
+/// Returns a uniformly distributed random number in (0, 1] from the calling thread stream, mixed
+/// with the given key.
+///
+/// Each thread owns a Weyl sequence started from a unique point, so no generator state is shared
+/// between threads.
+auto uniform(std::uint64_t key) -> double {
+    static std::atomic<std::uint64_t> streams(0);
+    static thread_local std::uint64_t state = mix(streams.fetch_add(1, std::memory_order_relaxed));
+
+    state += 0x9e3779b97f4a7c15;
+
+    // Take the highest 53 bits, which is the precision of double.
+    return static_cast<double>((mix(state ^ key) >> 11) + 1) / static_cast<double>(1ULL << 53);
+}
+
+}  // namespace
+
 exponentially_t::exponentially_t() : exponentially_t(DEFAULT_SIZE, ALPHA_INIT) {}
 
 exponentially_t::exponentially_t(std::size_t size, double alpha,
-    duration_type rescale_period, boost::optional<std::mt19937::result_type> seed) :
+    duration_type rescale_period, boost::optional<std::uint64_t> key) :
     sample_size{size},
     alpha{alpha},
-    start_time{clock_type::now()},
+    start_time{clock_type::now().time_since_epoch().count()},
     rescale_threshold{rescale_period},
-    uniform_dist{0.0, std::nextafter(1.0, std::numeric_limits<distr_real_type>::max())}
+    threshold{0.0}
 {
     if (sample_size == 0) {
         throw std::invalid_argument("sample reservoir can't be of zero size");
@@ -35,51 +69,97 @@ exponentially_t::exponentially_t(std::size_t size, double alpha,
         throw std::invalid_argument("can't manage empty rescale interval");
     }
 
-    if (seed) {
-        gen.seed(*seed);
+    samples.reserve(sample_size);
+
+    if (key) {
+        this->key = mix(*key);
     } else {
         std::random_device dev;
-        gen.seed(dev());
+        this->key = mix((static_cast<std::uint64_t>(dev()) << 32) | dev());
     }
 
-    const auto rescale_since_epoch = start_time.time_since_epoch() + rescale_threshold;
+    const auto rescale_since_epoch = duration_type(start_time.load()) + rescale_threshold;
     rescale_time = std::chrono::duration_cast<us_type>(rescale_since_epoch).count();
 }
 
 auto exponentially_t::update(std::uint64_t value, time_point t) -> void {
-    // Rescale "if ever that time come".
-    const auto now = clock_type::now();
+    update_n(value, 1, t);
+}
+
+auto exponentially_t::update_n(std::uint64_t value, std::uint64_t count, time_point t) -> void {
+    // Rescale "if ever that time come". The given timestamp is used instead of reading the
+    // clock again, which also keeps the weight and the rescale decision consistent.
     const auto rtm = us_type{rescale_time.load()};
-    if (now.time_since_epoch() > rtm) {
-        rescale(now, rtm.count());
+    if (t.time_since_epoch() > rtm) {
+        rescale(t, rtm.count());
     }
 
-    const auto u = uniform_dist(gen);
-    if (u == 0.0) {
-        return;
-    }
+    const auto u = uniform(key);
 
-    const auto diff = std::chrono::duration_cast<seconds_type>(t - start_time);
+    const auto start = start_time.load(std::memory_order_acquire);
+    auto w = weight(t, start) * static_cast<double>(count);
+    auto prior = w / u;
 
-    // Note: non normolized weights, sufficient for reservoir sampling
-    const auto w = exp(alpha * diff.count());
-    const auto prior = w / u;
+    if (prior <= threshold.load(std::memory_order_relaxed)) {
+        return;
+    }
 
     std::lock_guard<std::mutex> lock(samples_mut);
 
-    samples.emplace(prior, sample_type{value, w});
-
-    if (samples.size() > sample_size) {
-        samples.erase(std::begin(samples));
+    // The reservoir may have been rescaled in the meantime, so the weight must be relative to
+    // the same starting point as the stored ones.
+    const auto actual = start_time.load(std::memory_order_relaxed);
+    if (actual != start) {
+        w = weight(t, actual) * static_cast<double>(count);
+        prior = w / u;
     }
+
+    insert(prior, value, w);
 }
 
 auto exponentially_t::operator()(std::uint64_t value, time_point timestamp) -> void {
     update(value, timestamp);
 }
 
+auto exponentially_t::update(const std::uint64_t* values, std::size_t size, time_point t) -> void {
+    const auto rtm = us_type{rescale_time.load()};
+    if (t.time_since_epoch() > rtm) {
+        rescale(t, rtm.count());
+    }
+
+    // All values share the timestamp, hence the weight.
+    auto start = start_time.load(std::memory_order_acquire);
+    auto w = weight(t, start);
+
+    std::unique_lock<std::mutex> lock(samples_mut, std::defer_lock);
+
+    for (std::size_t id = 0; id < size; ++id) {
+        const auto u = uniform(key);
+        auto prior = w / u;
+
+        if (prior <= threshold.load(std::memory_order_relaxed)) {
+            continue;
+        }
+
+        if (!lock.owns_lock()) {
+            lock.lock();
+
+            // Once locked, the reservoir can't be rescaled until the batch is done.
+            const auto actual = start_time.load(std::memory_order_relaxed);
+            if (actual != start) {
+                start = actual;
+                w = weight(t, start);
+                prior = w / u;
+            }
+        }
+
+        insert(prior, values[id], w);
+    }
+}
+
 auto exponentially_t::size() const noexcept -> size_t {
-    return std::min(sample_size, samples.size());
+    std::lock_guard<std::mutex> lock(samples_mut);
+    return samples.size();
 }
 
 auto exponentially_t::snapshot() const -> snapshot_type {
@@ -89,40 +169,62 @@ auto exponentially_t::snapshot() const -> snapshot_type {
     {
         std::lock_guard<std::mutex> lock(samples_mut);
 
-        for(const auto& smpl : samples) {
-            result.emplace_back(smpl.second);
+        for (const auto& entry : samples) {
+            result.emplace_back(entry.sample);
         }
     }
 
     return snapshot_type(std::move(result));
 }
 
+auto exponentially_t::insert(double priority, std::uint64_t value, double weight) -> void {
+    if (samples.size() < sample_size) {
+        samples.push_back(entry_type{priority, sample_type{value, weight}});
+        std::push_heap(std::begin(samples), std::end(samples), &greater);
+    } else if (priority > samples.front().priority) {
+        std::pop_heap(std::begin(samples), std::end(samples), &greater);
+        samples.back() = entry_type{priority, sample_type{value, weight}};
+        std::push_heap(std::begin(samples), std::end(samples), &greater);
+    } else {
+        return;
+    }
+
+    if (samples.size() == sample_size) {
+        threshold.store(samples.front().priority, std::memory_order_relaxed);
+    }
+}
+
 auto exponentially_t::rescale(time_point now, us_int_type next) -> void {
     const auto rsctm = now.time_since_epoch() + rescale_threshold;
     const auto addon = std::chrono::duration_cast<us_type>(rsctm).count();
 
     if (rescale_time.compare_exchange_strong(next, addon)) {
-        const auto old_time = start_time;
-        start_time = now;
-
-        const auto tm_diff = std::chrono::duration_cast<seconds_type>(start_time - old_time);
-        const auto scale = exp(-alpha * tm_diff.count());
-
-        samples_mapping_type new_samples;
-
         std::lock_guard<std::mutex> lock(samples_mut);
 
-        for(const auto& kv : samples) {
-            const auto& k = kv.first;
-            const auto& v = kv.second;
+        const auto old_time = time_point(duration_type(start_time.load(std::memory_order_relaxed)));
+        start_time.store(now.time_since_epoch().count(), std::memory_order_release);
 
-            new_samples.emplace(k * scale, sample_type{v.value, v.weight * scale});
+        const auto tm_diff = std::chrono::duration_cast<seconds_type>(now - old_time);
+        const auto scale = exp(-alpha * tm_diff.count());
+
+        // Scaling by a positive factor preserves the heap order.
+        for (auto& entry : samples) {
+            entry.priority *= scale;
+            entry.sample.weight *= scale;
         }
 
-        samples.swap(new_samples);
+        threshold.store(samples.size() == sample_size ? samples.front().priority : 0.0,
+            std::memory_order_relaxed);
     }
 }
 
+auto exponentially_t::weight(time_point timestamp, duration_type::rep start) const -> double {
+    const auto diff = std::chrono::duration_cast<seconds_type>(timestamp - time_point(duration_type(start)));
+
+    // Note: non normolized weights, sufficient for reservoir sampling
+    return exp(alpha * diff.count());
+}
+
 }  // namespace decaying
 }  // namespace accumulator
 }  // namespace metrics
@@ -0,0 +1,264 @@
+#include "metrics/accumulator/hdr/histogram.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace metrics {
+namespace accumulator {
+namespace hdr {
+
+namespace {
+
+/// One hour in nanoseconds.
+constexpr std::uint64_t default_highest = 3600ULL * 1000 * 1000 * 1000;
+
+/// Returns the number of bits required to represent the given non-zero value.
+auto bits(std::uint64_t value) noexcept -> unsigned int {
+    return 64 - static_cast<unsigned int>(__builtin_clzll(value));
+}
+
+/// Number of values, which bucket indexes are computed at once by batch updates.
+constexpr std::size_t chunk_size = 64;
+
+#if defined(__x86_64__)
+
+// GCC intrinsics fill unused masked lanes with deliberately undefined values, which triggers
+// false positives once inlined.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+/// Computes bucket indexes of eight values at a time using the vector count-leading-zeros
+/// instruction, returning the number of processed values, which is a multiple of eight.
+///
+/// Mirrors `histogram_t::index()` lane by lane, see it for the arithmetic.
+__attribute__((target("avx512f,avx512cd")))
+auto indexes_avx512(const std::uint64_t* values,
+                    std::size_t size,
+                    std::uint64_t highest,
+                    unsigned int magnitude,
+                    std::uint64_t* result,
+                    std::uint64_t& sum) noexcept -> std::size_t
+{
+    const auto top = _mm512_set1_epi64(static_cast<long long>(highest));
+    const auto mask = _mm512_set1_epi64(static_cast<long long>((std::uint64_t(1) << (magnitude + 1)) - 1));
+    const auto base = _mm512_set1_epi64(63 - static_cast<long long>(magnitude));
+    const auto one = _mm512_set1_epi64(1);
+    const auto half = _mm512_set1_epi64(static_cast<long long>(std::uint64_t(1) << magnitude));
+    const auto shift = _mm_cvtsi32_si128(static_cast<int>(magnitude));
+
+    auto total = _mm512_setzero_si512();
+
+    std::size_t id = 0;
+    for (; id + 8 <= size; id += 8) {
+        auto value = _mm512_loadu_si512(values + id);
+        value = _mm512_min_epu64(value, top);
+        total = _mm512_add_epi64(total, value);
+
+        const auto range = _mm512_sub_epi64(base, _mm512_lzcnt_epi64(_mm512_or_si512(value, mask)));
+        const auto sub = _mm512_srlv_epi64(value, range);
+        const auto index = _mm512_add_epi64(
+            _mm512_sll_epi64(_mm512_add_epi64(range, one), shift),
+            _mm512_sub_epi64(sub, half)
+        );
+
+        _mm512_storeu_si512(result + id, index);
+    }
+
+    sum += static_cast<std::uint64_t>(_mm512_reduce_add_epi64(total));
+
+    return id;
+}
+
+#pragma GCC diagnostic pop
+
+auto has_avx512() noexcept -> bool {
+    static const bool result = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512cd");
+    return result;
+}
+
+#endif
+
+}  // namespace
+
+histogram_t::histogram_t() :
+    histogram_t(2, default_highest)
+{}
+
+histogram_t::histogram_t(int digits, value_type highest) {
+    if (digits < 1 || digits > 5) {
+        throw std::invalid_argument("number of significant digits must be in [1; 5] range");
+    }
+
+    if (highest < 2) {
+        throw std::invalid_argument("highest trackable value must be at least 2");
+    }
+
+    // Distinguishing `digits` decimal digits within a single power-of-two range requires at least
+    // 2 * 10^digits sub-buckets, rounded up to a power of two.
+    const auto largest = 2 * static_cast<std::uint64_t>(std::pow(10, digits));
+    const auto magnitude = bits(largest - 1);
+
+    // The first range covers [0; 2^magnitude) with unit resolution, each next one doubles both the
+    // upper bound and the sub-bucket width.
+    std::size_t ranges = 1;
+    auto untrackable = std::uint64_t(1) << magnitude;
+    while (untrackable <= highest) {
+        ++ranges;
+
+        if (untrackable > std::numeric_limits<std::uint64_t>::max() / 2) {
+            break;
+        }
+
+        untrackable <<= 1;
+    }
+
+    d.highest = highest;
+    d.magnitude = magnitude - 1;
+    d.size = (ranges + 1) << d.magnitude;
+    d.counts.reset(new std::atomic<std::uint64_t>[d.size]);
+    d.sum.store(0, std::memory_order_relaxed);
+
+    for (std::size_t id = 0; id < d.size; ++id) {
+        d.counts[id].store(0, std::memory_order_relaxed);
+    }
+}
+
+auto histogram_t::size() const noexcept -> std::size_t {
+    return d.size;
+}
+
+auto histogram_t::highest() const noexcept -> value_type {
+    return d.highest;
+}
+
+auto histogram_t::snapshot() const -> snapshot_type {
+    std::vector<snapshot_type::bucket_type> buckets;
+
+    // Concurrent updates may be partially visible, which slightly skews the mean only.
+    const auto sum = static_cast<double>(d.sum.load(std::memory_order_relaxed));
+
+    for (std::size_t id = 0; id < d.size; ++id) {
+        const auto count = d.counts[id].load(std::memory_order_relaxed);
+        if (count != 0) {
+            // Represent the bucket with its middle value, which halves the maximum error.
+            buckets.emplace_back(lowest_equivalent(id) + width(id) / 2, count);
+        }
+    }
+
+    return snapshot_type(std::move(buckets), sum);
+}
+
+auto histogram_t::reset() noexcept -> void {
+    for (std::size_t id = 0; id < d.size; ++id) {
+        d.counts[id].store(0, std::memory_order_relaxed);
+    }
+
+    d.sum.store(0, std::memory_order_relaxed);
+}
+
+auto histogram_t::update(value_type value) noexcept -> void {
+    update_n(value, 1);
+}
+
+auto histogram_t::update_n(value_type value, std::uint64_t count) noexcept -> void {
+    if (value > d.highest) {
+        value = d.highest;
+    }
+
+    d.counts[index(value)].fetch_add(count, std::memory_order_relaxed);
+    d.sum.fetch_add(value * count, std::memory_order_relaxed);
+}
+
+auto histogram_t::operator()(value_type value) noexcept -> void {
+    update(value);
+}
+
+auto histogram_t::update(const value_type* values, std::size_t size) noexcept -> void {
+    std::array<std::uint64_t, chunk_size> ids;
+    value_type sum = 0;
+
+    while (size > 0) {
+        const auto chunk = std::min(size, chunk_size);
+        sum += indexes(values, chunk, ids.data());
+
+        // Durations of a batch are often close to each other, so adjacent equal buckets are
+        // incremented at once.
+        for (std::size_t id = 0; id < chunk;) {
+            auto end = id + 1;
+            while (end < chunk && ids[end] == ids[id]) {
+                ++end;
+            }
+
+            d.counts[ids[id]].fetch_add(end - id, std::memory_order_relaxed);
+            id = end;
+        }
+
+        values += chunk;
+        size -= chunk;
+    }
+
+    d.sum.fetch_add(sum, std::memory_order_relaxed);
+}
+
+auto histogram_t::index(value_type value) const noexcept -> std::size_t {
+    const auto mask = (std::uint64_t(1) << (d.magnitude + 1)) - 1;
+
+    // Index of the power-of-two range, where all values below 2^(magnitude + 1) fall into zero.
+    const auto range = bits(value | mask) - (d.magnitude + 1);
+    const auto sub = value >> range;
+
+    return ((range + 1) << d.magnitude) + (sub - (std::uint64_t(1) << d.magnitude));
+}
+
+auto histogram_t::indexes(const value_type* values, std::size_t size, std::uint64_t* result) const noexcept
+    -> value_type
+{
+    value_type sum = 0;
+    std::size_t id = 0;
+
+#if defined(__x86_64__)
+    if (has_avx512()) {
+        id = indexes_avx512(values, size, d.highest, d.magnitude, result, sum);
+    }
+#endif
+
+    for (; id < size; ++id) {
+        const auto value = std::min(values[id], d.highest);
+        result[id] = index(value);
+        sum += value;
+    }
+
+    return sum;
+}
+
+auto histogram_t::lowest_equivalent(std::size_t index) const noexcept -> value_type {
+    const auto half = std::uint64_t(1) << d.magnitude;
+
+    auto range = static_cast<std::int64_t>(index >> d.magnitude) - 1;
+    auto sub = (index & (half - 1)) + half;
+
+    if (range < 0) {
+        sub -= half;
+        range = 0;
+    }
+
+    return sub << range;
+}
+
+auto histogram_t::width(std::size_t index) const noexcept -> value_type {
+    const auto range = static_cast<std::int64_t>(index >> d.magnitude) - 1;
+    return std::uint64_t(1) << (range < 0 ? 0 : range);
+}
+
+} // namespace hdr
+} // namespace accumulator
+} // namespace metrics
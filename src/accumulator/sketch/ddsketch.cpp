@@ -0,0 +1,393 @@
+#include "metrics/accumulator/sketch/ddsketch.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace metrics {
+namespace accumulator {
+namespace sketch {
+
+namespace {
+
+/// Version of the binary encoding.
+constexpr std::uint8_t version = 1;
+
+/// The maximum number of buckets accepted from the binary encoding, which bounds the memory a
+/// malformed or malicious blob can make the decoder and further updates allocate.
+constexpr std::uint64_t max_decoded_bins = 1 << 16;
+
+auto put(std::string& out, std::uint64_t value) -> void {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+
+    out.push_back(static_cast<char>(value));
+}
+
+auto put(std::string& out, double value) -> void {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    for (int id = 0; id < 8; ++id) {
+        out.push_back(static_cast<char>(bits >> (8 * id)));
+    }
+}
+
+/// Sequential reader of the binary encoding.
+class reader_t {
+    const std::string& data;
+    std::size_t position;
+
+public:
+    explicit reader_t(const std::string& data) :
+        data(data),
+        position(0)
+    {}
+
+    auto byte() -> std::uint8_t {
+        if (position >= data.size()) {
+            throw std::invalid_argument("malformed sketch: unexpected end of data");
+        }
+
+        return static_cast<std::uint8_t>(data[position++]);
+    }
+
+    auto varint() -> std::uint64_t {
+        std::uint64_t result = 0;
+        for (unsigned int shift = 0; shift < 64; shift += 7) {
+            const auto value = byte();
+            result |= static_cast<std::uint64_t>(value & 0x7f) << shift;
+
+            if ((value & 0x80) == 0) {
+                return result;
+            }
+        }
+
+        throw std::invalid_argument("malformed sketch: varint is too long");
+    }
+
+    auto real() -> double {
+        std::uint64_t bits = 0;
+        for (int id = 0; id < 8; ++id) {
+            bits |= static_cast<std::uint64_t>(byte()) << (8 * id);
+        }
+
+        double result;
+        std::memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
+    auto done() const noexcept -> bool {
+        return position == data.size();
+    }
+
+    /// Returns the number of bytes left.
+    auto remaining() const noexcept -> std::size_t {
+        return data.size() - position;
+    }
+};
+
+/// Maps signed integers to unsigned ones, so that small absolute values have small encodings.
+auto zigzag(std::int64_t value) -> std::uint64_t {
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+auto unzigzag(std::uint64_t value) -> std::int64_t {
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+}  // namespace
+
+ddsketch_t::ddsketch_t() :
+    ddsketch_t(0.01, 2048)
+{}
+
+ddsketch_t::ddsketch_t(double accuracy, std::size_t max_bins) {
+    if (!(accuracy > 0.0 && accuracy < 1.0)) {
+        throw std::invalid_argument("relative accuracy must be in (0; 1) range");
+    }
+
+    if (max_bins == 0) {
+        throw std::invalid_argument("maximum number of buckets must be at least 1");
+    }
+
+    d.accuracy = accuracy;
+    d.gamma = (1.0 + accuracy) / (1.0 - accuracy);
+    d.multiplier = 1.0 / std::log(d.gamma);
+    d.max_bins = max_bins;
+    d.offset = 0;
+    d.zero = 0;
+    d.sum = 0;
+}
+
+ddsketch_t::ddsketch_t(const ddsketch_t& other) {
+    std::lock_guard<std::mutex> lock(other.d.mutex);
+
+    d.accuracy = other.d.accuracy;
+    d.gamma = other.d.gamma;
+    d.multiplier = other.d.multiplier;
+    d.max_bins = other.d.max_bins;
+    d.offset = other.d.offset;
+    d.bins = other.d.bins;
+    d.zero = other.d.zero;
+    d.sum = other.d.sum;
+}
+
+auto ddsketch_t::accuracy() const noexcept -> double {
+    return d.accuracy;
+}
+
+auto ddsketch_t::max_bins() const noexcept -> std::size_t {
+    return d.max_bins;
+}
+
+auto ddsketch_t::size() const -> std::uint64_t {
+    std::lock_guard<std::mutex> lock(d.mutex);
+
+    std::uint64_t result = d.zero;
+    for (auto count : d.bins) {
+        result += count;
+    }
+
+    return result;
+}
+
+auto ddsketch_t::snapshot() const -> snapshot_type {
+    std::vector<snapshot_type::bucket_type> buckets;
+    double sum;
+
+    {
+        std::lock_guard<std::mutex> lock(d.mutex);
+
+        buckets.reserve(d.bins.size() + 1);
+        if (d.zero != 0) {
+            buckets.emplace_back(0, d.zero);
+        }
+
+        for (std::size_t id = 0; id < d.bins.size(); ++id) {
+            if (d.bins[id] == 0) {
+                continue;
+            }
+
+            // The value, which relative error to both bucket bounds equals the accuracy.
+            const auto key = d.offset + static_cast<std::int64_t>(id);
+            const auto value = static_cast<value_type>(
+                std::llround(2.0 * std::pow(d.gamma, key) / (d.gamma + 1.0))
+            );
+
+            // Adjacent buckets of small values may be rounded to the same integer.
+            if (!buckets.empty() && buckets.back().first == value) {
+                buckets.back().second += d.bins[id];
+            } else {
+                buckets.emplace_back(value, d.bins[id]);
+            }
+        }
+
+        sum = static_cast<double>(d.sum);
+    }
+
+    return snapshot_type(std::move(buckets), sum);
+}
+
+auto ddsketch_t::update(value_type value) -> void {
+    update_n(value, 1);
+}
+
+auto ddsketch_t::update_n(value_type value, std::uint64_t count) -> void {
+    if (value == 0) {
+        std::lock_guard<std::mutex> lock(d.mutex);
+        d.zero += count;
+        return;
+    }
+
+    const auto key = this->key(value);
+
+    std::lock_guard<std::mutex> lock(d.mutex);
+
+    const auto lowest = extend(key, key);
+    d.bins[static_cast<std::size_t>(std::max(key, lowest) - d.offset)] += count;
+    d.sum += value * count;
+}
+
+auto ddsketch_t::operator()(value_type value) -> void {
+    update(value);
+}
+
+auto ddsketch_t::update(const value_type* values, std::size_t size) -> void {
+    std::array<std::int64_t, 256> keys;
+
+    while (size > 0) {
+        const auto chunk = std::min(size, keys.size());
+
+        std::uint64_t zero = 0;
+        std::uint64_t sum = 0;
+        auto lowest = std::numeric_limits<std::int64_t>::max();
+        auto highest = std::numeric_limits<std::int64_t>::min();
+
+        // Zeros have no key and are counted separately.
+        for (std::size_t id = 0; id < chunk; ++id) {
+            if (values[id] == 0) {
+                ++zero;
+                continue;
+            }
+
+            keys[id] = key(values[id]);
+            lowest = std::min(lowest, keys[id]);
+            highest = std::max(highest, keys[id]);
+            sum += values[id];
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(d.mutex);
+
+            d.zero += zero;
+
+            if (zero != chunk) {
+                const auto covered = extend(lowest, highest);
+                for (std::size_t id = 0; id < chunk; ++id) {
+                    if (values[id] != 0) {
+                        ++d.bins[static_cast<std::size_t>(std::max(keys[id], covered) - d.offset)];
+                    }
+                }
+
+                d.sum += sum;
+            }
+        }
+
+        values += chunk;
+        size -= chunk;
+    }
+}
+
+auto ddsketch_t::merge(const ddsketch_t& other) -> void {
+    if (d.gamma != other.d.gamma) {
+        throw std::invalid_argument("sketches with different accuracy can't be merged");
+    }
+
+    // Copy first, which both avoids deadlocks and allows to merge the sketch into itself.
+    const ddsketch_t copy(other);
+
+    std::lock_guard<std::mutex> lock(d.mutex);
+
+    d.zero += copy.d.zero;
+    d.sum += copy.d.sum;
+
+    if (copy.d.bins.empty()) {
+        return;
+    }
+
+    const auto highest = copy.d.offset + static_cast<std::int64_t>(copy.d.bins.size()) - 1;
+    const auto lowest = extend(copy.d.offset, highest);
+
+    for (std::size_t id = 0; id < copy.d.bins.size(); ++id) {
+        const auto key = std::max(copy.d.offset + static_cast<std::int64_t>(id), lowest);
+        d.bins[static_cast<std::size_t>(key - d.offset)] += copy.d.bins[id];
+    }
+}
+
+auto ddsketch_t::encode() const -> std::string {
+    std::string result;
+    result.push_back(static_cast<char>(version));
+    put(result, d.accuracy);
+    put(result, static_cast<std::uint64_t>(d.max_bins));
+
+    std::lock_guard<std::mutex> lock(d.mutex);
+
+    put(result, d.zero);
+    put(result, d.sum);
+    put(result, zigzag(d.offset));
+    put(result, static_cast<std::uint64_t>(d.bins.size()));
+    for (auto count : d.bins) {
+        put(result, count);
+    }
+
+    return result;
+}
+
+auto ddsketch_t::decode(const std::string& data) -> ddsketch_t {
+    reader_t reader(data);
+
+    if (reader.byte() != version) {
+        throw std::invalid_argument("malformed sketch: unsupported version");
+    }
+
+    const auto accuracy = reader.real();
+    const auto max_bins = reader.varint();
+    if (max_bins > max_decoded_bins) {
+        throw std::invalid_argument("malformed sketch: maximum number of buckets is too large");
+    }
+
+    ddsketch_t result(accuracy, static_cast<std::size_t>(max_bins));
+    result.d.zero = reader.varint();
+    result.d.sum = reader.varint();
+    result.d.offset = unzigzag(reader.varint());
+
+    // Each bucket takes at least one byte.
+    const auto size = reader.varint();
+    if (size > max_bins || size > reader.remaining()) {
+        throw std::invalid_argument("malformed sketch: too many buckets");
+    }
+
+    // Keys of non-zero 64-bit values are in [0; key(max)] range, which also keeps bucket values
+    // finite.
+    const auto highest = result.key(std::numeric_limits<value_type>::max());
+    if (size != 0 && (result.d.offset < 0 || result.d.offset > highest - static_cast<std::int64_t>(size) + 1)) {
+        throw std::invalid_argument("malformed sketch: buckets are out of range");
+    }
+
+    result.d.bins.reserve(static_cast<std::size_t>(size));
+    for (std::uint64_t id = 0; id < size; ++id) {
+        result.d.bins.push_back(reader.varint());
+    }
+
+    if (!reader.done()) {
+        throw std::invalid_argument("malformed sketch: trailing data");
+    }
+
+    return result;
+}
+
+auto ddsketch_t::key(value_type value) const noexcept -> std::int64_t {
+    return static_cast<std::int64_t>(std::ceil(std::log(static_cast<double>(value)) * d.multiplier));
+}
+
+auto ddsketch_t::extend(std::int64_t lowest, std::int64_t highest) -> std::int64_t {
+    const auto size = static_cast<std::int64_t>(d.bins.size());
+
+    auto lo = lowest;
+    auto hi = highest;
+    if (size != 0) {
+        lo = std::min(lo, d.offset);
+        hi = std::max(hi, d.offset + size - 1);
+    }
+
+    // Collapse the lowest buckets, keeping the highest ones.
+    const auto max = static_cast<std::int64_t>(d.max_bins);
+    if (hi - lo + 1 > max) {
+        lo = hi - max + 1;
+    }
+
+    if (size != 0 && lo == d.offset && hi == d.offset + size - 1) {
+        return lo;
+    }
+
+    std::vector<std::uint64_t> bins(static_cast<std::size_t>(hi - lo + 1));
+    for (std::int64_t id = 0; id < size; ++id) {
+        const auto key = std::max(d.offset + id, lo);
+        bins[static_cast<std::size_t>(key - lo)] += d.bins[static_cast<std::size_t>(id)];
+    }
+
+    d.offset = lo;
+    d.bins.swap(bins);
+
+    return lo;
+}
+
+} // namespace sketch
+} // namespace accumulator
+} // namespace metrics
@@ -0,0 +1,335 @@
+#include "metrics/accumulator/sketch/tdigest.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+namespace metrics {
+namespace accumulator {
+namespace sketch {
+
+namespace {
+
+/// Marks a claimed buffer slot, which value is not stored yet.
+constexpr std::uint64_t empty = std::numeric_limits<std::uint64_t>::max();
+
+/// Scale function, which maps quantiles to the k-scale, where each centroid may span at most a
+/// unit interval.
+///
+/// The logarithmic function keeps the size of centroids proportional to q * (1 - q), so the
+/// centroids near both tails are tiny, down to single values, which makes extreme quantiles
+/// accurate. The normalizer spreads the k-scale of the [1 / n; 1 - 1 / n] quantile range over
+/// the compression factor, which bounds the number of centroids by about that factor.
+class scale_t {
+    double normalizer;
+
+public:
+    scale_t(double compression, double total) :
+        normalizer(compression / (2 * std::log(std::max(total, 2.0))))
+    {}
+
+    auto k(double quantile) const -> double {
+        const auto q = std::min(std::max(quantile, 1e-15), 1 - 1e-15);
+        return normalizer * std::log(q / (1 - q));
+    }
+
+    auto q(double k) const -> double {
+        return 1 / (1 + std::exp(-k / normalizer));
+    }
+};
+
+auto less(const snapshot::digest_t::centroid_t& lhs, const snapshot::digest_t::centroid_t& rhs) -> bool {
+    return lhs.mean < rhs.mean;
+}
+
+/// Sorts centroids by mean, given that the first `sorted` of them are already sorted, which is
+/// cheaper than sorting all of them, because compressed centroids are always kept sorted.
+auto sort(std::vector<snapshot::digest_t::centroid_t>& centroids, std::size_t sorted) -> void {
+    const auto middle = centroids.begin() + static_cast<std::ptrdiff_t>(sorted);
+
+    std::sort(middle, centroids.end(), &less);
+    std::inplace_merge(centroids.begin(), middle, centroids.end(), &less);
+}
+
+/// Merges centroids sorted by mean, so that each of them satisfies the scale function bound.
+auto compress(std::vector<snapshot::digest_t::centroid_t>& centroids, double compression) -> void {
+    if (centroids.empty()) {
+        return;
+    }
+
+    double total = 0.0;
+    for (const auto& centroid : centroids) {
+        total += centroid.weight;
+    }
+
+    const scale_t scale(compression, total);
+
+    std::size_t current = 0;
+    double seen = 0.0;
+    double limit = total * scale.q(scale.k(0.0) + 1);
+
+    for (std::size_t id = 1; id < centroids.size(); ++id) {
+        auto& last = centroids[current];
+        const auto& next = centroids[id];
+
+        if (seen + last.weight + next.weight <= limit) {
+            const auto weight = last.weight + next.weight;
+            last.mean += (next.mean - last.mean) * next.weight / weight;
+            last.weight = weight;
+        } else {
+            seen += last.weight;
+            limit = total * scale.q(scale.k(seen / total) + 1);
+            centroids[++current] = next;
+        }
+    }
+
+    centroids.resize(current + 1);
+}
+
+}  // namespace
+
+tdigest_t::tdigest_t() :
+    tdigest_t(100, 512)
+{}
+
+tdigest_t::tdigest_t(double compression, std::size_t buffer) {
+    if (!(compression >= 1.0)) {
+        throw std::invalid_argument("compression must be at least 1");
+    }
+
+    if (buffer == 0) {
+        throw std::invalid_argument("buffer size must be at least 1");
+    }
+
+    d.compression = compression;
+    d.buffer.reset(new std::atomic<value_type>[buffer]);
+    d.buffer_size = buffer;
+    d.position.store(0, std::memory_order_relaxed);
+    d.min = std::numeric_limits<value_type>::max();
+    d.max = 0;
+
+    for (std::size_t id = 0; id < buffer; ++id) {
+        d.buffer[id].store(empty, std::memory_order_relaxed);
+    }
+}
+
+auto tdigest_t::compression() const noexcept -> double {
+    return d.compression;
+}
+
+auto tdigest_t::snapshot() const -> snapshot_type {
+    value_type min;
+    value_type max;
+    std::size_t sorted;
+    auto centroids = collect(min, max, sorted);
+
+    sort(centroids, sorted);
+    compress(centroids, d.compression);
+
+    return snapshot_type(std::move(centroids), min, max);
+}
+
+auto tdigest_t::update(value_type value) -> void {
+    // The sentinel is indistinguishable from a real value, so record it as the nearest one.
+    if (value == empty) {
+        --value;
+    }
+
+    const auto position = d.position.fetch_add(1, std::memory_order_acq_rel);
+    if (position < d.buffer_size) {
+        d.buffer[position].store(value, std::memory_order_release);
+        return;
+    }
+
+    // The buffer is full. The first writer, that acquires the mutex, flushes it, while all of
+    // them record their values directly.
+    std::lock_guard<std::mutex> lock(d.mutex);
+
+    if (d.position.load(std::memory_order_acquire) >= d.buffer_size) {
+        flush();
+    }
+
+    absorb({centroid_type{static_cast<double>(value), 1}}, value, value);
+}
+
+auto tdigest_t::operator()(value_type value) -> void {
+    update(value);
+}
+
+auto tdigest_t::update_n(value_type value, std::uint64_t count) -> void {
+    if (count == 1) {
+        update(value);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(d.mutex);
+
+    d.weighted.push_back(centroid_type{static_cast<double>(value), count});
+    if (d.weighted.size() >= d.buffer_size) {
+        drain();
+    }
+}
+
+auto tdigest_t::update(const value_type* values, std::size_t size) -> void {
+    if (size == 0) {
+        return;
+    }
+
+    const auto position = d.position.fetch_add(size, std::memory_order_acq_rel);
+
+    std::size_t stored = 0;
+    if (position < d.buffer_size) {
+        stored = std::min(size, d.buffer_size - position);
+
+        for (std::size_t id = 0; id < stored; ++id) {
+            const auto value = values[id] == empty ? values[id] - 1 : values[id];
+            d.buffer[position + id].store(value, std::memory_order_release);
+        }
+    }
+
+    if (stored == size) {
+        return;
+    }
+
+    std::vector<centroid_type> centroids;
+    centroids.reserve(size - stored);
+
+    auto min = std::numeric_limits<value_type>::max();
+    value_type max = 0;
+
+    for (auto id = stored; id < size; ++id) {
+        const auto value = values[id] == empty ? values[id] - 1 : values[id];
+
+        centroids.push_back(centroid_type{static_cast<double>(value), 1});
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+
+    std::sort(centroids.begin(), centroids.end(), &less);
+
+    // The buffer is full, see the single value update.
+    std::lock_guard<std::mutex> lock(d.mutex);
+
+    if (d.position.load(std::memory_order_acquire) >= d.buffer_size) {
+        flush();
+    }
+
+    absorb(std::move(centroids), min, max);
+}
+
+auto tdigest_t::merge(const tdigest_t& other) -> void {
+    value_type min;
+    value_type max;
+    std::size_t sorted;
+    auto centroids = other.collect(min, max, sorted);
+
+    sort(centroids, sorted);
+
+    std::lock_guard<std::mutex> lock(d.mutex);
+    absorb(std::move(centroids), min, max);
+}
+
+auto tdigest_t::collect(value_type& min, value_type& max, std::size_t& sorted) const ->
+    std::vector<centroid_type>
+{
+    std::lock_guard<std::mutex> lock(d.mutex);
+
+    const auto size = std::min(d.position.load(std::memory_order_acquire), d.buffer_size);
+
+    std::vector<centroid_type> result;
+    result.reserve(d.centroids.size() + d.weighted.size() + size);
+    result.insert(result.end(), d.centroids.begin(), d.centroids.end());
+
+    min = d.min;
+    max = d.max;
+    sorted = d.centroids.size();
+
+    for (const auto& centroid : d.weighted) {
+        const auto value = static_cast<value_type>(centroid.mean);
+
+        result.push_back(centroid);
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+
+    // Values being stored concurrently are skipped.
+    for (std::size_t id = 0; id < size; ++id) {
+        const auto value = d.buffer[id].load(std::memory_order_acquire);
+        if (value != empty) {
+            result.push_back(centroid_type{static_cast<double>(value), 1});
+            min = std::min(min, value);
+            max = std::max(max, value);
+        }
+    }
+
+    return result;
+}
+
+auto tdigest_t::absorb(std::vector<centroid_type> centroids, value_type min, value_type max) -> void {
+    if (centroids.empty()) {
+        return;
+    }
+
+    const auto sorted = centroids.size();
+    centroids.insert(centroids.end(), d.centroids.begin(), d.centroids.end());
+    std::inplace_merge(centroids.begin(), centroids.begin() + static_cast<std::ptrdiff_t>(sorted), centroids.end(), &less);
+
+    compress(centroids, d.compression);
+
+    d.centroids.swap(centroids);
+    d.min = std::min(d.min, min);
+    d.max = std::max(d.max, max);
+}
+
+auto tdigest_t::drain() -> void {
+    std::vector<centroid_type> centroids;
+    centroids.swap(d.weighted);
+
+    auto min = std::numeric_limits<value_type>::max();
+    value_type max = 0;
+
+    for (const auto& centroid : centroids) {
+        min = std::min(min, static_cast<value_type>(centroid.mean));
+        max = std::max(max, static_cast<value_type>(centroid.mean));
+    }
+
+    std::sort(centroids.begin(), centroids.end(), &less);
+    absorb(std::move(centroids), min, max);
+}
+
+auto tdigest_t::flush() -> void {
+    std::vector<centroid_type> centroids;
+    centroids.reserve(d.buffer_size);
+
+    auto min = std::numeric_limits<value_type>::max();
+    value_type max = 0;
+
+    for (std::size_t id = 0; id < d.buffer_size; ++id) {
+        auto& slot = d.buffer[id];
+
+        // All slots are claimed, but some writers may have not stored their values yet.
+        auto value = slot.load(std::memory_order_acquire);
+        while (value == empty) {
+            std::this_thread::yield();
+            value = slot.load(std::memory_order_acquire);
+        }
+
+        slot.store(empty, std::memory_order_relaxed);
+
+        centroids.push_back(centroid_type{static_cast<double>(value), 1});
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+
+    std::sort(centroids.begin(), centroids.end(), &less);
+    absorb(std::move(centroids), min, max);
+
+    // Slots are reset before releasing them, so new writers never race with draining.
+    d.position.store(0, std::memory_order_release);
+}
+
+} // namespace sketch
+} // namespace accumulator
+} // namespace metrics
@@ -0,0 +1,156 @@
+#include "metrics/accumulator/sliding/time_window.hpp"
+
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+namespace metrics {
+namespace accumulator {
+namespace sliding {
+
+namespace {
+
+/// One hour in nanoseconds.
+constexpr std::uint64_t default_highest = 3600ULL * 1000 * 1000 * 1000;
+
+/// Tick of a slot, that has never been used.
+constexpr std::int64_t unused = std::numeric_limits<std::int64_t>::min();
+
+/// Tick of a slot, that is being reset by some thread.
+constexpr std::int64_t resetting = std::numeric_limits<std::int64_t>::min() + 1;
+
+auto tick(time_window_t::time_point timestamp) -> std::int64_t {
+    return std::chrono::duration_cast<std::chrono::seconds>(timestamp.time_since_epoch()).count();
+}
+
+}  // namespace
+
+time_window_t::slot_t::slot_t(int digits, value_type highest) :
+    tick(unused),
+    histogram(digits, highest)
+{}
+
+time_window_t::time_window_t() :
+    time_window_t(std::chrono::seconds(10), 2, default_highest)
+{}
+
+time_window_t::time_window_t(std::chrono::seconds window, int digits, value_type highest) {
+    if (window.count() < 1) {
+        throw std::invalid_argument("window duration must be at least one second");
+    }
+
+    // Check the sub-histogram parameters eagerly, because sub-histograms are created lazily.
+    static_cast<void>(hdr::histogram_t(digits, highest));
+
+    d.digits = digits;
+    d.highest = highest;
+    d.size = static_cast<std::size_t>(window.count());
+    d.slots.reset(new std::atomic<slot_t*>[d.size]);
+
+    for (std::size_t id = 0; id < d.size; ++id) {
+        d.slots[id].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+time_window_t::~time_window_t() {
+    for (std::size_t id = 0; id < d.size; ++id) {
+        delete d.slots[id].load(std::memory_order_relaxed);
+    }
+}
+
+auto time_window_t::window() const noexcept -> std::chrono::seconds {
+    return std::chrono::seconds(static_cast<std::chrono::seconds::rep>(d.size));
+}
+
+auto time_window_t::snapshot(time_point timestamp) const -> snapshot_type {
+    const auto now = tick(timestamp);
+    const auto size = static_cast<std::int64_t>(d.size);
+
+    snapshot_type result({});
+    for (std::size_t id = 0; id < d.size; ++id) {
+        const auto slot = d.slots[id].load(std::memory_order_acquire);
+        if (slot == nullptr) {
+            continue;
+        }
+
+        // Sub-histograms being rotated concurrently may be seen partially reset.
+        const auto current = slot->tick.load(std::memory_order_acquire);
+        if (current > now - size && current <= now) {
+            result.merge(slot->histogram.snapshot());
+        }
+    }
+
+    return result;
+}
+
+auto time_window_t::update(value_type value, time_point timestamp) -> void {
+    if (auto slot = acquire(timestamp)) {
+        slot->histogram.update(value);
+    }
+}
+
+auto time_window_t::update_n(value_type value, std::uint64_t count, time_point timestamp) -> void {
+    if (auto slot = acquire(timestamp)) {
+        slot->histogram.update_n(value, count);
+    }
+}
+
+auto time_window_t::update(const value_type* values, std::size_t size, time_point timestamp) -> void {
+    if (auto slot = acquire(timestamp)) {
+        slot->histogram.update(values, size);
+    }
+}
+
+auto time_window_t::operator()(value_type value, time_point timestamp) -> void {
+    update(value, timestamp);
+}
+
+auto time_window_t::acquire(time_point timestamp) -> slot_t* {
+    const auto now = tick(timestamp);
+    auto& slot = allocate(static_cast<std::size_t>(now % static_cast<std::int64_t>(d.size)));
+
+    while (true) {
+        auto current = slot.tick.load(std::memory_order_acquire);
+
+        if (current == now) {
+            return &slot;
+        }
+
+        if (current == resetting) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        if (current > now) {
+            // The slot has already been taken by a newer second, so the value is out of window.
+            return nullptr;
+        }
+
+        if (slot.tick.compare_exchange_weak(current, resetting, std::memory_order_acquire)) {
+            slot.histogram.reset();
+            slot.tick.store(now, std::memory_order_release);
+            return &slot;
+        }
+    }
+}
+
+auto time_window_t::allocate(std::size_t id) -> slot_t& {
+    auto& link = d.slots[id];
+
+    auto slot = link.load(std::memory_order_acquire);
+    if (slot != nullptr) {
+        return *slot;
+    }
+
+    std::unique_ptr<slot_t> created(new slot_t(d.digits, d.highest));
+    if (link.compare_exchange_strong(slot, created.get(), std::memory_order_acq_rel)) {
+        return *created.release();
+    }
+
+    // Some other thread has installed its sub-histogram first, which is loaded on failure.
+    return *slot;
+}
+
+} // namespace sliding
+} // namespace accumulator
+} // namespace metrics
@@ -7,42 +7,202 @@ namespace accumulator {
 namespace sliding {
 
 window_t::window_t():
-    measurements(1024),
-    count(0)
+    window_t(1024)
 {}
 
 window_t::window_t(std::size_t size):
     measurements(size),
-    count(0)
+    count(0),
+    sequences(size)
+{
+    for (std::size_t slot = 0; slot < size; ++slot) {
+        measurements[slot].store(0, std::memory_order_relaxed);
+        sequences[slot].store(0, std::memory_order_relaxed);
+    }
+}
+
+window_t::cache_t::cache_t(std::size_t size) :
+    count(0),
+    slots(size),
+    present(size),
+    snapshot(snapshot_type::sorted_t(), {})
 {}
 
 auto window_t::snapshot() const -> window_t::snapshot_type {
-    const auto size = this->size();
+    const auto count = this->count.load(std::memory_order_acquire);
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (cache && cache->count == count && cache->pending.empty()) {
+        return cache->snapshot;
+    }
 
-    std::vector<std::uint64_t> result;
-    result.reserve(size);
+    // Patching is linear, but has a higher constant than sorting, so it pays off only when a
+    // small part of the window has changed.
+    if (cache && count - cache->count + cache->pending.size() <= measurements.size() / 8) {
+        patch(cache->count, count);
+    } else {
+        rebuild(count);
+    }
 
-    std::unique_lock<std::mutex> lock(mutex);
-    std::copy_n(measurements.begin(), size, std::back_inserter(result));
-    lock.unlock();
+    cache->count = count;
 
-    return snapshot_type(result);
+    return cache->snapshot;
 }
 
 auto window_t::size() const noexcept -> std::size_t {
-    std::lock_guard<std::mutex> lock(mutex);
-    return std::min(count.load(), measurements.size());
+    return std::min(count.load(std::memory_order_relaxed), measurements.size());
 }
 
 auto window_t::update(value_type value) noexcept -> void {
-    std::lock_guard<std::mutex> lock(mutex);
-    measurements[count++ % measurements.size()] = value;
+    store(count.fetch_add(1, std::memory_order_relaxed), value);
+}
+
+auto window_t::update(const value_type* values, std::size_t size) noexcept -> void {
+    if (size == 0) {
+        return;
+    }
+
+    const auto id = count.fetch_add(size, std::memory_order_relaxed);
+
+    // Only the last window worth of values survives anyway.
+    const auto skip = size > measurements.size() ? size - measurements.size() : 0;
+    for (auto offset = skip; offset < size; ++offset) {
+        store(id + offset, values[offset]);
+    }
 }
 
 auto window_t::operator()(value_type value) noexcept -> void {
     update(value);
 }
 
+auto window_t::store(std::size_t id, value_type value) noexcept -> void {
+    const auto slot = id % measurements.size();
+
+    measurements[slot].store(value, std::memory_order_relaxed);
+    sequences[slot].store(id + 1, std::memory_order_release);
+}
+
+auto window_t::expected(std::size_t slot, std::size_t count) const noexcept -> std::size_t {
+    if (count <= slot) {
+        return 0;
+    }
+
+    const auto last = count - 1;
+    return last - (last - slot) % measurements.size() + 1;
+}
+
+auto window_t::read(std::size_t slot, std::size_t count, value_type& value, std::size_t& sequence) const
+    noexcept -> bool
+{
+    // The value is at least as new as the sequence number, but may be even newer if some writer
+    // is storing into the slot right now, in which case its claim is either pending or not yet
+    // observed, so the slot is read again later either way.
+    sequence = sequences[slot].load(std::memory_order_acquire);
+    value = measurements[slot].load(std::memory_order_relaxed);
+
+    return sequence >= expected(slot, count);
+}
+
+auto window_t::rebuild(std::size_t count) const -> void {
+    if (!cache) {
+        cache.reset(new cache_t(measurements.size()));
+    }
+
+    cache->pending.clear();
+
+    std::vector<value_type> values;
+    values.reserve(measurements.size());
+
+    // Writers may concurrently overwrite slots, in which case the snapshot observes a mix of
+    // older and newer measurements, which is fine for statistics.
+    for (std::size_t slot = 0; slot < measurements.size(); ++slot) {
+        value_type value;
+        std::size_t sequence;
+        if (!read(slot, count, value, sequence)) {
+            cache->pending.push_back(slot);
+        }
+
+        cache->slots[slot] = value;
+        cache->present[slot] = sequence != 0;
+        if (sequence != 0) {
+            values.push_back(value);
+        }
+    }
+
+    // Sort right away, so that both patching and requests in order use the sorted values as is.
+    std::sort(values.begin(), values.end());
+    cache->snapshot = snapshot_type(snapshot_type::sorted_t(), std::move(values));
+}
+
+auto window_t::patch(std::size_t from, std::size_t to) const -> void {
+    std::vector<value_type> removed;
+    std::vector<value_type> added;
+
+    std::vector<std::size_t> slots;
+    slots.swap(cache->pending);
+    for (auto id = from; id < to; ++id) {
+        slots.push_back(id % measurements.size());
+    }
+
+    std::sort(slots.begin(), slots.end());
+    slots.erase(std::unique(slots.begin(), slots.end()), slots.end());
+
+    for (auto slot : slots) {
+        value_type value;
+        std::size_t sequence;
+        if (!read(slot, to, value, sequence)) {
+            cache->pending.push_back(slot);
+        }
+
+        // Overwriting a value with an equal one doesn't change the sorted values.
+        const bool present = sequence != 0;
+        if (present == cache->present[slot] && value == cache->slots[slot]) {
+            continue;
+        }
+
+        if (cache->present[slot]) {
+            removed.push_back(cache->slots[slot]);
+        }
+
+        if (present) {
+            added.push_back(value);
+        }
+
+        cache->slots[slot] = value;
+        cache->present[slot] = present;
+    }
+
+    std::sort(removed.begin(), removed.end());
+    std::sort(added.begin(), added.end());
+
+    const auto& previous = cache->snapshot.values();
+
+    std::vector<value_type> sorted;
+    sorted.reserve(previous.size() + added.size() - removed.size());
+
+    // Merge the previous values with the added ones, skipping the removed ones, which are
+    // guaranteed to be present in the previous values.
+    auto rm = removed.begin();
+    auto add = added.begin();
+    for (auto value : previous) {
+        if (rm != removed.end() && *rm == value) {
+            ++rm;
+            continue;
+        }
+
+        while (add != added.end() && *add < value) {
+            sorted.push_back(*add++);
+        }
+
+        sorted.push_back(value);
+    }
+
+    sorted.insert(sorted.end(), add, added.end());
+
+    cache->snapshot = snapshot_type(snapshot_type::sorted_t(), std::move(sorted));
+}
+
 }  // namespace sliding
 }  // namespace accumulator
 }  // namespace metrics
@@ -0,0 +1,135 @@
+#include "metrics/accumulator/snapshot/digest.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace metrics {
+namespace accumulator {
+namespace snapshot {
+
+digest_t::digest_t(std::vector<centroid_t> centroids, std::uint64_t min, std::uint64_t max) {
+    d.count = 0;
+    for (const auto& centroid : centroids) {
+        d.count += centroid.weight;
+    }
+
+    d.centroids = std::move(centroids);
+    d.min = min;
+    d.max = max;
+}
+
+auto digest_t::size() const noexcept -> std::uint64_t {
+    return d.count;
+}
+
+auto digest_t::centroids() const noexcept -> const std::vector<centroid_t>& {
+    return d.centroids;
+}
+
+auto digest_t::value(double quantile) const -> double {
+    if (quantile < 0.0 || quantile > 1.0 || std::isnan(quantile)) {
+        throw std::invalid_argument("quantile must be in [0; 1] range");
+    }
+
+    if (d.centroids.empty()) {
+        return 0.0;
+    }
+
+    const auto& centroids = d.centroids;
+    const auto index = quantile * d.count;
+
+    // Each centroid is assumed to be centered at its mean, so values between the neighbour
+    // midpoints are interpolated linearly, while the tails are stretched to the exact extremes.
+    const auto& first = centroids.front();
+    if (index < first.weight / 2.0) {
+        return d.min + (first.mean - d.min) * index / (first.weight / 2.0);
+    }
+
+    auto cumulative = first.weight / 2.0;
+    for (std::size_t id = 0; id + 1 < centroids.size(); ++id) {
+        const auto dw = (centroids[id].weight + centroids[id + 1].weight) / 2.0;
+        if (cumulative + dw > index) {
+            const auto t = (index - cumulative) / dw;
+            return centroids[id].mean + t * (centroids[id + 1].mean - centroids[id].mean);
+        }
+
+        cumulative += dw;
+    }
+
+    const auto& last = centroids.back();
+    const auto t = std::min(1.0, (index - cumulative) / (last.weight / 2.0));
+    return last.mean + t * (d.max - last.mean);
+}
+
+auto digest_t::phi(double value) const -> double {
+    if (d.centroids.empty() || value < d.min) {
+        return 0.0;
+    }
+
+    if (value >= d.max) {
+        return 1.0;
+    }
+
+    const auto& centroids = d.centroids;
+
+    const auto& first = centroids.front();
+    if (value < first.mean) {
+        return (first.weight / 2.0) * (value - d.min) / (first.mean - d.min) / d.count;
+    }
+
+    auto cumulative = first.weight / 2.0;
+    for (std::size_t id = 0; id + 1 < centroids.size(); ++id) {
+        const auto dw = (centroids[id].weight + centroids[id + 1].weight) / 2.0;
+        if (value < centroids[id + 1].mean) {
+            // Note: assured that the next mean is greater, so no check for zero division here.
+            const auto t = (value - centroids[id].mean) / (centroids[id + 1].mean - centroids[id].mean);
+            return (cumulative + t * dw) / d.count;
+        }
+
+        cumulative += dw;
+    }
+
+    const auto& last = centroids.back();
+    return (cumulative + (last.weight / 2.0) * (value - last.mean) / (d.max - last.mean)) / d.count;
+}
+
+auto digest_t::min() const -> std::uint64_t {
+    return d.centroids.empty() ? 0 : d.min;
+}
+
+auto digest_t::max() const -> std::uint64_t {
+    return d.centroids.empty() ? 0 : d.max;
+}
+
+auto digest_t::mean() const -> double {
+    if (d.count == 0) {
+        return 0;
+    }
+
+    double sum = 0.0;
+    for (const auto& centroid : d.centroids) {
+        sum += centroid.mean * centroid.weight;
+    }
+
+    return sum / d.count;
+}
+
+auto digest_t::stddev() const -> double {
+    if (d.count <= 1) {
+        return 0;
+    }
+
+    const auto mean = this->mean();
+
+    double variance = 0.0;
+    for (const auto& centroid : d.centroids) {
+        const auto diff = centroid.mean - mean;
+        variance += centroid.weight * diff * diff;
+    }
+
+    return std::sqrt(variance / d.count);
+}
+
+}  // namespace snapshot
+}  // namespace accumulator
+}  // namespace metrics
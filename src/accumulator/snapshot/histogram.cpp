@@ -0,0 +1,154 @@
+#include "metrics/accumulator/snapshot/histogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace metrics {
+namespace accumulator {
+namespace snapshot {
+
+namespace {
+
+auto count(const std::vector<histogram_t::bucket_type>& buckets) -> std::uint64_t {
+    std::uint64_t result = 0;
+    for (const auto& bucket : buckets) {
+        result += bucket.second;
+    }
+
+    return result;
+}
+
+auto sum(const std::vector<histogram_t::bucket_type>& buckets) -> double {
+    double result = 0.0;
+    for (const auto& bucket : buckets) {
+        result += static_cast<double>(bucket.first) * bucket.second;
+    }
+
+    return result;
+}
+
+}  // namespace
+
+histogram_t::histogram_t(std::vector<bucket_type> buckets) {
+    d.count = snapshot::count(buckets);
+    d.sum = snapshot::sum(buckets);
+    d.buckets = std::move(buckets);
+}
+
+histogram_t::histogram_t(std::vector<bucket_type> buckets, double sum) {
+    d.count = snapshot::count(buckets);
+    d.sum = sum;
+    d.buckets = std::move(buckets);
+}
+
+std::uint64_t
+histogram_t::size() const noexcept {
+    return d.count;
+}
+
+const std::vector<histogram_t::bucket_type>&
+histogram_t::buckets() const noexcept {
+    return d.buckets;
+}
+
+std::uint64_t
+histogram_t::min() const {
+    if (d.buckets.empty()) {
+        return 0;
+    }
+
+    return d.buckets.front().first;
+}
+
+std::uint64_t
+histogram_t::max() const {
+    if (d.buckets.empty()) {
+        return 0;
+    }
+
+    return d.buckets.back().first;
+}
+
+double
+histogram_t::mean() const {
+    if (d.count == 0) {
+        return 0;
+    }
+
+    return d.sum / d.count;
+}
+
+double
+histogram_t::stddev() const {
+    if (d.count <= 1) {
+        return 0;
+    }
+
+    const auto mean = this->mean();
+
+    double sum = 0.0;
+    for (const auto& bucket : d.buckets) {
+        const auto diff = bucket.first - mean;
+        sum += diff * diff * bucket.second;
+    }
+
+    const auto variance = sum / (d.count - 1);
+
+    return std::sqrt(variance);
+}
+
+double
+histogram_t::value(double quantile) const {
+    if (quantile < 0.0 || quantile > 1.0 || std::isnan(quantile)) {
+        throw std::invalid_argument("quantile must be in [0; 1] range");
+    }
+
+    if (d.buckets.empty()) {
+        return 0.0;
+    }
+
+    // Rank of the requested value, starting from one.
+    const auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(quantile * d.count)));
+
+    std::uint64_t seen = 0;
+    for (const auto& bucket : d.buckets) {
+        seen += bucket.second;
+        if (seen >= rank) {
+            return bucket.first;
+        }
+    }
+
+    return d.buckets.back().first;
+}
+
+void
+histogram_t::merge(const histogram_t& other) {
+    std::vector<bucket_type> buckets;
+    buckets.reserve(d.buckets.size() + other.d.buckets.size());
+
+    auto lhs = d.buckets.begin();
+    auto rhs = other.d.buckets.begin();
+    while (lhs != d.buckets.end() && rhs != other.d.buckets.end()) {
+        if (lhs->first < rhs->first) {
+            buckets.push_back(*lhs++);
+        } else if (rhs->first < lhs->first) {
+            buckets.push_back(*rhs++);
+        } else {
+            buckets.emplace_back(lhs->first, lhs->second + rhs->second);
+            ++lhs;
+            ++rhs;
+        }
+    }
+
+    buckets.insert(buckets.end(), lhs, d.buckets.end());
+    buckets.insert(buckets.end(), rhs, other.d.buckets.end());
+
+    d.buckets = std::move(buckets);
+    d.count += other.d.count;
+    d.sum += other.d.sum;
+}
+
+}  // namespace snapshot
+}  // namespace accumulator
+}  // namespace metrics
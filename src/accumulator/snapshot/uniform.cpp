@@ -1,106 +1,204 @@
 #include "metrics/accumulator/snapshot/uniform.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <mutex>
 #include <stdexcept>
 
-#include <boost/range/numeric.hpp>
+#include "../../stats.hpp"
 
 namespace metrics {
 namespace accumulator {
 namespace snapshot {
 
+struct uniform_t::data_t {
+    /// Values, which are permuted in-place by selection until sorted, guarded by the mutex.
+    std::vector<value_type> values;
+    /// Whether the values are sorted, after which they are never modified again.
+    std::atomic<bool> sorted;
+    /// Sorted ranks, which values have already been selected, so that each rank partitions the
+    /// values into independent ranges.
+    std::vector<std::size_t> pivots;
+    std::mutex mutex;
+
+    /// Statistics, that are calculated in a single pass on construction, while the values are
+    /// still hot in the cache.
+    detail::moments_t moments;
+
+    data_t(std::vector<value_type> values, bool sorted) :
+        values(std::move(values)),
+        sorted(sorted),
+        moments(detail::moments(this->values.data(), this->values.size()))
+    {}
+
+    /// Returns the value with the given rank, i.e. the value that would be at the given position
+    /// if the values were sorted.
+    auto select(std::size_t rank) -> value_type {
+        if (sorted.load(std::memory_order_acquire)) {
+            return values[rank];
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        const auto it = std::lower_bound(pivots.begin(), pivots.end(), rank);
+        if (it != pivots.end() && *it == rank) {
+            return values[rank];
+        }
+
+        // Values between the neighbour pivots are the only ones, that may have the given rank.
+        const auto begin = it == pivots.begin() ? 0 : *(it - 1) + 1;
+        const auto end = it == pivots.end() ? values.size() : *it;
+
+        std::nth_element(values.begin() + begin, values.begin() + rank, values.begin() + end);
+        pivots.insert(it, rank);
+
+        return values[rank];
+    }
+
+    auto sort() -> const std::vector<value_type>& {
+        if (sorted.load(std::memory_order_acquire)) {
+            return values;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (!sorted.load(std::memory_order_relaxed)) {
+            std::sort(values.begin(), values.end());
+            pivots.clear();
+            sorted.store(true, std::memory_order_release);
+        }
+
+        return values;
+    }
+};
+
+namespace {
+
+auto check(double quantile) -> void {
+    if (quantile < 0.0 || quantile > 1.0 || std::isnan(quantile)) {
+        throw std::invalid_argument("quantile must be in [0; 1] range");
+    }
+}
+
+}  // namespace
+
 uniform_t::uniform_t(std::vector<value_type> values) {
-    std::sort(values.begin(), values.end());
+    d.data = std::make_shared<data_t>(std::move(values), false);
+    d.weight = 1;
+}
 
-    d.values = std::move(values);
+uniform_t::uniform_t(sorted_t, std::vector<value_type> values) {
+    d.data = std::make_shared<data_t>(std::move(values), true);
+    d.weight = 1;
+}
+
+uniform_t
+uniform_t::scaled(std::uint64_t weight) const {
+    uniform_t result(*this);
+    result.d.weight = weight;
+    return result;
 }
 
 const std::vector<uniform_t::value_type>&
-uniform_t::values() const noexcept {
-   return d.values;
+uniform_t::values() const {
+   return d.data->sort();
 }
 
 std::size_t
 uniform_t::size() const noexcept {
-    return d.values.size();
+    return d.data->values.size() * d.weight;
 }
 
 std::uint64_t
 uniform_t::min() const {
-    if (size() == 0) {
+    if (d.data->values.empty()) {
         return 0;
     }
 
-    return d.values.front();
+    return d.data->moments.min;
 }
 
 std::uint64_t
 uniform_t::max() const {
-    if (size() == 0) {
+    if (d.data->values.empty()) {
         return 0;
     }
 
-    return d.values.back();
+    return d.data->moments.max;
 }
 
 double
 uniform_t::mean() const {
-    const auto size = this->size();
-
-    if (size == 0) {
-        return 0;
-    }
-
-    return boost::accumulate(d.values, 0.0) / size;
+    return d.data->moments.mean();
 }
 
 double
 uniform_t::stddev() const {
-    const auto size = this->size();
+    // Weights are shared by all values, so they don't affect the variance.
+    const auto size = d.data->values.size();
 
     if (size <= 1) {
         return 0;
     }
 
-    const auto mean = this->mean();
-    const auto sum = boost::accumulate(d.values, 0.0, [&](double accumulator, double value) -> double {
-        const auto diff = value - mean;
-        return accumulator + diff * diff;
-    });
-
-    const auto variance = sum / (size - 1);
+    const auto variance = d.data->moments.m2 / (size - 1);
 
     return std::sqrt(variance);
 }
 
 double
 uniform_t::value(double quantile) const {
-    if (quantile < 0.0 || quantile > 1.0 || std::isnan(quantile)) {
-        throw std::invalid_argument("quantile must be in [0; 1] range");
-    }
+    check(quantile);
+
+    const auto size = d.data->values.size();
 
-    if (d.values.empty()) {
+    if (size == 0) {
         return 0.0;
     }
 
-    const auto pos = quantile * (d.values.size() + 1);
+    const auto pos = quantile * (size + 1);
     const auto id = static_cast<std::size_t>(pos);
 
     if (id < 1) {
-        return d.values.front();
+        return min();
     }
 
-    if (id >= d.values.size()) {
-        return d.values.back();
+    if (id >= size) {
+        return max();
     }
 
-    const auto lower = d.values[id - 1];
-    const auto upper = d.values[id];
+    const auto lower = d.data->select(id - 1);
+    const auto upper = d.data->select(id);
 
     return lower + (pos - std::floor(pos)) * (upper - lower);
 }
 
+std::vector<double>
+uniform_t::value(const std::vector<double>& quantiles) const {
+    for (auto quantile : quantiles) {
+        check(quantile);
+    }
+
+    // Selecting ranks in ascending order makes each selection partition only the values, that
+    // are greater than the previously selected one.
+    std::vector<std::size_t> order(quantiles.size());
+    for (std::size_t id = 0; id < order.size(); ++id) {
+        order[id] = id;
+    }
+
+    std::sort(order.begin(), order.end(), [&](std::size_t lhs, std::size_t rhs) {
+        return quantiles[lhs] < quantiles[rhs];
+    });
+
+    std::vector<double> result(quantiles.size());
+    for (auto id : order) {
+        result[id] = value(quantiles[id]);
+    }
+
+    return result;
+}
+
 }  // namespace snapshot
 }  // namespace accumulator
 }  // namespace metrics
@@ -6,6 +6,8 @@
 
 #include <boost/range/numeric.hpp>
 
+#include "../../stats.hpp"
+
 namespace metrics {
 namespace accumulator {
 namespace snapshot {
@@ -29,6 +31,10 @@ weighted_t::weighted_t(std::vector<sample_t> samples) {
     }
 
     boost::partial_sum(weights, std::back_inserter(quantiles), std::plus<double>());
+
+    const auto moments = detail::moments(data.data(), weights.data(), data.size());
+    stats.mean = moments.mean();
+    stats.stddev = moments.weight > 0.0 ? std::sqrt(moments.m2 / moments.weight) : 0.0;
 }
 
 auto weighted_t::size() const noexcept -> std::size_t {
@@ -101,33 +107,15 @@ auto weighted_t::max() const -> std::uint64_t {
 }
 
 auto weighted_t::mean() const -> double {
-    if (size() == 0) {
-        return 0;
-    }
-
-    double sum = 0.0;
-    for (std::size_t i = 0; i < size(); ++i) {
-        sum += data[i] * weights[i];
-    }
-
-    return sum;
+    return stats.mean;
 }
 
 auto weighted_t::stddev() const -> double {
-    const auto size = this->size();
-
-    if (size <= 1) {
+    if (size() <= 1) {
         return 0;
     }
 
-    double variance = 0.0;
-    const auto mean = this->mean();
-    for (std::size_t i = 0; i < data.size(); ++i) {
-        const auto diff = data[i] - mean;
-        variance += weights[i] * diff * diff;
-    }
-
-    return std::sqrt(variance);
+    return stats.stddev;
 }
 
 }  // namespace snapshot
@@ -0,0 +1,72 @@
+#include "metrics/clock.hpp"
+
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace metrics {
+
+namespace {
+
+/// Measures the number of nanoseconds per tick, spinning for the given time span.
+auto calibrate(std::chrono::steady_clock::duration span) -> double {
+    typedef std::chrono::steady_clock clock_type;
+
+    // Yield first, so that the measurement is less likely to be preempted.
+    std::this_thread::yield();
+
+    const auto begin = clock_type::now();
+    const auto first = tsc_clock_t::ticks();
+
+    auto end = begin;
+    while (end - begin < span) {
+        end = clock_type::now();
+    }
+
+    const auto last = tsc_clock_t::ticks();
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+
+    return static_cast<double>(elapsed) / static_cast<double>(last - first);
+}
+
+/// Returns the number of nanoseconds per tick, calibrating on the first call.
+auto ratio() noexcept -> double {
+    static const double result = calibrate(std::chrono::milliseconds(10));
+    return result;
+}
+
+/// Queries the CPU whether the counter is invariant.
+auto query_invariant() noexcept -> bool {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+
+    // Advanced power management leaf, which reports the invariant counter in the 8th bit.
+    if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) == 0) {
+        return false;
+    }
+
+    return (edx & (1u << 8)) != 0;
+#else
+    return true;
+#endif
+}
+
+}  // namespace
+
+auto tsc_clock_t::to_duration(std::uint64_t ticks) noexcept -> duration {
+    return duration(static_cast<rep>(static_cast<double>(ticks) * ratio()));
+}
+
+auto tsc_clock_t::calibrate() noexcept -> void {
+    ratio();
+}
+
+auto tsc_clock_t::invariant() noexcept -> bool {
+    // Querying the CPU may trap into the hypervisor, which is way too slow to repeat.
+    static const bool result = query_invariant();
+    return result;
+}
+
+}  // namespace metrics
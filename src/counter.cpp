@@ -0,0 +1,43 @@
+#include "counter.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace metrics {
+namespace detail {
+
+namespace {
+
+/// Upper bound for the number of cells, to keep the memory footprint of a single counter sane on
+/// machines with lots of cores.
+constexpr std::size_t max_cells = 256;
+
+auto ceil_pow2(std::size_t value) noexcept -> std::size_t {
+    std::size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+
+    return result;
+}
+
+}  // namespace
+
+striped_counter_t::striped_counter_t() :
+    striped_counter_t(std::thread::hardware_concurrency())
+{}
+
+striped_counter_t::striped_counter_t(std::size_t size) :
+    mask(ceil_pow2(std::min(std::max<std::size_t>(size, 1), max_cells)) - 1),
+    cells(new cell_t[mask + 1])
+{}
+
+auto striped_counter_t::thread_id() noexcept -> std::size_t {
+    static std::atomic<std::size_t> counter(0);
+    static thread_local const std::size_t id = counter.fetch_add(1, std::memory_order_relaxed);
+
+    return id;
+}
+
+}  // namespace detail
+}  // namespace metrics
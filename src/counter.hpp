@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include "metrics/counter.hpp"
+
+namespace metrics {
+namespace detail {
+
+/// A counter which spreads concurrent updates across several cache line padded cells, summing
+/// them on read.
+///
+/// Each thread is assigned a cell on its first update, so threads modifying the same counter
+/// almost never write into the same cache line. This makes updates scale with the number of
+/// cores, while reads become O(cells).
+///
+/// Each cell takes a whole cache line, i.e. 64 bytes, so by default a counter takes up to 16KB on
+/// machines with 256 cores or more. Pass a smaller number of cells for counters, that are
+/// either numerous or rarely updated concurrently.
+///
+/// \note it's the same approach as Java's `LongAdder` uses, but without dynamic cell expansion -
+///     the number of cells is fixed on construction.
+class striped_counter_t final : public metrics::counter_t {
+    /// Assumed size of the destructive interference range, i.e. the cache line size.
+    static constexpr std::size_t padding = 64;
+
+    struct cell_t {
+        std::atomic<value_type> value;
+        char pad[padding - sizeof(std::atomic<value_type>)];
+
+        cell_t() : value(0) {}
+    };
+
+    std::size_t mask;
+    std::unique_ptr<cell_t[]> cells;
+
+public:
+    /// Creates a new striped counter with the number of cells suitable for the current hardware
+    /// concurrency level.
+    striped_counter_t();
+
+    /// Creates a new striped counter with the number of cells equal to the given size rounded up
+    /// to the nearest power of two.
+    explicit striped_counter_t(std::size_t size);
+
+    /// Returns the number of cells.
+    auto size() const noexcept -> std::size_t {
+        return mask + 1;
+    }
+
+    /// Returns the sum of all cells.
+    auto get() const -> value_type override {
+        value_type result = 0;
+        for (std::size_t id = 0; id < size(); ++id) {
+            result += cells[id].value.load(std::memory_order_relaxed);
+        }
+
+        return result;
+    }
+
+    auto inc() -> void override {
+        add(1);
+    }
+
+    auto inc(value_type value) -> void override {
+        add(value);
+    }
+
+    auto dec() -> void override {
+        add(-1);
+    }
+
+    auto dec(value_type value) -> void override {
+        add(-value);
+    }
+
+    /// Adds the given value to the cell assigned to the calling thread.
+    auto add(value_type value) noexcept -> void {
+        cells[thread_id() & mask].value.fetch_add(value, std::memory_order_relaxed);
+    }
+
+private:
+    /// Returns a small integer unique for each thread, assigned on first call.
+    static auto thread_id() noexcept -> std::size_t;
+};
+
+}  // namespace detail
+}  // namespace metrics
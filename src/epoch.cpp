@@ -0,0 +1,165 @@
+#include "epoch.hpp"
+
+namespace metrics {
+namespace detail {
+
+namespace {
+
+/// Assumed size of the destructive interference range, i.e. the cache line size.
+constexpr std::size_t padding = 64;
+
+}  // namespace
+
+/// Thread record, padded from both sides to avoid false sharing with neighbour allocations,
+/// because it is written on every critical section entrance.
+struct epoch_t::record_t {
+    char head[padding];
+
+    /// Epoch observed by the owning thread on entering a critical section, zero if quiescent.
+    std::atomic<std::uint64_t> epoch;
+    /// Whether the record is owned by some alive thread.
+    std::atomic<bool> owned;
+    /// Critical section nesting level, accessed only by the owning thread.
+    std::size_t depth;
+    /// Next record in the list, immutable after publishing.
+    record_t* next;
+
+    char tail[padding];
+
+    record_t() :
+        epoch(0),
+        owned(true),
+        depth(0),
+        next(nullptr)
+    {}
+};
+
+epoch_t::guard_t::guard_t(epoch_t& domain) :
+    domain(domain),
+    record(domain.local())
+{
+    domain.enter(record);
+}
+
+epoch_t::guard_t::~guard_t() {
+    domain.leave(record);
+}
+
+epoch_t::epoch_t() :
+    epoch(1),
+    records(nullptr)
+{}
+
+auto epoch_t::instance() -> epoch_t& {
+    static epoch_t* domain = new epoch_t;
+    return *domain;
+}
+
+auto epoch_t::retire(std::function<void()> fn) -> void {
+    std::vector<std::function<void()>> ready;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        retired.emplace_back(epoch.load(), std::move(fn));
+
+        // Both advances succeed immediately if there are no readers, which allows to reclaim
+        // objects eagerly in the common case.
+        advance();
+        const auto current = advance();
+
+        auto it = retired.begin();
+        while (it != retired.end()) {
+            if (it->first + 2 <= current) {
+                ready.push_back(std::move(it->second));
+                it = retired.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    // Reclamation may call arbitrary destructors, so do it without holding the lock.
+    for (auto& fn : ready) {
+        fn();
+    }
+}
+
+auto epoch_t::enter(record_t* record) -> void {
+    if (record->depth++ != 0) {
+        return;
+    }
+
+    // Announce the observed epoch and check that it is still current. Sequentially consistent
+    // operations forbid reordering the load before the store, so once the check passes, writers
+    // are unable to advance the epoch twice without noticing us.
+    auto current = epoch.load();
+    while (true) {
+        record->epoch.store(current);
+
+        const auto actual = epoch.load();
+        if (actual == current) {
+            break;
+        }
+
+        current = actual;
+    }
+}
+
+auto epoch_t::leave(record_t* record) -> void {
+    if (--record->depth == 0) {
+        record->epoch.store(0, std::memory_order_release);
+    }
+}
+
+auto epoch_t::local() -> record_t* {
+    struct holder_t {
+        record_t* record;
+
+        explicit holder_t(epoch_t& domain) :
+            record(domain.acquire())
+        {}
+
+        ~holder_t() {
+            record->owned.store(false, std::memory_order_release);
+        }
+    };
+
+    static thread_local holder_t holder(*this);
+    return holder.record;
+}
+
+auto epoch_t::acquire() -> record_t* {
+    for (auto record = records.load(); record != nullptr; record = record->next) {
+        auto owned = false;
+        if (record->owned.compare_exchange_strong(owned, true)) {
+            return record;
+        }
+    }
+
+    auto record = new record_t;
+    record->next = records.load();
+    while (!records.compare_exchange_weak(record->next, record)) {
+    }
+
+    return record;
+}
+
+auto epoch_t::advance() -> std::uint64_t {
+    auto current = epoch.load();
+
+    for (auto record = records.load(); record != nullptr; record = record->next) {
+        const auto observed = record->epoch.load();
+        if (observed != 0 && observed != current) {
+            return current;
+        }
+    }
+
+    if (epoch.compare_exchange_strong(current, current + 1)) {
+        return current + 1;
+    }
+
+    return current;
+}
+
+}  // namespace detail
+}  // namespace metrics
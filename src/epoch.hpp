@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace metrics {
+namespace detail {
+
+/// Epoch-based memory reclamation domain.
+///
+/// Readers enter a critical section using `guard_t`, during which every object they can reach via
+/// shared atomic pointers is guaranteed to stay alive. Writers must unlink objects first and then
+/// retire them, which defers their destruction until all readers that could observe them have
+/// left their critical sections.
+///
+/// Entering and leaving a critical section touches only a thread-local cache line, so readers
+/// scale with the number of cores.
+class epoch_t {
+    struct record_t;
+
+    /// Current global epoch. Zero is reserved to mark quiescent threads.
+    std::atomic<std::uint64_t> epoch;
+    /// Intrusive push-only list of thread records.
+    std::atomic<record_t*> records;
+
+    std::mutex mutex;
+    std::vector<std::pair<std::uint64_t, std::function<void()>>> retired;
+
+public:
+    /// RAII reader critical section. Guards can be nested.
+    class guard_t {
+        epoch_t& domain;
+        record_t* record;
+
+    public:
+        explicit guard_t(epoch_t& domain);
+        guard_t(const guard_t& other) = delete;
+
+        ~guard_t();
+
+        auto operator=(const guard_t& other) -> guard_t& = delete;
+    };
+
+public:
+    epoch_t(const epoch_t& other) = delete;
+
+    auto operator=(const epoch_t& other) -> epoch_t& = delete;
+
+    /// Returns the process-wide reclamation domain.
+    ///
+    /// The domain is intentionally never destroyed, which allows to retire objects from static
+    /// destructors.
+    static auto instance() -> epoch_t&;
+
+    /// Schedules the given function to be called when no reader is able to observe an object that
+    /// has been unlinked before this call.
+    auto retire(std::function<void()> fn) -> void;
+
+    /// Schedules the given object to be deleted.
+    template<typename T>
+    auto retire(T* object) -> void {
+        retire([=] {
+            delete object;
+        });
+    }
+
+private:
+    epoch_t();
+
+    auto enter(record_t* record) -> void;
+    auto leave(record_t* record) -> void;
+
+    /// Returns the record associated with the calling thread, acquiring it on the first call.
+    auto local() -> record_t*;
+    auto acquire() -> record_t*;
+
+    /// Advances the global epoch if all active readers have observed the current one.
+    auto advance() -> std::uint64_t;
+};
+
+}  // namespace detail
+}  // namespace metrics
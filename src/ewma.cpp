@@ -22,19 +22,24 @@ ewma_t::ewma_t(double alpha, clock_type::duration interval) :
     d.rate.store(0.0);
 }
 
+auto
+ewma_t::tick_interval() -> clock_type::duration {
+    return std::chrono::seconds(5);
+}
+
 ewma_t
 ewma_t::m01rate() {
-    return {m01alpha, std::chrono::seconds(5)};
+    return {m01alpha, tick_interval()};
 }
 
 ewma_t
 ewma_t::m05rate() {
-    return {m05alpha, std::chrono::seconds(5)};
+    return {m05alpha, tick_interval()};
 }
 
 ewma_t
 ewma_t::m15rate() {
-    return {m15alpha, std::chrono::seconds(5)};
+    return {m15alpha, tick_interval()};
 }
 
 void
@@ -44,7 +49,11 @@ ewma_t::update(std::uint64_t value) {
 
 void
 ewma_t::tick() {
-    const auto count = std::atomic_exchange(&uncounted, std::uint64_t(0));
+    tick(std::atomic_exchange(&uncounted, std::uint64_t(0)));
+}
+
+void
+ewma_t::tick(std::uint64_t count) {
     const auto instant_rate = count / interval;
 
     if (initialized.test_and_set()) {
@@ -36,6 +36,9 @@ public:
     /// \todo not sure it's an ideal solution.
     ewma_t(const ewma_t& other);
 
+    /// Returns the tick interval, which predefined moving averages expect.
+    static auto tick_interval() -> clock_type::duration;
+
     /// Creates a new EWMA which is equivalent to the UNIX one minute load average and which
     /// expects to be ticked every 5 seconds.
     static ewma_t m01rate();
@@ -56,6 +59,11 @@ public:
     void
     tick();
 
+    /// Mark the passage of time, during which the given number of events occurred, bypassing
+    /// values accumulated using `update`, and decay the current rate accordingly.
+    void
+    tick(std::uint64_t count);
+
     /// Returns the rate in the given units of time.
     ///
     /// \type `T` the unit of time, must be `std::chrono::duration`.
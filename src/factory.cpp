@@ -1,13 +1,22 @@
 #include "metrics/factory.hpp"
 
 #include "metrics/accumulator/sliding/window.hpp"
+#include "metrics/accumulator/sketch/tdigest.hpp"
+#include "metrics/accumulator/sketch/ddsketch.hpp"
+#include "metrics/accumulator/sliding/time_window.hpp"
+#include "metrics/accumulator/hdr/histogram.hpp"
 
+#include "counter.hpp"
 #include "histogram.hpp"
 #include "meter.hpp"
 #include "timer.hpp"
 
 namespace metrics {
 
+auto factory_t::counter() const -> std::unique_ptr<counter_t> {
+    return std::unique_ptr<counter_t>(new detail::striped_counter_t);
+}
+
 auto factory_t::meter() const -> std::unique_ptr<meter_t> {
     return std::unique_ptr<meter_t>(new detail::meter_t);
 }
@@ -15,7 +24,7 @@ auto factory_t::meter() const -> std::unique_ptr<meter_t> {
 template<typename Accumulate>
 auto factory_t::timer() const -> std::unique_ptr<metrics::timer<Accumulate>> {
     typedef std::chrono::high_resolution_clock clock_type;
-    typedef detail::meter<clock_type> meter_type;
+    typedef detail::meter_t meter_type;
     typedef detail::histogram<Accumulate> histogram_type;
 
     return std::unique_ptr<metrics::timer<Accumulate>>(
@@ -28,4 +37,20 @@ template
 auto factory_t::timer<accumulator::sliding::window_t>() const ->
     std::unique_ptr<metrics::timer<accumulator::sliding::window_t>>;
 
+template
+auto factory_t::timer<accumulator::hdr::histogram_t>() const ->
+    std::unique_ptr<metrics::timer<accumulator::hdr::histogram_t>>;
+
+template
+auto factory_t::timer<accumulator::sliding::time_window_t>() const ->
+    std::unique_ptr<metrics::timer<accumulator::sliding::time_window_t>>;
+
+template
+auto factory_t::timer<accumulator::sketch::ddsketch_t>() const ->
+    std::unique_ptr<metrics::timer<accumulator::sketch::ddsketch_t>>;
+
+template
+auto factory_t::timer<accumulator::sketch::tdigest_t>() const ->
+    std::unique_ptr<metrics::timer<accumulator::sketch::tdigest_t>>;
+
 }  // namespace metrics
@@ -0,0 +1,65 @@
+#include "metrics/filter.hpp"
+
+#include <boost/optional/optional.hpp>
+#include <boost/utility/string_ref.hpp>
+
+#include "metrics/metric.hpp"
+#include "metrics/tags.hpp"
+
+namespace metrics {
+
+auto filter_t::eq(std::string key, std::string value) -> filter_t {
+    filter_t result;
+    result.d.push_back({clause_t::kind_t::eq, std::move(key), std::move(value)});
+    return result;
+}
+
+auto filter_t::prefix(std::string key, std::string prefix) -> filter_t {
+    filter_t result;
+    result.d.push_back({clause_t::kind_t::prefix, std::move(key), std::move(prefix)});
+    return result;
+}
+
+auto filter_t::operator&&(const filter_t& other) const -> filter_t {
+    filter_t result(*this);
+    result.d.insert(result.d.end(), other.d.begin(), other.d.end());
+    return result;
+}
+
+auto filter_t::empty() const noexcept -> bool {
+    return d.empty();
+}
+
+auto filter_t::clauses() const noexcept -> const std::vector<clause_t>& {
+    return d;
+}
+
+auto filter_t::match(const tags_t& tags) const -> bool {
+    for (const auto& clause : d) {
+        const auto value = tags.tag(clause.key);
+        if (!value) {
+            return false;
+        }
+
+        switch (clause.kind) {
+        case clause_t::kind_t::eq:
+            if (*value != clause.value) {
+                return false;
+            }
+            break;
+        case clause_t::kind_t::prefix:
+            if (!boost::string_ref(*value).starts_with(clause.value)) {
+                return false;
+            }
+            break;
+        }
+    }
+
+    return true;
+}
+
+auto filter_t::operator()(const tagged_t& metric) const -> bool {
+    return match(metric.tags());
+}
+
+} // namespace metrics
@@ -1,8 +1,28 @@
 #pragma once
 
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
 namespace metrics {
 namespace detail {
 
+/// Checks whether the accumulator is able to record a value with a weight using
+/// `update_n(value, count)`.
+template<class A>
+struct is_weighted {
+    template<class T>
+    static auto check(T* acc) ->
+        decltype(acc->update_n(std::uint64_t(), std::uint64_t()), std::true_type());
+
+    template<class T>
+    static auto check(...) -> std::false_type;
+
+    typedef decltype(check<A>(nullptr)) type;
+
+    static constexpr bool value = type::value;
+};
+
 /// A metric which calculates the distribution of a value.
 ///
 /// \type `A` must implement `Accumulate` concept.
@@ -60,6 +80,35 @@ public:
         d.count++;
         d.accumulator.update(value);
     }
+
+    /// Adds a recorded value, that stands for `count` values.
+    ///
+    /// Accumulators, that can't take weights, record the value once, while the count still
+    /// accounts all of them.
+    void
+    update_n(std::uint64_t value, std::uint64_t count) {
+        d.count += count;
+        update_n(value, count, typename is_weighted<accumulator_type>::type());
+    }
+
+    /// Adds recorded values at once, letting the accumulator amortize its synchronization over
+    /// the whole batch.
+    void
+    update(const std::uint64_t* values, std::size_t size) {
+        d.count += size;
+        d.accumulator.update(values, size);
+    }
+
+private:
+    void
+    update_n(std::uint64_t value, std::uint64_t count, std::true_type) {
+        d.accumulator.update_n(value, count);
+    }
+
+    void
+    update_n(std::uint64_t value, std::uint64_t, std::false_type) {
+        d.accumulator.update(value);
+    }
 };
 
 }  // namespace detail
@@ -0,0 +1,108 @@
+#include "index.hpp"
+
+#include <limits>
+
+#include <boost/utility/string_ref.hpp>
+
+namespace metrics {
+namespace detail {
+
+auto index_t::insert(const tags_t& tags) -> void {
+    for (const auto& tag : tags) {
+        keys[tag.first][tag.second].insert(tags);
+    }
+}
+
+auto index_t::erase(const tags_t& tags) -> void {
+    for (const auto& tag : tags) {
+        const auto key = keys.find(tag.first);
+        if (key == keys.end()) {
+            continue;
+        }
+
+        auto& values = key->second;
+        const auto value = values.find(tag.second);
+        if (value == values.end()) {
+            continue;
+        }
+
+        value->second.erase(tags);
+
+        // Drop empty lists to keep the index proportional to the number of alive metrics.
+        if (value->second.empty()) {
+            values.erase(value);
+            if (values.empty()) {
+                keys.erase(key);
+            }
+        }
+    }
+}
+
+auto index_t::select(const filter_t& filter) const -> std::vector<tags_t> {
+    std::vector<tags_t> result;
+
+    // Choose the most selective clause to collect candidates from, then check the rest.
+    const filter_t::clause_t* best = nullptr;
+    auto best_size = std::numeric_limits<std::size_t>::max();
+
+    for (const auto& clause : filter.clauses()) {
+        std::size_t size = 0;
+        postings(clause, [&](const postings_type& postings) {
+            size += postings.size();
+        });
+
+        if (size < best_size) {
+            best = &clause;
+            best_size = size;
+        }
+    }
+
+    if (best == nullptr || best_size == 0) {
+        return result;
+    }
+
+    result.reserve(best_size);
+    postings(*best, [&](const postings_type& postings) {
+        for (const auto& tags : postings) {
+            if (filter.match(tags)) {
+                result.push_back(tags);
+            }
+        }
+    });
+
+    return result;
+}
+
+template<typename F>
+auto index_t::postings(const filter_t::clause_t& clause, F fn) const -> void {
+    // Lookups are made by content, so there is no need to intern query strings.
+    const auto key = keys.find(&clause.key);
+    if (key == keys.end()) {
+        return;
+    }
+
+    const auto& values = key->second;
+
+    switch (clause.kind) {
+    case filter_t::clause_t::kind_t::eq: {
+        const auto value = values.find(&clause.value);
+        if (value != values.end()) {
+            fn(value->second);
+        }
+        break;
+    }
+    case filter_t::clause_t::kind_t::prefix:
+        // All values with the given prefix form a contiguous range starting from the prefix.
+        for (auto it = values.lower_bound(&clause.value); it != values.end(); ++it) {
+            if (!boost::string_ref(*it->first).starts_with(clause.value)) {
+                break;
+            }
+
+            fn(it->second);
+        }
+        break;
+    }
+}
+
+}  // namespace detail
+}  // namespace metrics
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "metrics/filter.hpp"
+#include "metrics/tags.hpp"
+
+namespace metrics {
+namespace detail {
+
+/// Inverted index from tag key and value to tags of metrics having such tag.
+///
+/// Allows to answer structured filters in time proportional to the size of the smallest posting
+/// list among the filter clauses instead of the total number of metrics.
+///
+/// Not synchronized: tables keep an index per shard, guarded by the shard mutex.
+class index_t {
+    /// Compares interned strings by content, which is required to answer prefix clauses.
+    struct less_t {
+        auto operator()(const std::string* lhs, const std::string* rhs) const -> bool {
+            return *lhs < *rhs;
+        }
+    };
+
+    typedef std::unordered_set<tags_t> postings_type;
+    typedef std::map<const std::string*, postings_type, less_t> values_type;
+
+    std::map<const std::string*, values_type, less_t> keys;
+
+public:
+    /// Indexes all tags of the given metric. Does nothing if the metric is already indexed.
+    auto insert(const tags_t& tags) -> void;
+
+    /// Removes all tags of the given metric from the index.
+    auto erase(const tags_t& tags) -> void;
+
+    /// Returns tags of all indexed metrics, that match the given non-empty filter.
+    auto select(const filter_t& filter) const -> std::vector<tags_t>;
+
+private:
+    /// Calls the given function for each posting list matching the given clause.
+    template<typename F>
+    auto postings(const filter_t::clause_t& clause, F fn) const -> void;
+};
+
+}  // namespace detail
+}  // namespace metrics
@@ -0,0 +1,108 @@
+#include "intern.hpp"
+
+#include <array>
+#include <mutex>
+
+#include <boost/unordered_map.hpp>
+
+#include "tags.hpp"
+
+namespace metrics {
+namespace detail {
+
+namespace {
+
+struct string_hash_t {
+    auto operator()(boost::string_ref value) const noexcept -> std::size_t {
+        return detail::hash(value);
+    }
+
+    auto operator()(const std::string& value) const noexcept -> std::size_t {
+        return detail::hash(value);
+    }
+};
+
+struct string_equal_t {
+    auto operator()(boost::string_ref lhs, const std::string& rhs) const noexcept -> bool {
+        return lhs == boost::string_ref(rhs);
+    }
+
+    auto operator()(const std::string& lhs, boost::string_ref rhs) const noexcept -> bool {
+        return boost::string_ref(lhs) == rhs;
+    }
+};
+
+/// Reference counted string pool, partitioned into shards to reduce contention between threads
+/// constructing tags concurrently.
+class pool_t {
+    static constexpr std::size_t shards_count = 16;
+
+    struct shard_t {
+        std::mutex mutex;
+        /// Strings mapped to the number of references, guarded by the mutex.
+        boost::unordered_map<std::string, std::size_t, string_hash_t> strings;
+    };
+
+    std::array<shard_t, shards_count> shards;
+
+public:
+    auto intern(boost::string_ref value) -> const std::string* {
+        auto& shard = shards[detail::hash(value) % shards_count];
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto it = shard.strings.find(value, string_hash_t(), string_equal_t());
+        if (it == shard.strings.end()) {
+            it = shard.strings.emplace(value.to_string(), 0).first;
+        }
+
+        ++it->second;
+
+        // Nodes of unordered containers are never relocated, so the address remains stable.
+        return &it->first;
+    }
+
+    auto release(const std::string* value) -> void {
+        auto& shard = shards[detail::hash(*value) % shards_count];
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        const auto it = shard.strings.find(*value);
+        if (--it->second == 0) {
+            shard.strings.erase(it);
+        }
+    }
+
+    auto size() -> std::size_t {
+        std::size_t result = 0;
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            result += shard.strings.size();
+        }
+
+        return result;
+    }
+};
+
+/// Leaked intentionally, because tags may outlive static objects.
+auto pool() -> pool_t& {
+    static pool_t* result = new pool_t;
+    return *result;
+}
+
+}  // namespace
+
+auto intern(boost::string_ref value) -> const std::string* {
+    return pool().intern(value);
+}
+
+auto release(const std::string* value) -> void {
+    pool().release(value);
+}
+
+auto interned() -> std::size_t {
+    return pool().size();
+}
+
+}  // namespace detail
+}  // namespace metrics
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include <boost/utility/string_ref.hpp>
+
+namespace metrics {
+namespace detail {
+
+/// Returns the canonical instance of the given string from the process-wide intern pool,
+/// inserting it if required, and acquires a reference to it.
+///
+/// Equal strings are mapped to the same address while referenced, which therefore can be used as
+/// an integer identifier of the string content. Each call must be paired with `release()`.
+auto intern(boost::string_ref value) -> const std::string*;
+
+/// Releases a reference to the given interned string, freeing it once no references are left.
+auto release(const std::string* value) -> void;
+
+/// Returns the number of distinct strings in the pool.
+auto interned() -> std::size_t;
+
+}  // namespace detail
+}  // namespace metrics
@@ -3,37 +3,82 @@
 #include <array>
 #include <chrono>
 #include <cmath>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
 
+#include "metrics/clock.hpp"
 #include "metrics/meter.hpp"
+#include "metrics/ticker.hpp"
 
+#include "counter.hpp"
 #include "ewma.hpp"
 
 namespace metrics {
 namespace detail {
 
+/// A meter, which counts events using a striped counter and derives moving average rates from
+/// the count increment on each tick, so marking an event touches a single mostly uncontended
+/// cell.
+///
+/// The counter has a small fixed number of cells, i.e. 256 bytes, regardless of the number of
+/// cores, because there may be hundreds of thousands of meters, while each of them is usually
+/// marked by a few threads only.
 template<class Clock>
 class meter : public metrics::meter_t {
     typedef Clock clock_type;
     typedef typename clock_type::time_point time_point;
 
+    /// The number of counter cells.
+    static constexpr std::size_t cells = 4;
+
     struct {
         clock_type clock;
-        std::atomic<std::uint64_t> count;
+        striped_counter_t count{cells};
     } d;
 
     time_point birthstamp;
     mutable std::atomic<std::int64_t> prev;
 
     mutable std::array<ewma_t, 3> rates;
+    /// The number of events at the last tick.
+    mutable std::atomic<std::uint64_t> ticked;
+
+    /// Ticker, which decays rates in background, if attached.
+    std::shared_ptr<ticker_t> ticker;
+    ticker_t::id_type subscription;
 
 public:
     /// Creates a new `meter`.
     meter() :
         birthstamp(d.clock.now()),
         prev(std::chrono::duration_cast<std::chrono::seconds>(birthstamp.time_since_epoch()).count()),
-        rates({{ewma_t::m01rate(), ewma_t::m05rate(), ewma_t::m15rate()}})
-    {
-        d.count = 0;
+        rates({{ewma_t::m01rate(), ewma_t::m05rate(), ewma_t::m15rate()}}),
+        ticked(0)
+    {}
+
+    ~meter() {
+        if (ticker) {
+            ticker->unsubscribe(subscription);
+        }
+    }
+
+    /// Attaches the meter to the given ticker, which will decay rates from now on, so neither
+    /// marking nor reading rates check the clock anymore.
+    ///
+    /// \throws std::invalid_argument if the ticker interval differs from the one moving averages
+    ///     expect, i.e. 5 seconds.
+    /// \warning must be called before the meter is shared with other threads.
+    auto attach(std::shared_ptr<ticker_t> ticker) -> void {
+        if (ticker->interval() != ewma_t::tick_interval()) {
+            throw std::invalid_argument("ticker interval must be equal to 5 seconds");
+        }
+
+        this->subscription = ticker->subscribe([this] {
+            tick();
+        });
+
+        this->ticker = std::move(ticker);
     }
 
     /// Dependency observers.
@@ -45,22 +90,12 @@ public:
 
     /// Returns the number of events which have been marked.
     auto count() const -> std::uint64_t {
-        return d.count;
+        return static_cast<std::uint64_t>(d.count.get());
     }
 
     /// Returns the mean rate at which events have occurred since the meter was created.
     auto mean_rate() const -> double {
-        const auto count = this->count();
-
-        if (count == 0) {
-            return 0.0;
-        }
-
-        const auto elapsed = std::chrono::duration_cast<
-            std::chrono::seconds
-        >(clock().now() - birthstamp).count();
-
-        return static_cast<double>(count) / elapsed;
+        return mean_rate(count(), clock().now());
     }
 
     /// Returns the one-minute exponentially-weighted moving average rate at which events have
@@ -84,6 +119,23 @@ public:
         return rates[2].template rate<std::chrono::seconds>();
     }
 
+    /// Returns all meter values at once, reading the clock only once.
+    auto summary() const -> summary_t {
+        const auto now = clock().now();
+        if (ticker == nullptr) {
+            tick_maybe(now);
+        }
+
+        summary_t result;
+        result.count = count();
+        result.mean_rate = mean_rate(result.count, now);
+        result.m01rate = rates[0].template rate<std::chrono::seconds>();
+        result.m05rate = rates[1].template rate<std::chrono::seconds>();
+        result.m15rate = rates[2].template rate<std::chrono::seconds>();
+
+        return result;
+    }
+
     auto mark() -> void {
         mark(1);
     }
@@ -92,18 +144,51 @@ public:
     auto mark(std::uint64_t value) -> void {
         tick_maybe();
 
-        d.count += value;
+        d.count.add(static_cast<striped_counter_t::value_type>(value));
+    }
+
+private:
+    auto mean_rate(std::uint64_t count, time_point now) const -> double {
+        if (count == 0) {
+            return 0.0;
+        }
+
+        const auto elapsed = std::chrono::duration_cast<
+            std::chrono::seconds
+        >(now - birthstamp).count();
+
+        return static_cast<double>(count) / elapsed;
+    }
+
+    /// Feeds events marked since the last tick into all moving averages.
+    auto tick() const -> void {
+        const auto count = this->count();
+
+        // Concurrent ticks may observe counts out of order, so the last tick count must never go
+        // backwards, otherwise events would be counted twice.
+        auto last = ticked.load();
+        do {
+            if (count <= last) {
+                last = count;
+                break;
+            }
+        } while (!ticked.compare_exchange_weak(last, count));
 
         for (auto& rate : rates) {
-            rate.update(value);
+            rate.tick(count - last);
         }
     }
 
-private:
     auto tick_maybe() const -> void {
+        if (ticker == nullptr) {
+            tick_maybe(clock().now());
+        }
+    }
+
+    auto tick_maybe(time_point timestamp) const -> void {
         const auto now = std::chrono::duration_cast<
             std::chrono::seconds
-        >(clock().now().time_since_epoch()).count();
+        >(timestamp.time_since_epoch()).count();
         auto prev = this->prev.load();
         const auto elapsed = now - prev;
 
@@ -113,16 +198,14 @@ private:
                 const auto ticks = elapsed / 5;
 
                 for (auto i = 0; i < ticks; ++i) {
-                    for (auto& rate : rates) {
-                        rate.tick();
-                    }
+                    tick();
                 }
             }
         }
     }
 };
 
-typedef meter<std::chrono::high_resolution_clock> meter_t;
+typedef meter<coarse_clock_t> meter_t;
 
 }  // namespace detail
 }  // namespace metrics
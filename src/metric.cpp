@@ -6,6 +6,11 @@
 
 #include "metrics/accumulator/sliding/window.hpp"
 #include "metrics/accumulator/decaying/exponentially.hpp"
+#include "metrics/accumulator/sketch/tdigest.hpp"
+#include "metrics/accumulator/sketch/ddsketch.hpp"
+#include "metrics/accumulator/sliding/time_window.hpp"
+#include "metrics/accumulator/hdr/histogram.hpp"
+#include "metrics/counter.hpp"
 #include "metrics/gauge.hpp"
 #include "metrics/meter.hpp"
 #include "metrics/timer.hpp"
@@ -64,8 +69,19 @@ template class shared_metric<gauge<std::double_t>>;
 template class shared_metric<gauge<std::string>>;
 template class shared_metric<std::atomic<std::int64_t>>;
 template class shared_metric<std::atomic<std::uint64_t>>;
+template class shared_metric<counter_t>;
 template class shared_metric<meter_t>;
 template class shared_metric<timer<accumulator::sliding::window_t>>;
 template class shared_metric<timer<accumulator::decaying::exponentially_t>>;
+template class shared_metric<timer<accumulator::sketch::tdigest_t>>;
+template class shared_metric<timer<accumulator::sketch::ddsketch_t>>;
+template class shared_metric<timer<accumulator::sliding::time_window_t>>;
+template class shared_metric<timer<accumulator::hdr::histogram_t>>;
+template class shared_metric<static_timer<accumulator::sliding::window_t>>;
+template class shared_metric<static_timer<accumulator::decaying::exponentially_t>>;
+template class shared_metric<static_timer<accumulator::sketch::tdigest_t>>;
+template class shared_metric<static_timer<accumulator::sketch::ddsketch_t>>;
+template class shared_metric<static_timer<accumulator::sliding::time_window_t>>;
+template class shared_metric<static_timer<accumulator::hdr::histogram_t>>;
 
 }  // namespace metrics
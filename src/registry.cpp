@@ -1,5 +1,9 @@
 #include "metrics/registry.hpp"
 
+#include <array>
+#include <stdexcept>
+
+#include <boost/optional/optional.hpp>
 #include <boost/range/algorithm/transform.hpp>
 
 #include "metrics/counter.hpp"
@@ -8,6 +12,7 @@
 #include "metrics/metric.hpp"
 
 #include "registry.hpp"
+#include "tags.hpp"
 
 namespace metrics {
 
@@ -27,25 +32,74 @@ struct transformer_t {
     }
 };
 
-template<typename R, typename T, typename M>
+/// Visits metrics matching the given generic predicate, which requires to check all of them.
+template<typename Table, typename F>
+auto
+for_each(const Table& table, const query_t&, F fn) -> void {
+    table.for_each(std::move(fn));
+}
+
+/// Visits metrics matching the given filter only, using the tag index.
+template<typename Table, typename F>
+auto
+for_each(const Table& table, const filter_t& filter, F fn) -> void {
+    table.for_each(filter, std::move(fn));
+}
+
+auto
+accept(const query_t& query, const tagged_t& metric) -> bool {
+    return query(metric);
+}
+
+auto
+accept(const filter_t&, const tagged_t&) -> bool {
+    // Already matched by the index.
+    return true;
+}
+
+template<typename Q>
 auto
-instances(const query_t& query, M& map) -> registry_t::metric_set<R> {
+select_all(const registry_t& registry, const Q& query) ->
+    std::vector<std::shared_ptr<tagged_t>>
+{
+    std::vector<std::shared_ptr<tagged_t>> result;
+    auto fn = transformer_t();
+    auto out = std::back_inserter(result);
+
+    boost::transform(registry.gauges<std::int64_t>(query), out, fn);
+    boost::transform(registry.gauges<std::uint64_t>(query), out, fn);
+    boost::transform(registry.gauges<std::double_t>(query), out, fn);
+    boost::transform(registry.gauges<std::string>(query), out, fn);
+
+    boost::transform(registry.counters<std::int64_t>(query), out, fn);
+    boost::transform(registry.counters<std::uint64_t>(query), out, fn);
+    boost::transform(registry.striped_counters(query), out, fn);
+
+    boost::transform(registry.meters(query), out, fn);
+
+    boost::transform(registry.timers<accumulator::sliding::window_t>(query), out, fn);
+    boost::transform(registry.timers<accumulator::decaying::exponentially_t>(query), out, fn);
+    boost::transform(registry.timers<accumulator::sketch::tdigest_t>(query), out, fn);
+    boost::transform(registry.timers<accumulator::sketch::ddsketch_t>(query), out, fn);
+    boost::transform(registry.timers<accumulator::sliding::time_window_t>(query), out, fn);
+    boost::transform(registry.timers<accumulator::hdr::histogram_t>(query), out, fn);
+
+    return result;
+}
+
+template<typename R, typename T, typename M, typename Q>
+auto
+instances(const Q& query, M& map) -> registry_t::metric_set<R> {
     typedef shared_metric<R> value_type;
 
     registry_t::metric_set<R> result;
 
-    std::lock_guard<std::mutex> lock(map.mutex);
-    const auto& instances = map.template get<T>();
-
-    for (const auto& it : instances) {
-        if (auto metric = std::get<1>(it).lock()) {
-            const auto& tags = std::get<0>(it);
-            auto shared = value_type(tags, metric);
-            if (query(shared) && metric) {
-                result.insert(std::make_pair(tags, std::move(shared)));
-            }
+    for_each(map.template get<T>(), query, [&](const tags_t& tags, std::shared_ptr<R> metric) {
+        auto shared = value_type(tags, std::move(metric));
+        if (accept(query, shared)) {
+            result.insert(std::make_pair(tags, std::move(shared)));
         }
-    }
+    });
 
     return result;
 }
@@ -67,6 +121,13 @@ struct type_traits<std::atomic<T>> {
     }
 };
 
+template<>
+struct type_traits<counter_t> {
+    static auto type_name() noexcept -> const char* {
+        return "counter";
+    }
+};
+
 template<>
 struct type_traits<meter_t> {
     static auto type_name() noexcept -> const char* {
@@ -81,13 +142,118 @@ struct type_traits<timer<T>> {
     }
 };
 
+/// Heterogeneous lookup key, that combines borrowed tags with the implicit metric type tag.
+struct lookup_t {
+    const tags_view_t& tags;
+    std::size_t hash;
+
+    lookup_t(const tags_view_t& tags, const char* type) :
+        tags(tags),
+        hash(tags.hash() + detail::hash("type", type))
+    {}
+};
+
+/// Looks up an existing metric by borrowed tags, without allocations and locking.
+template<typename R, typename T, typename M>
+auto
+find(M& map, const tags_view_t& tags) -> boost::optional<shared_metric<R>> {
+    const lookup_t key(tags, type_traits<R>::type_name());
+
+    // All metrics within a single table share the same type tag, which is already accounted by the
+    // hash value, so we only need to check that there are no other tags.
+    const auto eq = [&](const tags_t& other) -> bool {
+        return detail::equal(key.tags, other, 1);
+    };
+
+    detail::epoch_t::guard_t guard(detail::epoch_t::instance());
+
+    if (auto node = map.template get<T>().find(key.hash, eq)) {
+        if (auto instance = node->instance.lock()) {
+            return shared_metric<R>(node->tags, std::move(instance));
+        }
+    }
+
+    return boost::none;
+}
+
+/// Looks up an existing metric by owned tags, without constructing `tags_t`, which requires
+/// interning all strings.
+///
+/// Only small tag sets are supported, returning nothing for larger ones.
+template<typename R, typename T, typename M>
+auto
+find(M& map, const std::string& name, const tags_t::container_type& tags) ->
+    boost::optional<shared_metric<R>>
+{
+    std::array<tags_view_t::value_type, 8> view;
+    if (tags.size() > view.size()) {
+        return boost::none;
+    }
+
+    std::size_t size = 0;
+    for (const auto& tag : tags) {
+        view[size++] = tags_view_t::value_type(tag.first, tag.second);
+    }
+
+    return find<R, T>(map, tags_view_t(name, view.data(), size));
+}
+
+struct stats_visitor_t {
+    registry_t::stats_t& result;
+
+    template<typename T>
+    auto operator()(const detail::table<T>& table) const -> void {
+        result.size += table.size();
+        result.expired += table.expired();
+    }
+};
+
+/// Converts borrowed tags into owned ones, which is required to create a new metric.
+auto
+to_container(const tags_view_t& tags) -> tags_t::container_type {
+    tags_t::container_type result;
+    for (const auto& tag : tags) {
+        result.insert(std::make_pair(tag.first.to_string(), tag.second.to_string()));
+    }
+
+    return result;
+}
+
+/// Checks that the given timer samples contexts at the requested rate, because returning an
+/// existing timer with another one would silently ignore the request.
+///
+/// \throws std::invalid_argument if sampling rates differ.
+template<class Accumulate>
+auto
+check_rate(const metrics::timer<Accumulate>& timer, std::uint32_t every) -> void {
+    typedef typename tag::timer<Accumulate>::type timer_type;
+
+    // All timers are registered with the same concrete type, regardless of their clock.
+    const auto& actual = static_cast<const timer_type&>(timer).sampler();
+    if (actual.every() != sampler_t(every).every()) {
+        throw std::invalid_argument("timer already exists with another sampling rate");
+    }
+}
+
 } // namespace
 
 registry_t::registry_t():
-    inner(new inner_t)
+    inner(new inner_t(nullptr))
 {}
 
-registry_t::~registry_t() = default;
+registry_t::registry_t(std::shared_ptr<ticker_t> ticker):
+    inner(new inner_t(std::move(ticker)))
+{
+    // Check eagerly rather than on the first meter creation.
+    if (inner->ticker && inner->ticker->interval() != detail::ewma_t::tick_interval()) {
+        throw std::invalid_argument("ticker interval must be equal to 5 seconds");
+    }
+}
+
+registry_t::~registry_t() {
+    // Invalidate all handles, which still refer to metrics of this registry.
+    inner->generation->advance();
+}
 
 template<typename R>
 auto
@@ -97,15 +263,11 @@ registry_t::register_gauge(std::string name, tags_t::container_type other, std::
     other["type"] = type_traits<metrics::gauge<R>>::type_name();
     tags_t tags(std::move(name), std::move(other));
 
-    std::lock_guard<std::mutex> lock(inner->gauges.mutex);
-    auto& instances = inner->gauges.template get<R>();
+    auto instance = inner->gauges.template get<R>().get_or_insert(tags, [&] {
+        return std::make_shared<metrics::gauge<R>>(std::move(fn));
+    });
 
-    std::shared_ptr<metrics::gauge<R>> instance;
-    if((instance = instances[tags].lock()) == nullptr) {
-        instance = std::make_shared<metrics::gauge<R>>(std::move(fn));
-        instances[tags] = instance;
-    }
-    return {tags, instance};
+    return {std::move(tags), std::move(instance)};
 }
 
 template<typename T>
@@ -116,13 +278,23 @@ registry_t::gauge(std::string name, tags_t::container_type other) const ->
     other["type"] = type_traits<metrics::gauge<T>>::type_name();
     tags_t tags(std::move(name), std::move(other));
 
-    std::lock_guard<std::mutex> lock(inner->gauges.mutex);
-    const auto& instances = inner->gauges.template get<T>();
-    std::shared_ptr<metrics::gauge<T>> instance;
-    if((instance = instances.at(tags).lock()) == nullptr) {
-        throw std::invalid_argument(name);
+    const auto eq = [&](const tags_t& other) -> bool {
+        return other == tags;
+    };
+
+    detail::epoch_t::guard_t guard(detail::epoch_t::instance());
+
+    const auto node = inner->gauges.template get<T>().find(tags.hash(), eq);
+    if (node == nullptr) {
+        throw std::out_of_range(tags.name());
+    }
+
+    auto instance = node->instance.lock();
+    if (instance == nullptr) {
+        throw std::invalid_argument(tags.name());
     }
-    return {tags, instance};
+
+    return {std::move(tags), std::move(instance)};
 }
 
 template<typename T>
@@ -137,24 +309,39 @@ registry_t::gauges(const query_t& query) const -> metric_set<metrics::gauge<T>>
     return instances<metrics::gauge<T>, T>(query, inner->gauges);
 }
 
+template<typename T>
+auto
+registry_t::gauges(const filter_t& filter) const -> metric_set<metrics::gauge<T>> {
+    return instances<metrics::gauge<T>, T>(filter, inner->gauges);
+}
+
 template<typename T>
 auto
 registry_t::counter(std::string name, tags_t::container_type other) const ->
     shared_metric<std::atomic<T>>
 {
+    if (auto metric = find<std::atomic<T>, T>(inner->counters, name, other)) {
+        return std::move(*metric);
+    }
+
     other["type"] = type_traits<std::atomic<T>>::type_name();
     tags_t tags(std::move(name), std::move(other));
 
-    std::lock_guard<std::mutex> lock(inner->counters.mutex);
-    auto& instances = inner->counters.template get<T>();
+    auto instance = inner->counters.template get<T>().get_or_insert(tags, [] {
+        return std::make_shared<std::atomic<T>>();
+    });
+
+    return {std::move(tags), std::move(instance)};
+}
 
-    std::shared_ptr<std::atomic<T>> instance;
-    if((instance = instances[tags].lock()) == nullptr) {
-        instance = std::make_shared<std::atomic<T>>();
-        instances[tags] = instance;
+template<typename T>
+auto
+registry_t::counter(const tags_view_t& tags) const -> shared_metric<std::atomic<T>> {
+    if (auto metric = find<std::atomic<T>, T>(inner->counters, tags)) {
+        return std::move(*metric);
     }
 
-    return {std::move(tags), std::move(instance)};
+    return counter<T>(tags.name().to_string(), to_container(tags));
 }
 
 template<typename T>
@@ -169,25 +356,86 @@ registry_t::counters(const query_t& query) const -> metric_set<std::atomic<T>> {
     return instances<std::atomic<T>, T>(query, inner->counters);
 }
 
+template<typename T>
+auto
+registry_t::counters(const filter_t& filter) const -> metric_set<std::atomic<T>> {
+    return instances<std::atomic<T>, T>(filter, inner->counters);
+}
+
+auto
+registry_t::striped_counter(std::string name, tags_t::container_type other) const ->
+    shared_metric<counter_t>
+{
+    if (auto metric = find<counter_t, detail::striped_counter_t>(inner->counters, name, other)) {
+        return std::move(*metric);
+    }
+
+    other["type"] = type_traits<counter_t>::type_name();
+    tags_t tags(std::move(name), std::move(other));
+
+    auto instance = inner->counters.get<detail::striped_counter_t>().get_or_insert(tags, [] {
+        return std::make_shared<detail::striped_counter_t>();
+    });
+
+    return {std::move(tags), std::move(instance)};
+}
+
+auto
+registry_t::striped_counter(const tags_view_t& tags) const -> shared_metric<counter_t> {
+    if (auto metric = find<counter_t, detail::striped_counter_t>(inner->counters, tags)) {
+        return std::move(*metric);
+    }
+
+    return striped_counter(tags.name().to_string(), to_container(tags));
+}
+
+auto
+registry_t::striped_counters() const -> metric_set<counter_t> {
+    return striped_counters(query_all);
+}
+
+auto
+registry_t::striped_counters(const query_t& query) const -> metric_set<counter_t> {
+    return instances<counter_t, detail::striped_counter_t>(query, inner->counters);
+}
+
+auto
+registry_t::striped_counters(const filter_t& filter) const -> metric_set<counter_t> {
+    return instances<counter_t, detail::striped_counter_t>(filter, inner->counters);
+}
+
 auto
 registry_t::meter(std::string name, tags_t::container_type other) const ->
     shared_metric<meter_t>
 {
+    if (auto metric = find<meter_t, detail::meter_t>(inner->meters, name, other)) {
+        return std::move(*metric);
+    }
+
     other["type"] = type_traits<meter_t>::type_name();
     tags_t tags(std::move(name), std::move(other));
 
-    std::lock_guard<std::mutex> lock(inner->meters.mutex);
-    auto& instances = inner->meters.get<detail::meter_t>();
+    auto instance = inner->meters.get<detail::meter_t>().get_or_insert(tags, [&] {
+        auto result = std::make_shared<detail::meter_t>();
+        if (inner->ticker) {
+            result->attach(inner->ticker);
+        }
 
-    std::shared_ptr<detail::meter_t> instance;
-    if((instance = instances[tags].lock()) == nullptr) {
-        instance = std::make_shared<detail::meter_t>();
-        instances[tags] = instance;
-    }
+        return result;
+    });
 
     return {std::move(tags), std::move(instance)};
 }
 
+auto
+registry_t::meter(const tags_view_t& tags) const -> shared_metric<meter_t> {
+    if (auto metric = find<meter_t, detail::meter_t>(inner->meters, tags)) {
+        return std::move(*metric);
+    }
+
+    return meter(tags.name().to_string(), to_container(tags));
+}
+
 auto
 registry_t::meters() const -> metric_set<meter_t> {
     return meters(query_all);
@@ -198,32 +446,112 @@ registry_t::meters(const query_t& query) const -> metric_set<meter_t> {
     return instances<meter_t, detail::meter_t>(query, inner->meters);
 }
 
+auto
+registry_t::meters(const filter_t& filter) const -> metric_set<meter_t> {
+    return instances<meter_t, detail::meter_t>(filter, inner->meters);
+}
+
 template<class Accumulate>
 auto registry_t::timer(std::string name, tags_t::container_type other) const ->
     shared_metric<metrics::timer<Accumulate>>
 {
-    typedef std::chrono::high_resolution_clock clock_type;
-    typedef detail::timer<
-        clock_type,
-        detail::meter<clock_type>,
-        detail::histogram<Accumulate>
-    > result_type;
+    if (auto metric = find<metrics::timer<Accumulate>, Accumulate>(inner->timers, name, other)) {
+        return std::move(*metric);
+    }
+
+    return timer<Accumulate>(std::move(name), std::move(other), 1);
+}
+
+template<class Accumulate>
+auto registry_t::timer(std::string name, tags_t::container_type other, std::uint32_t every) const ->
+    shared_metric<metrics::timer<Accumulate>>
+{
+    typedef typename tag::timer<Accumulate>::type result_type;
+
+    if (auto metric = find<metrics::timer<Accumulate>, Accumulate>(inner->timers, name, other)) {
+        check_rate(*metric->get(), every);
+        return std::move(*metric);
+    }
 
     other["type"] = type_traits<metrics::timer<Accumulate>>::type_name();
     tags_t tags(std::move(name), std::move(other));
 
-    std::lock_guard<std::mutex> lock(inner->timers.mutex);
-    auto& instances = inner->timers.template get<Accumulate>();
+    auto instance = inner->timers.template get<Accumulate>().get_or_insert(tags, [&] {
+        auto result = std::make_shared<result_type>(every);
+        if (inner->ticker) {
+            result->attach(inner->ticker);
+        }
+
+        return result;
+    });
+
+    // Some other thread may have registered the timer in the meantime.
+    check_rate(*instance, every);
 
-    std::shared_ptr<result_type> instance;
-    if((instance = instances[tags].lock()) == nullptr) {
-        instance = std::make_shared<result_type>();
-        instances[tags] = instance;
+    return {std::move(tags), std::move(instance)};
+}
+
+template<class Accumulate>
+auto registry_t::tsc_timer(std::string name, tags_t::container_type other) const ->
+    shared_metric<metrics::timer<Accumulate>>
+{
+    if (auto metric = find<metrics::timer<Accumulate>, Accumulate>(inner->timers, name, other)) {
+        return std::move(*metric);
     }
 
+    return tsc_timer<Accumulate>(std::move(name), std::move(other), 1);
+}
+
+template<class Accumulate>
+auto registry_t::tsc_timer(std::string name, tags_t::container_type other, std::uint32_t every) const ->
+    shared_metric<metrics::timer<Accumulate>>
+{
+    typedef typename tag::timer<Accumulate>::type result_type;
+
+    if (auto metric = find<metrics::timer<Accumulate>, Accumulate>(inner->timers, name, other)) {
+        check_rate(*metric->get(), every);
+        return std::move(*metric);
+    }
+
+    other["type"] = type_traits<metrics::timer<Accumulate>>::type_name();
+    tags_t tags(std::move(name), std::move(other));
+
+    auto instance = inner->timers.template get<Accumulate>().get_or_insert(tags, [&] {
+        auto result = std::make_shared<result_type>(every, true);
+        if (inner->ticker) {
+            result->attach(inner->ticker);
+        }
+
+        return result;
+    });
+
+    check_rate(*instance, every);
+
     return {std::move(tags), std::move(instance)};
 }
 
+template<class Accumulate>
+auto registry_t::static_timer(std::string name, tags_t::container_type other, std::uint32_t every) const ->
+    shared_metric<metrics::static_timer<Accumulate>>
+{
+    typedef typename tag::timer<Accumulate>::type result_type;
+
+    auto metric = timer<Accumulate>(std::move(name), std::move(other), every);
+
+    // All timers are registered with the same concrete type, regardless of their clock.
+    return {metric.tags(), std::static_pointer_cast<result_type>(metric.get())};
+}
+
+template<class Accumulate>
+auto
+registry_t::timer(const tags_view_t& tags) const -> shared_metric<metrics::timer<Accumulate>> {
+    if (auto metric = find<metrics::timer<Accumulate>, Accumulate>(inner->timers, tags)) {
+        return std::move(*metric);
+    }
+
+    return timer<Accumulate>(tags.name().to_string(), to_container(tags));
+}
+
 template<class Accumulate>
 auto
 registry_t::timers() const -> metric_set<metrics::timer<Accumulate>> {
@@ -236,6 +564,12 @@ registry_t::timers(const query_t& query) const -> metric_set<metrics::timer<Accu
     return instances<metrics::timer<Accumulate>, Accumulate>(query, inner->timers);
 }
 
+template<class Accumulate>
+auto
+registry_t::timers(const filter_t& filter) const -> metric_set<metrics::timer<Accumulate>> {
+    return instances<metrics::timer<Accumulate>, Accumulate>(filter, inner->timers);
+}
+
 auto
 registry_t::select() const -> std::vector<std::shared_ptr<tagged_t>> {
     return select(query_all);
@@ -245,24 +579,14 @@ auto
 registry_t::select(const query_t& query) const ->
     std::vector<std::shared_ptr<tagged_t>>
 {
-    std::vector<std::shared_ptr<tagged_t>> result;
-    auto fn = transformer_t();
-    auto out = std::back_inserter(result);
-
-    boost::transform(gauges<std::int64_t>(query), out, fn);
-    boost::transform(gauges<std::uint64_t>(query), out, fn);
-    boost::transform(gauges<std::double_t>(query), out, fn);
-    boost::transform(gauges<std::string>(query), out, fn);
-
-    boost::transform(counters<std::int64_t>(query), out, fn);
-    boost::transform(counters<std::uint64_t>(query), out, fn);
-
-    boost::transform(meters(query), out, fn);
-
-    boost::transform(timers<accumulator::sliding::window_t>(query), out, fn);
-    boost::transform(timers<accumulator::decaying::exponentially_t>(query), out, fn);
+    return select_all(*this, query);
+}
 
-    return result;
+auto
+registry_t::select(const filter_t& filter) const ->
+    std::vector<std::shared_ptr<tagged_t>>
+{
+    return select_all(*this, filter);
 }
 
 template<typename T>
@@ -278,7 +602,6 @@ struct remove_metric<metrics::gauge<T>> {
         other["type"] = type_traits<metrics::gauge<T>>::type_name();
         tags_t tags(std::move(name), std::move(other));
 
-        std::lock_guard<std::mutex> lock(d->gauges.mutex);
         return d->gauges.template get<T>().erase(tags);
     }
 };
@@ -290,11 +613,21 @@ struct remove_metric<std::atomic<T>> {
         other["type"] = type_traits<std::atomic<T>>::type_name();
         tags_t tags(std::move(name), std::move(other));
 
-        std::lock_guard<std::mutex> lock(d->counters.mutex);
         return d->counters.template get<T>().erase(tags);
     }
 };
 
+template<>
+struct remove_metric<counter_t> {
+    template<typename D>
+    static auto apply(D& d, const std::string& name, tags_t::container_type other) -> bool {
+        other["type"] = type_traits<counter_t>::type_name();
+        tags_t tags(std::move(name), std::move(other));
+
+        return d->counters.template get<detail::striped_counter_t>().erase(tags);
+    }
+};
+
 template<>
 struct remove_metric<meter_t> {
     template<typename D>
@@ -302,7 +635,6 @@ struct remove_metric<meter_t> {
         other["type"] = type_traits<meter_t>::type_name();
         tags_t tags(std::move(name), std::move(other));
 
-        std::lock_guard<std::mutex> lock(d->meters.mutex);
         return d->meters.template get<detail::meter_t>().erase(tags);
     }
 };
@@ -314,7 +646,6 @@ struct remove_metric<timer<Accumulate>> {
         other["type"] = type_traits<metrics::timer<Accumulate>>::type_name();
         tags_t tags(std::move(name), std::move(other));
 
-        std::lock_guard<std::mutex> lock(d->timers.mutex);
         return d->timers.template get<Accumulate>().erase(tags);
     }
 };
@@ -322,7 +653,35 @@ struct remove_metric<timer<Accumulate>> {
 template<typename T>
 auto
 registry_t::remove(const std::string& name, const tags_t::container_type& tags) -> bool {
-    return remove_metric<T>::apply(inner, name, tags);
+    if (remove_metric<T>::apply(inner, name, tags)) {
+        inner->generation->advance();
+        return true;
+    }
+
+    return false;
+}
+
+auto
+registry_t::stats() const -> stats_t {
+    stats_t result{0, 0};
+    const stats_visitor_t fn{result};
+
+    inner->gauges.each(fn);
+    inner->counters.each(fn);
+    inner->meters.each(fn);
+    inner->timers.each(fn);
+
+    return result;
+}
+
+auto
+registry_t::generation() const noexcept -> const generation_t& {
+    return *inner->generation;
+}
+
+auto
+registry_t::shared_generation() const -> std::shared_ptr<const generation_t> {
+    return inner->generation;
 }
 
 /// Instantiations.
@@ -375,6 +734,38 @@ template
 auto registry_t::gauges<std::string>() const ->
     std::map<tags_t, shared_metric<metrics::gauge<std::string>>>;
 
+template
+auto registry_t::gauges<std::int64_t>(const query_t&) const ->
+    std::map<tags_t, shared_metric<metrics::gauge<std::int64_t>>>;
+
+template
+auto registry_t::gauges<std::int64_t>(const filter_t&) const ->
+    std::map<tags_t, shared_metric<metrics::gauge<std::int64_t>>>;
+
+template
+auto registry_t::gauges<std::uint64_t>(const query_t&) const ->
+    std::map<tags_t, shared_metric<metrics::gauge<std::uint64_t>>>;
+
+template
+auto registry_t::gauges<std::uint64_t>(const filter_t&) const ->
+    std::map<tags_t, shared_metric<metrics::gauge<std::uint64_t>>>;
+
+template
+auto registry_t::gauges<double>(const query_t&) const ->
+    std::map<tags_t, shared_metric<metrics::gauge<double>>>;
+
+template
+auto registry_t::gauges<double>(const filter_t&) const ->
+    std::map<tags_t, shared_metric<metrics::gauge<double>>>;
+
+template
+auto registry_t::gauges<std::string>(const query_t&) const ->
+    std::map<tags_t, shared_metric<metrics::gauge<std::string>>>;
+
+template
+auto registry_t::gauges<std::string>(const filter_t&) const ->
+    std::map<tags_t, shared_metric<metrics::gauge<std::string>>>;
+
 template
 auto registry_t::counter<std::int64_t>(std::string, tags_t::container_type) const ->
     shared_metric<std::atomic<std::int64_t>>;
@@ -383,10 +774,34 @@ template
 auto registry_t::counter<std::uint64_t>(std::string, tags_t::container_type) const ->
     shared_metric<std::atomic<std::uint64_t>>;
 
+template
+auto registry_t::counter<std::int64_t>(const tags_view_t&) const ->
+    shared_metric<std::atomic<std::int64_t>>;
+
+template
+auto registry_t::counter<std::uint64_t>(const tags_view_t&) const ->
+    shared_metric<std::atomic<std::uint64_t>>;
+
 template
 auto registry_t::counters<std::int64_t>() const ->
     std::map<tags_t, shared_metric<std::atomic<std::int64_t>>>;
 
+template
+auto registry_t::counters<std::int64_t>(const query_t&) const ->
+    std::map<tags_t, shared_metric<std::atomic<std::int64_t>>>;
+
+template
+auto registry_t::counters<std::int64_t>(const filter_t&) const ->
+    std::map<tags_t, shared_metric<std::atomic<std::int64_t>>>;
+
+template
+auto registry_t::counters<std::uint64_t>(const query_t&) const ->
+    std::map<tags_t, shared_metric<std::atomic<std::uint64_t>>>;
+
+template
+auto registry_t::counters<std::uint64_t>(const filter_t&) const ->
+    std::map<tags_t, shared_metric<std::atomic<std::uint64_t>>>;
+
 template
 auto registry_t::timer<accumulator::sliding::window_t>(std::string, tags_t::container_type tags) const ->
     shared_metric<metrics::timer<accumulator::sliding::window_t>>;
@@ -395,6 +810,142 @@ template
 auto registry_t::timer<accumulator::decaying::exponentially_t>(std::string, tags_t::container_type tags) const ->
     shared_metric<metrics::timer<accumulator::decaying::exponentially_t>>;
 
+template
+auto registry_t::timer<accumulator::sketch::tdigest_t>(std::string, tags_t::container_type tags) const ->
+    shared_metric<metrics::timer<accumulator::sketch::tdigest_t>>;
+
+template
+auto registry_t::timer<accumulator::sketch::ddsketch_t>(std::string, tags_t::container_type tags) const ->
+    shared_metric<metrics::timer<accumulator::sketch::ddsketch_t>>;
+
+template
+auto registry_t::timer<accumulator::sliding::time_window_t>(std::string, tags_t::container_type tags) const ->
+    shared_metric<metrics::timer<accumulator::sliding::time_window_t>>;
+
+template
+auto registry_t::timer<accumulator::hdr::histogram_t>(std::string, tags_t::container_type tags) const ->
+    shared_metric<metrics::timer<accumulator::hdr::histogram_t>>;
+
+template
+auto registry_t::timer<accumulator::sliding::window_t>(std::string, tags_t::container_type tags, std::uint32_t) const ->
+    shared_metric<metrics::timer<accumulator::sliding::window_t>>;
+
+template
+auto registry_t::timer<accumulator::decaying::exponentially_t>(std::string, tags_t::container_type tags, std::uint32_t) const ->
+    shared_metric<metrics::timer<accumulator::decaying::exponentially_t>>;
+
+template
+auto registry_t::timer<accumulator::sketch::tdigest_t>(std::string, tags_t::container_type tags, std::uint32_t) const ->
+    shared_metric<metrics::timer<accumulator::sketch::tdigest_t>>;
+
+template
+auto registry_t::timer<accumulator::sketch::ddsketch_t>(std::string, tags_t::container_type tags, std::uint32_t) const ->
+    shared_metric<metrics::timer<accumulator::sketch::ddsketch_t>>;
+
+template
+auto registry_t::timer<accumulator::sliding::time_window_t>(std::string, tags_t::container_type tags, std::uint32_t) const ->
+    shared_metric<metrics::timer<accumulator::sliding::time_window_t>>;
+
+template
+auto registry_t::timer<accumulator::hdr::histogram_t>(std::string, tags_t::container_type tags, std::uint32_t) const ->
+    shared_metric<metrics::timer<accumulator::hdr::histogram_t>>;
+
+template
+auto registry_t::tsc_timer<accumulator::sliding::window_t>(std::string, tags_t::container_type tags) const ->
+    shared_metric<metrics::timer<accumulator::sliding::window_t>>;
+
+template
+auto registry_t::tsc_timer<accumulator::decaying::exponentially_t>(std::string, tags_t::container_type tags) const ->
+    shared_metric<metrics::timer<accumulator::decaying::exponentially_t>>;
+
+template
+auto registry_t::tsc_timer<accumulator::sketch::tdigest_t>(std::string, tags_t::container_type tags) const ->
+    shared_metric<metrics::timer<accumulator::sketch::tdigest_t>>;
+
+template
+auto registry_t::tsc_timer<accumulator::sketch::ddsketch_t>(std::string, tags_t::container_type tags) const ->
+    shared_metric<metrics::timer<accumulator::sketch::ddsketch_t>>;
+
+template
+auto registry_t::tsc_timer<accumulator::sliding::time_window_t>(std::string, tags_t::container_type tags) const ->
+    shared_metric<metrics::timer<accumulator::sliding::time_window_t>>;
+
+template
+auto registry_t::tsc_timer<accumulator::hdr::histogram_t>(std::string, tags_t::container_type tags) const ->
+    shared_metric<metrics::timer<accumulator::hdr::histogram_t>>;
+
+template
+auto registry_t::tsc_timer<accumulator::sliding::window_t>(std::string, tags_t::container_type tags, std::uint32_t) const ->
+    shared_metric<metrics::timer<accumulator::sliding::window_t>>;
+
+template
+auto registry_t::tsc_timer<accumulator::decaying::exponentially_t>(std::string, tags_t::container_type tags, std::uint32_t) const ->
+    shared_metric<metrics::timer<accumulator::decaying::exponentially_t>>;
+
+template
+auto registry_t::tsc_timer<accumulator::sketch::tdigest_t>(std::string, tags_t::container_type tags, std::uint32_t) const ->
+    shared_metric<metrics::timer<accumulator::sketch::tdigest_t>>;
+
+template
+auto registry_t::tsc_timer<accumulator::sketch::ddsketch_t>(std::string, tags_t::container_type tags, std::uint32_t) const ->
+    shared_metric<metrics::timer<accumulator::sketch::ddsketch_t>>;
+
+template
+auto registry_t::tsc_timer<accumulator::sliding::time_window_t>(std::string, tags_t::container_type tags, std::uint32_t) const ->
+    shared_metric<metrics::timer<accumulator::sliding::time_window_t>>;
+
+template
+auto registry_t::tsc_timer<accumulator::hdr::histogram_t>(std::string, tags_t::container_type tags, std::uint32_t) const ->
+    shared_metric<metrics::timer<accumulator::hdr::histogram_t>>;
+
+template
+auto registry_t::static_timer<accumulator::sliding::window_t>(std::string, tags_t::container_type tags, std::uint32_t) const ->
+    shared_metric<metrics::static_timer<accumulator::sliding::window_t>>;
+
+template
+auto registry_t::static_timer<accumulator::decaying::exponentially_t>(std::string, tags_t::container_type tags, std::uint32_t) const ->
+    shared_metric<metrics::static_timer<accumulator::decaying::exponentially_t>>;
+
+template
+auto registry_t::static_timer<accumulator::sketch::tdigest_t>(std::string, tags_t::container_type tags, std::uint32_t) const ->
+    shared_metric<metrics::static_timer<accumulator::sketch::tdigest_t>>;
+
+template
+auto registry_t::static_timer<accumulator::sketch::ddsketch_t>(std::string, tags_t::container_type tags, std::uint32_t) const ->
+    shared_metric<metrics::static_timer<accumulator::sketch::ddsketch_t>>;
+
+template
+auto registry_t::static_timer<accumulator::sliding::time_window_t>(std::string, tags_t::container_type tags, std::uint32_t) const ->
+    shared_metric<metrics::static_timer<accumulator::sliding::time_window_t>>;
+
+template
+auto registry_t::static_timer<accumulator::hdr::histogram_t>(std::string, tags_t::container_type tags, std::uint32_t) const ->
+    shared_metric<metrics::static_timer<accumulator::hdr::histogram_t>>;
+
+template
+auto registry_t::timer<accumulator::sliding::window_t>(const tags_view_t&) const ->
+    shared_metric<metrics::timer<accumulator::sliding::window_t>>;
+
+template
+auto registry_t::timer<accumulator::decaying::exponentially_t>(const tags_view_t&) const ->
+    shared_metric<metrics::timer<accumulator::decaying::exponentially_t>>;
+
+template
+auto registry_t::timer<accumulator::sketch::tdigest_t>(const tags_view_t&) const ->
+    shared_metric<metrics::timer<accumulator::sketch::tdigest_t>>;
+
+template
+auto registry_t::timer<accumulator::sketch::ddsketch_t>(const tags_view_t&) const ->
+    shared_metric<metrics::timer<accumulator::sketch::ddsketch_t>>;
+
+template
+auto registry_t::timer<accumulator::sliding::time_window_t>(const tags_view_t&) const ->
+    shared_metric<metrics::timer<accumulator::sliding::time_window_t>>;
+
+template
+auto registry_t::timer<accumulator::hdr::histogram_t>(const tags_view_t&) const ->
+    shared_metric<metrics::timer<accumulator::hdr::histogram_t>>;
+
 template
 auto registry_t::timers<accumulator::sliding::window_t>() const ->
     std::map<tags_t, shared_metric<metrics::timer<accumulator::sliding::window_t>>>;
@@ -403,13 +954,82 @@ template
 auto registry_t::timers<accumulator::decaying::exponentially_t>() const ->
     std::map<tags_t, shared_metric<metrics::timer<accumulator::decaying::exponentially_t>>>;
 
+template
+auto registry_t::timers<accumulator::sketch::tdigest_t>() const ->
+    std::map<tags_t, shared_metric<metrics::timer<accumulator::sketch::tdigest_t>>>;
+
+template
+auto registry_t::timers<accumulator::sketch::ddsketch_t>() const ->
+    std::map<tags_t, shared_metric<metrics::timer<accumulator::sketch::ddsketch_t>>>;
+
+template
+auto registry_t::timers<accumulator::sliding::time_window_t>() const ->
+    std::map<tags_t, shared_metric<metrics::timer<accumulator::sliding::time_window_t>>>;
+
+template
+auto registry_t::timers<accumulator::hdr::histogram_t>() const ->
+    std::map<tags_t, shared_metric<metrics::timer<accumulator::hdr::histogram_t>>>;
+
+template
+auto registry_t::timers<accumulator::sliding::window_t>(const query_t&) const ->
+    std::map<tags_t, shared_metric<metrics::timer<accumulator::sliding::window_t>>>;
+
+template
+auto registry_t::timers<accumulator::sliding::window_t>(const filter_t&) const ->
+    std::map<tags_t, shared_metric<metrics::timer<accumulator::sliding::window_t>>>;
+
+template
+auto registry_t::timers<accumulator::decaying::exponentially_t>(const query_t&) const ->
+    std::map<tags_t, shared_metric<metrics::timer<accumulator::decaying::exponentially_t>>>;
+
+template
+auto registry_t::timers<accumulator::sketch::tdigest_t>(const query_t&) const ->
+    std::map<tags_t, shared_metric<metrics::timer<accumulator::sketch::tdigest_t>>>;
+
+template
+auto registry_t::timers<accumulator::sketch::ddsketch_t>(const query_t&) const ->
+    std::map<tags_t, shared_metric<metrics::timer<accumulator::sketch::ddsketch_t>>>;
+
+template
+auto registry_t::timers<accumulator::sliding::time_window_t>(const query_t&) const ->
+    std::map<tags_t, shared_metric<metrics::timer<accumulator::sliding::time_window_t>>>;
+
+template
+auto registry_t::timers<accumulator::hdr::histogram_t>(const query_t&) const ->
+    std::map<tags_t, shared_metric<metrics::timer<accumulator::hdr::histogram_t>>>;
+
+template
+auto registry_t::timers<accumulator::decaying::exponentially_t>(const filter_t&) const ->
+    std::map<tags_t, shared_metric<metrics::timer<accumulator::decaying::exponentially_t>>>;
+
+template
+auto registry_t::timers<accumulator::sketch::tdigest_t>(const filter_t&) const ->
+    std::map<tags_t, shared_metric<metrics::timer<accumulator::sketch::tdigest_t>>>;
+
+template
+auto registry_t::timers<accumulator::sketch::ddsketch_t>(const filter_t&) const ->
+    std::map<tags_t, shared_metric<metrics::timer<accumulator::sketch::ddsketch_t>>>;
+
+template
+auto registry_t::timers<accumulator::sliding::time_window_t>(const filter_t&) const ->
+    std::map<tags_t, shared_metric<metrics::timer<accumulator::sliding::time_window_t>>>;
+
+template
+auto registry_t::timers<accumulator::hdr::histogram_t>(const filter_t&) const ->
+    std::map<tags_t, shared_metric<metrics::timer<accumulator::hdr::histogram_t>>>;
+
 template auto registry_t::remove<gauge<std::int64_t>>(const std::string& name, const tags_t::container_type& tags) -> bool;
 template auto registry_t::remove<gauge<std::uint64_t>>(const std::string& name, const tags_t::container_type& tags) -> bool;
 template auto registry_t::remove<gauge<std::double_t>>(const std::string& name, const tags_t::container_type& tags) -> bool;
 template auto registry_t::remove<std::atomic<std::int64_t>>(const std::string& name, const tags_t::container_type& tags) -> bool;
 template auto registry_t::remove<std::atomic<std::uint64_t>>(const std::string& name, const tags_t::container_type& tags) -> bool;
+template auto registry_t::remove<counter_t>(const std::string& name, const tags_t::container_type& tags) -> bool;
 template auto registry_t::remove<meter_t>(const std::string& name, const tags_t::container_type& tags) -> bool;
 template auto registry_t::remove<timer<accumulator::sliding::window_t>>(const std::string& name, const tags_t::container_type& tags) -> bool;
 template auto registry_t::remove<timer<accumulator::decaying::exponentially_t>>(const std::string& name, const tags_t::container_type& tags) -> bool;
+template auto registry_t::remove<timer<accumulator::sketch::tdigest_t>>(const std::string& name, const tags_t::container_type& tags) -> bool;
+template auto registry_t::remove<timer<accumulator::sketch::ddsketch_t>>(const std::string& name, const tags_t::container_type& tags) -> bool;
+template auto registry_t::remove<timer<accumulator::sliding::time_window_t>>(const std::string& name, const tags_t::container_type& tags) -> bool;
+template auto registry_t::remove<timer<accumulator::hdr::histogram_t>>(const std::string& name, const tags_t::container_type& tags) -> bool;
 
 }  // namespace metrics
@@ -4,12 +4,19 @@
 
 #include "metrics/accumulator/sliding/window.hpp"
 #include "metrics/accumulator/decaying/exponentially.hpp"
+#include "metrics/accumulator/sketch/tdigest.hpp"
+#include "metrics/accumulator/sketch/ddsketch.hpp"
+#include "metrics/accumulator/sliding/time_window.hpp"
+#include "metrics/accumulator/hdr/histogram.hpp"
 #include "metrics/registry.hpp"
+#include "metrics/ticker.hpp"
+#include "metrics/timer.hpp"
 
 #include "cpp14/tuple.hpp"
+#include "counter.hpp"
 #include "histogram.hpp"
 #include "meter.hpp"
-#include "timer.hpp"
+#include "table.hpp"
 
 namespace metrics {
 
@@ -25,6 +32,11 @@ struct count {
     typedef std::atomic<T> type;
 };
 
+template<>
+struct count<detail::striped_counter_t> {
+    typedef detail::striped_counter_t type;
+};
+
 template<typename>
 struct meter {
     typedef detail::meter_t type;
@@ -32,9 +44,7 @@ struct meter {
 
 template<typename Accumulate>
 struct timer {
-    typedef std::chrono::high_resolution_clock clock_type;
-
-    typedef detail::timer<clock_type, detail::meter<clock_type>, detail::histogram<Accumulate>> type;
+    typedef static_timer<Accumulate> type;
 };
 
 }  // namespace tag
@@ -43,24 +53,32 @@ template<template<typename> class Tag, typename T>
 struct collection_of;
 
 /// Represents a tagged collection of metrics with various specializations.
+///
+/// Each specialization is kept in its own sharded concurrent table, which allows to look up
+/// already registered metrics without locking.
 template<template<typename> class Tag, typename... U>
 struct collection_of<Tag, std::tuple<U...>> {
-    std::tuple<
-        std::map<
-            tags_t,
-            std::weak_ptr<typename Tag<U>::type>
-        >...
-    > containers;
-    mutable std::mutex mutex;
+    template<typename T>
+    using table_type = detail::table<typename Tag<T>::type>;
+
+    std::tuple<table_type<U>...> containers;
 
     template<typename T>
-    auto get() noexcept -> std::map<tags_t, std::weak_ptr<typename Tag<T>::type>>& {
-        return cpp14::get<std::map<tags_t, std::weak_ptr<typename Tag<T>::type>>>(containers);
+    auto get() noexcept -> table_type<T>& {
+        return cpp14::get<table_type<T>>(containers);
     }
 
     template<typename T>
-    auto get() const noexcept -> std::map<tags_t, std::weak_ptr<typename Tag<T>::type>> const& {
-        return cpp14::get<std::map<tags_t, std::weak_ptr<typename Tag<T>::type>>>(containers);
+    auto get() const noexcept -> table_type<T> const& {
+        return cpp14::get<table_type<T>>(containers);
+    }
+
+    /// Calls the given function with each table.
+    template<typename F>
+    auto each(F fn) const -> void {
+        // Initializer lists guarantee left-to-right evaluation of the expansion.
+        const int expand[] = {(fn(get<U>()), 0)...};
+        (void)expand;
     }
 };
 
@@ -69,10 +87,19 @@ struct select_container;
 
 class registry_t::inner_t {
 public:
+    std::shared_ptr<generation_t> generation;
+    /// Ticker, which meters and timers are attached to on creation, if any.
+    std::shared_ptr<ticker_t> ticker;
+
     collection_of<tag::gauge, std::tuple<std::int64_t, std::uint64_t, std::double_t, std::string>> gauges;
-    collection_of<tag::count, std::tuple<std::int64_t, std::uint64_t>> counters;
+    collection_of<tag::count, std::tuple<std::int64_t, std::uint64_t, detail::striped_counter_t>> counters;
     collection_of<tag::meter, std::tuple<detail::meter_t>> meters;
-    collection_of<tag::timer, std::tuple<accumulator::sliding::window_t, accumulator::decaying::exponentially_t>> timers;
+    collection_of<tag::timer, std::tuple<accumulator::sliding::window_t, accumulator::decaying::exponentially_t, accumulator::hdr::histogram_t, accumulator::sliding::time_window_t, accumulator::sketch::ddsketch_t, accumulator::sketch::tdigest_t>> timers;
+
+    explicit inner_t(std::shared_ptr<ticker_t> ticker) :
+        generation(std::make_shared<generation_t>()),
+        ticker(std::move(ticker))
+    {}
 };
 
 }  // namespace metrics
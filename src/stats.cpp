@@ -0,0 +1,527 @@
+#include "stats.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#ifdef METRICS_STATS_SIMD
+#include <immintrin.h>
+#endif
+
+namespace metrics {
+namespace detail {
+
+namespace {
+
+/// Number of values in a block, which is small enough for the block to stay in the L1 cache
+/// between both passes.
+constexpr std::size_t block_size = 512;
+
+/// Sums of (weighted) differences from the pivot value.
+struct sums_t {
+    double weight;
+    double s1;
+    double s2;
+    std::uint64_t min;
+    std::uint64_t max;
+};
+
+auto empty() noexcept -> moments_t {
+    return {0.0, 0.0, 0.0, 0, 0};
+}
+
+auto initial() noexcept -> sums_t {
+    return {0.0, 0.0, 0.0, std::numeric_limits<std::uint64_t>::max(), 0};
+}
+
+/// Accumulates the given values into the given sums one by one.
+///
+/// The first pass over a block sums values and finds bounds, ignoring the pivot, while the
+/// second one sums differences from the pivot and their squares only.
+template<bool Second>
+auto accumulate(sums_t& sums, double pivot, const std::uint64_t* values, std::size_t size) noexcept
+    -> void
+{
+    for (std::size_t id = 0; id < size; ++id) {
+        const auto value = values[id];
+
+        if (Second) {
+            const auto diff = static_cast<double>(value) - pivot;
+            sums.s1 += diff;
+            sums.s2 += diff * diff;
+        } else {
+            sums.s1 += static_cast<double>(value);
+            sums.min = std::min(sums.min, value);
+            sums.max = std::max(sums.max, value);
+        }
+    }
+
+    sums.weight += static_cast<double>(size);
+}
+
+template<bool Second>
+auto accumulate(sums_t& sums,
+                double pivot,
+                const std::uint64_t* values,
+                const double* weights,
+                std::size_t size) noexcept -> void
+{
+    for (std::size_t id = 0; id < size; ++id) {
+        const auto value = values[id];
+
+        sums.weight += weights[id];
+
+        if (Second) {
+            const auto diff = static_cast<double>(value) - pivot;
+            const auto weighted = weights[id] * diff;
+            sums.s1 += weighted;
+            sums.s2 += weighted * diff;
+        } else {
+            sums.s1 += weights[id] * static_cast<double>(value);
+            sums.min = std::min(sums.min, value);
+            sums.max = std::max(sums.max, value);
+        }
+    }
+}
+
+/// Calculates moments of the values in blocks, using the given function for accumulating sums of
+/// a range of values, which is told whether it's the second pass over the block.
+///
+/// Each block is passed twice: first to find its mean and then to sum squared differences from
+/// it, so the precision doesn't depend on how far values are from each other. Blocks are merged
+/// using the pairwise update of Chan et al.
+template<typename F>
+auto blocked(std::size_t size, F accumulate) noexcept -> moments_t {
+    if (size == 0) {
+        return empty();
+    }
+
+    auto result = empty();
+    result.min = std::numeric_limits<std::uint64_t>::max();
+
+    // Running mean of the merged blocks, which is more precise than the sum divided by weight.
+    double mean = 0.0;
+
+    for (std::size_t offset = 0; offset < size; offset += block_size) {
+        const auto count = std::min(block_size, size - offset);
+
+        auto totals = initial();
+        accumulate(totals, 0.0, offset, count, false);
+
+        result.sum += totals.s1;
+        result.min = std::min(result.min, totals.min);
+        result.max = std::max(result.max, totals.max);
+
+        if (totals.weight <= 0.0) {
+            continue;
+        }
+
+        const auto pivot = totals.s1 / totals.weight;
+
+        auto sums = initial();
+        accumulate(sums, pivot, offset, count, true);
+
+        const auto weight = sums.weight;
+        const auto block_mean = pivot + sums.s1 / weight;
+        const auto block_m2 = std::max(0.0, sums.s2 - sums.s1 * sums.s1 / weight);
+
+        const auto total = result.weight + weight;
+        const auto delta = block_mean - mean;
+
+        mean += delta * weight / total;
+        result.m2 += block_m2 + delta * delta * result.weight * weight / total;
+        result.weight = total;
+    }
+
+    return result;
+}
+
+#ifdef METRICS_STATS_SIMD
+
+/// Converts unsigned 64-bit integers to doubles, which neither SSE nor AVX2 have instructions
+/// for.
+///
+/// Both 32-bit halves are placed into mantissas of doubles with exponents of 2^84 and 2^52
+/// respectively, which are then subtracted, so the only rounding happens on the final addition.
+__attribute__((target("sse4.2")))
+inline auto convert(__m128i value) noexcept -> __m128d {
+    const auto hi = _mm_or_si128(_mm_srli_epi64(value, 32), _mm_set1_epi64x(0x4530000000000000));
+    const auto lo = _mm_blend_epi16(value, _mm_set1_epi64x(0x4330000000000000), 0xcc);
+
+    const auto bias = _mm_castsi128_pd(_mm_set1_epi64x(0x4530000000100000));
+    const auto diff = _mm_sub_pd(_mm_castsi128_pd(hi), bias);
+
+    return _mm_add_pd(diff, _mm_castsi128_pd(lo));
+}
+
+__attribute__((target("avx2")))
+inline auto convert(__m256i value) noexcept -> __m256d {
+    const auto hi = _mm256_or_si256(_mm256_srli_epi64(value, 32),
+                                    _mm256_set1_epi64x(0x4530000000000000));
+    const auto lo = _mm256_blend_epi32(value, _mm256_set1_epi64x(0x4330000000000000), 0xaa);
+
+    const auto bias = _mm256_castsi256_pd(_mm256_set1_epi64x(0x4530000000100000));
+    const auto diff = _mm256_sub_pd(_mm256_castsi256_pd(hi), bias);
+
+    return _mm256_add_pd(diff, _mm256_castsi256_pd(lo));
+}
+
+/// Vectorized min and max of unsigned 64-bit integers, which are compared as signed ones after
+/// flipping their sign bits.
+struct sse_bounds_t {
+    __m128i sign;
+    __m128i min;
+    __m128i max;
+
+    __attribute__((target("sse4.2")))
+    sse_bounds_t() noexcept :
+        sign(_mm_set1_epi64x(std::numeric_limits<std::int64_t>::min())),
+        min(_mm_set1_epi64x(std::numeric_limits<std::int64_t>::max())),
+        max(sign)
+    {}
+
+    __attribute__((target("sse4.2")))
+    auto update(__m128i value) noexcept -> void {
+        const auto biased = _mm_xor_si128(value, sign);
+        min = _mm_blendv_epi8(min, biased, _mm_cmpgt_epi64(min, biased));
+        max = _mm_blendv_epi8(max, biased, _mm_cmpgt_epi64(biased, max));
+    }
+
+    __attribute__((target("sse4.2")))
+    auto reduce(sums_t& sums) const noexcept -> void {
+        std::uint64_t lows[2];
+        std::uint64_t highs[2];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lows), _mm_xor_si128(min, sign));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(highs), _mm_xor_si128(max, sign));
+
+        for (std::size_t id = 0; id < 2; ++id) {
+            sums.min = std::min(sums.min, lows[id]);
+            sums.max = std::max(sums.max, highs[id]);
+        }
+    }
+};
+
+struct avx2_bounds_t {
+    __m256i sign;
+    __m256i min;
+    __m256i max;
+
+    __attribute__((target("avx2")))
+    avx2_bounds_t() noexcept :
+        sign(_mm256_set1_epi64x(std::numeric_limits<std::int64_t>::min())),
+        min(_mm256_set1_epi64x(std::numeric_limits<std::int64_t>::max())),
+        max(sign)
+    {}
+
+    __attribute__((target("avx2")))
+    auto update(__m256i value) noexcept -> void {
+        const auto biased = _mm256_xor_si256(value, sign);
+        min = _mm256_blendv_epi8(min, biased, _mm256_cmpgt_epi64(min, biased));
+        max = _mm256_blendv_epi8(max, biased, _mm256_cmpgt_epi64(biased, max));
+    }
+
+    __attribute__((target("avx2")))
+    auto reduce(sums_t& sums) const noexcept -> void {
+        std::uint64_t lows[4];
+        std::uint64_t highs[4];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lows), _mm256_xor_si256(min, sign));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(highs), _mm256_xor_si256(max, sign));
+
+        for (std::size_t id = 0; id < 4; ++id) {
+            sums.min = std::min(sums.min, lows[id]);
+            sums.max = std::max(sums.max, highs[id]);
+        }
+    }
+};
+
+__attribute__((target("sse4.2")))
+inline auto reduce(__m128d value) noexcept -> double {
+    double lanes[2];
+    _mm_storeu_pd(lanes, value);
+
+    return lanes[0] + lanes[1];
+}
+
+__attribute__((target("avx2")))
+inline auto reduce(__m256d value) noexcept -> double {
+    double lanes[4];
+    _mm256_storeu_pd(lanes, value);
+
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+template<bool Second>
+__attribute__((target("sse4.2")))
+auto accumulate_sse(sums_t& sums, double pivot, const std::uint64_t* values, std::size_t size)
+    noexcept -> void
+{
+    const auto pivots = _mm_set1_pd(pivot);
+
+    auto s1 = _mm_setzero_pd();
+    auto s2 = _mm_setzero_pd();
+    sse_bounds_t bounds;
+
+    std::size_t id = 0;
+    for (; id + 2 <= size; id += 2) {
+        const auto value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + id));
+
+        if (Second) {
+            const auto diff = _mm_sub_pd(convert(value), pivots);
+            s1 = _mm_add_pd(s1, diff);
+            s2 = _mm_add_pd(s2, _mm_mul_pd(diff, diff));
+        } else {
+            s1 = _mm_add_pd(s1, convert(value));
+            bounds.update(value);
+        }
+    }
+
+    sums.weight += static_cast<double>(id);
+    sums.s1 += reduce(s1);
+    sums.s2 += reduce(s2);
+    bounds.reduce(sums);
+
+    accumulate<Second>(sums, pivot, values + id, size - id);
+}
+
+template<bool Second>
+__attribute__((target("sse4.2")))
+auto accumulate_sse(sums_t& sums,
+                    double pivot,
+                    const std::uint64_t* values,
+                    const double* weights,
+                    std::size_t size) noexcept -> void
+{
+    const auto pivots = _mm_set1_pd(pivot);
+
+    auto sw = _mm_setzero_pd();
+    auto s1 = _mm_setzero_pd();
+    auto s2 = _mm_setzero_pd();
+    sse_bounds_t bounds;
+
+    std::size_t id = 0;
+    for (; id + 2 <= size; id += 2) {
+        const auto value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + id));
+        const auto weight = _mm_loadu_pd(weights + id);
+
+        sw = _mm_add_pd(sw, weight);
+
+        if (Second) {
+            const auto diff = _mm_sub_pd(convert(value), pivots);
+            const auto weighted = _mm_mul_pd(weight, diff);
+            s1 = _mm_add_pd(s1, weighted);
+            s2 = _mm_add_pd(s2, _mm_mul_pd(weighted, diff));
+        } else {
+            s1 = _mm_add_pd(s1, _mm_mul_pd(weight, convert(value)));
+            bounds.update(value);
+        }
+    }
+
+    sums.weight += reduce(sw);
+    sums.s1 += reduce(s1);
+    sums.s2 += reduce(s2);
+    bounds.reduce(sums);
+
+    accumulate<Second>(sums, pivot, values + id, weights + id, size - id);
+}
+
+template<bool Second>
+__attribute__((target("avx2")))
+auto accumulate_avx2(sums_t& sums, double pivot, const std::uint64_t* values, std::size_t size)
+    noexcept -> void
+{
+    const auto pivots = _mm256_set1_pd(pivot);
+
+    auto s1 = _mm256_setzero_pd();
+    auto s2 = _mm256_setzero_pd();
+    avx2_bounds_t bounds;
+
+    std::size_t id = 0;
+    for (; id + 4 <= size; id += 4) {
+        const auto value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + id));
+
+        if (Second) {
+            const auto diff = _mm256_sub_pd(convert(value), pivots);
+            s1 = _mm256_add_pd(s1, diff);
+            s2 = _mm256_add_pd(s2, _mm256_mul_pd(diff, diff));
+        } else {
+            s1 = _mm256_add_pd(s1, convert(value));
+            bounds.update(value);
+        }
+    }
+
+    sums.weight += static_cast<double>(id);
+    sums.s1 += reduce(s1);
+    sums.s2 += reduce(s2);
+    bounds.reduce(sums);
+
+    accumulate<Second>(sums, pivot, values + id, size - id);
+}
+
+template<bool Second>
+__attribute__((target("avx2")))
+auto accumulate_avx2(sums_t& sums,
+                     double pivot,
+                     const std::uint64_t* values,
+                     const double* weights,
+                     std::size_t size) noexcept -> void
+{
+    const auto pivots = _mm256_set1_pd(pivot);
+
+    auto sw = _mm256_setzero_pd();
+    auto s1 = _mm256_setzero_pd();
+    auto s2 = _mm256_setzero_pd();
+    avx2_bounds_t bounds;
+
+    std::size_t id = 0;
+    for (; id + 4 <= size; id += 4) {
+        const auto value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + id));
+        const auto weight = _mm256_loadu_pd(weights + id);
+
+        sw = _mm256_add_pd(sw, weight);
+
+        if (Second) {
+            const auto diff = _mm256_sub_pd(convert(value), pivots);
+            const auto weighted = _mm256_mul_pd(weight, diff);
+            s1 = _mm256_add_pd(s1, weighted);
+            s2 = _mm256_add_pd(s2, _mm256_mul_pd(weighted, diff));
+        } else {
+            s1 = _mm256_add_pd(s1, _mm256_mul_pd(weight, convert(value)));
+            bounds.update(value);
+        }
+    }
+
+    sums.weight += reduce(sw);
+    sums.s1 += reduce(s1);
+    sums.s2 += reduce(s2);
+    bounds.reduce(sums);
+
+    accumulate<Second>(sums, pivot, values + id, weights + id, size - id);
+}
+
+auto has_sse() noexcept -> bool {
+    static const bool result = __builtin_cpu_supports("sse4.2");
+    return result;
+}
+
+auto has_avx2() noexcept -> bool {
+    static const bool result = __builtin_cpu_supports("avx2");
+    return result;
+}
+
+#endif
+
+}  // namespace
+
+namespace scalar {
+
+auto moments(const std::uint64_t* values, std::size_t size) noexcept -> moments_t {
+    return blocked(size, [&](sums_t& sums, double pivot, std::size_t offset, std::size_t count, bool second) {
+        if (second) {
+            accumulate<true>(sums, pivot, values + offset, count);
+        } else {
+            accumulate<false>(sums, pivot, values + offset, count);
+        }
+    });
+}
+
+auto moments(const std::uint64_t* values, const double* weights, std::size_t size) noexcept
+    -> moments_t
+{
+    return blocked(size, [&](sums_t& sums, double pivot, std::size_t offset, std::size_t count, bool second) {
+        if (second) {
+            accumulate<true>(sums, pivot, values + offset, weights + offset, count);
+        } else {
+            accumulate<false>(sums, pivot, values + offset, weights + offset, count);
+        }
+    });
+}
+
+}  // namespace scalar
+
+#ifdef METRICS_STATS_SIMD
+
+namespace sse {
+
+auto moments(const std::uint64_t* values, std::size_t size) noexcept -> moments_t {
+    return blocked(size, [&](sums_t& sums, double pivot, std::size_t offset, std::size_t count, bool second) {
+        if (second) {
+            accumulate_sse<true>(sums, pivot, values + offset, count);
+        } else {
+            accumulate_sse<false>(sums, pivot, values + offset, count);
+        }
+    });
+}
+
+auto moments(const std::uint64_t* values, const double* weights, std::size_t size) noexcept
+    -> moments_t
+{
+    return blocked(size, [&](sums_t& sums, double pivot, std::size_t offset, std::size_t count, bool second) {
+        if (second) {
+            accumulate_sse<true>(sums, pivot, values + offset, weights + offset, count);
+        } else {
+            accumulate_sse<false>(sums, pivot, values + offset, weights + offset, count);
+        }
+    });
+}
+
+}  // namespace sse
+
+namespace avx2 {
+
+auto moments(const std::uint64_t* values, std::size_t size) noexcept -> moments_t {
+    return blocked(size, [&](sums_t& sums, double pivot, std::size_t offset, std::size_t count, bool second) {
+        if (second) {
+            accumulate_avx2<true>(sums, pivot, values + offset, count);
+        } else {
+            accumulate_avx2<false>(sums, pivot, values + offset, count);
+        }
+    });
+}
+
+auto moments(const std::uint64_t* values, const double* weights, std::size_t size) noexcept
+    -> moments_t
+{
+    return blocked(size, [&](sums_t& sums, double pivot, std::size_t offset, std::size_t count, bool second) {
+        if (second) {
+            accumulate_avx2<true>(sums, pivot, values + offset, weights + offset, count);
+        } else {
+            accumulate_avx2<false>(sums, pivot, values + offset, weights + offset, count);
+        }
+    });
+}
+
+}  // namespace avx2
+
+#endif
+
+auto moments(const std::uint64_t* values, std::size_t size) noexcept -> moments_t {
+#ifdef METRICS_STATS_SIMD
+    if (has_avx2()) {
+        return avx2::moments(values, size);
+    }
+
+    if (has_sse()) {
+        return sse::moments(values, size);
+    }
+#endif
+
+    return scalar::moments(values, size);
+}
+
+auto moments(const std::uint64_t* values, const double* weights, std::size_t size) noexcept
+    -> moments_t
+{
+#ifdef METRICS_STATS_SIMD
+    if (has_avx2()) {
+        return avx2::moments(values, weights, size);
+    }
+
+    if (has_sse()) {
+        return sse::moments(values, weights, size);
+    }
+#endif
+
+    return scalar::moments(values, weights, size);
+}
+
+}  // namespace detail
+}  // namespace metrics
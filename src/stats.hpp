@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define METRICS_STATS_SIMD
+#endif
+
+namespace metrics {
+namespace detail {
+
+/// Summary statistics of a set of values, calculated in a single pass.
+struct moments_t {
+    /// Sum of weights, which is the number of values if they are not weighted.
+    double weight;
+    /// Weighted sum of values.
+    double sum;
+    /// Weighted sum of squared differences from the mean.
+    double m2;
+    std::uint64_t min;
+    std::uint64_t max;
+
+    /// Returns the weighted arithmetic mean.
+    auto mean() const noexcept -> double {
+        return weight > 0.0 ? sum / weight : 0.0;
+    }
+};
+
+/// Calculates summary statistics of the given values.
+///
+/// Uses the widest vector instruction set supported by the CPU among AVX2 and SSE4.2, which is
+/// detected on the first call, falling back to the scalar implementation.
+///
+/// Values are processed in cache-sized blocks, each passed twice: first for the mean and then for
+/// squared differences from it, and blocks are merged pairwise, so the variance stays precise
+/// even for values far away from zero with a tiny spread.
+auto moments(const std::uint64_t* values, std::size_t size) noexcept -> moments_t;
+
+/// Calculates summary statistics of the given values, each weighted with the weight at the same
+/// position.
+auto moments(const std::uint64_t* values, const double* weights, std::size_t size) noexcept
+    -> moments_t;
+
+namespace scalar {
+
+/// Portable implementations, which are exposed mostly for testing.
+auto moments(const std::uint64_t* values, std::size_t size) noexcept -> moments_t;
+
+auto moments(const std::uint64_t* values, const double* weights, std::size_t size) noexcept
+    -> moments_t;
+
+}  // namespace scalar
+
+#ifdef METRICS_STATS_SIMD
+
+namespace sse {
+
+/// SSE4.2 implementations, which are exposed mostly for testing and must be called only if the
+/// CPU supports the instruction set.
+auto moments(const std::uint64_t* values, std::size_t size) noexcept -> moments_t;
+
+auto moments(const std::uint64_t* values, const double* weights, std::size_t size) noexcept
+    -> moments_t;
+
+}  // namespace sse
+
+namespace avx2 {
+
+/// AVX2 implementations, which are exposed mostly for testing and must be called only if the
+/// CPU supports the instruction set.
+auto moments(const std::uint64_t* values, std::size_t size) noexcept -> moments_t;
+
+auto moments(const std::uint64_t* values, const double* weights, std::size_t size) noexcept
+    -> moments_t;
+
+}  // namespace avx2
+
+#endif
+
+}  // namespace detail
+}  // namespace metrics
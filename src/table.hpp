@@ -0,0 +1,386 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "metrics/tags.hpp"
+
+#include "cpp14/utility.hpp"
+#include "epoch.hpp"
+#include "index.hpp"
+
+namespace metrics {
+namespace detail {
+
+/// A concurrent hash table of weak metric references keyed by tags, optimized for read-mostly
+/// workloads, i.e. for lookups of already registered metrics.
+///
+/// The table is partitioned into shards by hash value, each protected by its own mutex, which is
+/// acquired for modifications only. Lookups are lock-free: they traverse immutable nodes under
+/// the protection of epoch-based reclamation, touching no shared memory for writing.
+///
+/// Each shard also keeps the tag index of its own nodes, guarded by the same mutex, so that
+/// registrations in different shards don't serialize on the index either.
+template<typename T>
+class table {
+public:
+    typedef T value_type;
+
+    /// Table node. Both tags and the weak reference are immutable, so they can be read without
+    /// synchronization, while the link is modified only under the shard mutex.
+    struct node_t {
+        const tags_t tags;
+        const std::weak_ptr<T> instance;
+        std::atomic<node_t*> next;
+
+        node_t(tags_t tags, std::weak_ptr<T> instance, node_t* next) :
+            tags(std::move(tags)),
+            instance(std::move(instance)),
+            next(next)
+        {}
+    };
+
+private:
+    static constexpr std::size_t shard_bits = 4;
+    static constexpr std::size_t shards_count = 1 << shard_bits;
+    static constexpr std::size_t initial_size = 8;
+    /// Number of buckets checked for expired nodes on each modification.
+    static constexpr std::size_t sweep_size = 2;
+
+    /// Bucket array, which owns all nodes linked into it.
+    class buckets_t {
+        std::size_t mask;
+        std::unique_ptr<std::atomic<node_t*>[]> heads;
+
+    public:
+        explicit buckets_t(std::size_t size) :
+            mask(size - 1),
+            heads(new std::atomic<node_t*>[size])
+        {
+            for (std::size_t id = 0; id < size; ++id) {
+                heads[id].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        ~buckets_t() {
+            for (std::size_t id = 0; id < size(); ++id) {
+                auto node = heads[id].load(std::memory_order_relaxed);
+                while (node) {
+                    delete std::exchange(node, node->next.load(std::memory_order_relaxed));
+                }
+            }
+        }
+
+        auto size() const noexcept -> std::size_t {
+            return mask + 1;
+        }
+
+        auto at(std::size_t id) noexcept -> std::atomic<node_t*>& {
+            return heads[id & mask];
+        }
+
+        auto at(std::size_t id) const noexcept -> const std::atomic<node_t*>& {
+            return heads[id & mask];
+        }
+    };
+
+    struct shard_t {
+        std::atomic<buckets_t*> buckets;
+        /// Number of nodes, guarded by the mutex.
+        std::size_t size;
+        /// Next bucket to sweep, guarded by the mutex.
+        std::size_t cursor;
+        /// Tag index of nodes in this shard, guarded by the mutex.
+        index_t index;
+        mutable std::mutex mutex;
+
+        shard_t() :
+            buckets(new buckets_t(initial_size)),
+            size(0),
+            cursor(0)
+        {}
+
+        ~shard_t() {
+            delete buckets.load(std::memory_order_relaxed);
+        }
+    };
+
+    std::array<shard_t, shards_count> shards;
+
+public:
+    table() = default;
+    table(const table& other) = delete;
+
+    auto operator=(const table& other) -> table& = delete;
+
+    /// Looks up a node with the given hash value, which tags satisfy the given predicate, without
+    /// locking.
+    ///
+    /// \warning the caller must stay inside an epoch critical section while using the result.
+    template<typename Equal>
+    auto find(std::size_t hash, const Equal& eq) const -> const node_t* {
+        const auto& shard = select(hash);
+        const auto buckets = shard.buckets.load(std::memory_order_acquire);
+
+        auto node = buckets->at(hash).load(std::memory_order_acquire);
+        for (; node != nullptr; node = node->next.load(std::memory_order_acquire)) {
+            if (node->tags.hash() == hash && eq(node->tags)) {
+                return node;
+            }
+        }
+
+        return nullptr;
+    }
+
+    /// Returns a metric registered with the given tags, or registers a new one created using the
+    /// given factory if there is no such metric alive.
+    template<typename F>
+    auto get_or_insert(const tags_t& tags, F fn) -> std::shared_ptr<T> {
+        const auto eq = [&](const tags_t& other) -> bool {
+            return other == tags;
+        };
+
+        {
+            epoch_t::guard_t guard(epoch_t::instance());
+            if (auto node = find(tags.hash(), eq)) {
+                if (auto instance = node->instance.lock()) {
+                    return instance;
+                }
+            }
+        }
+
+        auto& shard = select(tags.hash());
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto link = search(shard, tags);
+        if (auto node = link->load(std::memory_order_relaxed)) {
+            if (auto instance = node->instance.lock()) {
+                return instance;
+            }
+
+            // The metric has died, replace the node with a fresh one.
+            unlink(shard, link);
+        }
+
+        std::shared_ptr<T> instance = fn();
+
+        auto& head = shard.buckets.load(std::memory_order_relaxed)->at(tags.hash());
+        const auto node = new node_t(tags, instance, head.load(std::memory_order_relaxed));
+        head.store(node, std::memory_order_release);
+        shard.index.insert(tags);
+
+        sweep(shard);
+
+        if (++shard.size > shard.buckets.load(std::memory_order_relaxed)->size()) {
+            rehash(shard);
+        }
+
+        return instance;
+    }
+
+    /// Removes the node with the given tags, returning whether it existed.
+    auto erase(const tags_t& tags) -> bool {
+        auto& shard = select(tags.hash());
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto link = search(shard, tags);
+        if (link->load(std::memory_order_relaxed) == nullptr) {
+            return false;
+        }
+
+        unlink(shard, link);
+        shard.index.erase(tags);
+
+        sweep(shard);
+        return true;
+    }
+
+    /// Returns the number of nodes, including expired ones.
+    auto size() const -> std::size_t {
+        std::size_t result = 0;
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            result += shard.size;
+        }
+
+        return result;
+    }
+
+    /// Returns the number of nodes, which metrics have died but are not reclaimed yet.
+    ///
+    /// \note requires to scan the whole table.
+    auto expired() const -> std::size_t {
+        std::size_t result = 0;
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            const auto buckets = shard.buckets.load(std::memory_order_relaxed);
+
+            for (std::size_t id = 0; id < buckets->size(); ++id) {
+                auto node = buckets->at(id).load(std::memory_order_relaxed);
+                for (; node != nullptr; node = node->next.load(std::memory_order_relaxed)) {
+                    if (node->instance.expired()) {
+                        ++result;
+                    }
+                }
+            }
+        }
+
+        return result;
+    }
+
+    /// Calls the given function with tags and an instance of each alive metric.
+    template<typename F>
+    auto for_each(F fn) const -> void {
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            const auto buckets = shard.buckets.load(std::memory_order_relaxed);
+
+            for (std::size_t id = 0; id < buckets->size(); ++id) {
+                auto node = buckets->at(id).load(std::memory_order_relaxed);
+                for (; node != nullptr; node = node->next.load(std::memory_order_relaxed)) {
+                    if (auto instance = node->instance.lock()) {
+                        fn(node->tags, std::move(instance));
+                    }
+                }
+            }
+        }
+    }
+
+    /// Calls the given function with tags and an instance of each alive metric matching the given
+    /// filter.
+    ///
+    /// Non-empty filters are answered using the tag index, visiting matching metrics only.
+    template<typename F>
+    auto for_each(const filter_t& filter, F fn) const -> void {
+        if (filter.empty()) {
+            for_each(std::move(fn));
+            return;
+        }
+
+        std::vector<std::pair<tags_t, std::shared_ptr<T>>> matched;
+
+        for (auto& shard : shards) {
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+
+                for (auto& tags : shard.index.select(filter)) {
+                    const auto eq = [&](const tags_t& other) -> bool {
+                        return other == tags;
+                    };
+
+                    // Nodes can't be retired while the shard mutex is held.
+                    if (auto node = find(tags.hash(), eq)) {
+                        if (auto instance = node->instance.lock()) {
+                            matched.emplace_back(std::move(tags), std::move(instance));
+                        }
+                    }
+                }
+            }
+
+            // Call the function outside the lock, so that it's free to register metrics.
+            for (auto& item : matched) {
+                fn(item.first, std::move(item.second));
+            }
+
+            matched.clear();
+        }
+    }
+
+private:
+    auto select(std::size_t hash) noexcept -> shard_t& {
+        // Use the highest bits for sharding, because the lowest ones select a bucket.
+        return shards[hash >> (sizeof(hash) * 8 - shard_bits)];
+    }
+
+    auto select(std::size_t hash) const noexcept -> const shard_t& {
+        return shards[hash >> (sizeof(hash) * 8 - shard_bits)];
+    }
+
+    /// Returns the link pointing to the node with the given tags or the terminating null link.
+    ///
+    /// \pre the shard mutex must be acquired.
+    auto search(shard_t& shard, const tags_t& tags) -> std::atomic<node_t*>* {
+        auto link = &shard.buckets.load(std::memory_order_relaxed)->at(tags.hash());
+
+        while (auto node = link->load(std::memory_order_relaxed)) {
+            if (node->tags == tags) {
+                break;
+            }
+
+            link = &node->next;
+        }
+
+        return link;
+    }
+
+    /// Unlinks the node the given link points to and retires it.
+    ///
+    /// Concurrent readers standing on the node are still able to move forward, because its link
+    /// remains intact until reclamation.
+    ///
+    /// \pre the shard mutex must be acquired.
+    auto unlink(shard_t& shard, std::atomic<node_t*>* link) -> void {
+        const auto node = link->load(std::memory_order_relaxed);
+        link->store(node->next.load(std::memory_order_relaxed), std::memory_order_release);
+        --shard.size;
+
+        epoch_t::instance().retire(node);
+    }
+
+    /// Reclaims expired nodes from the next few buckets.
+    ///
+    /// Called on each modification, which amortizes reclamation over insertions: the whole shard
+    /// is swept at least once per `size / sweep_size` insertions, so the number of expired nodes
+    /// stays proportional to the insertion rate rather than growing without bound.
+    ///
+    /// \pre the shard mutex must be acquired.
+    auto sweep(shard_t& shard) -> void {
+        const auto buckets = shard.buckets.load(std::memory_order_relaxed);
+
+        for (std::size_t id = 0; id < sweep_size; ++id) {
+            auto link = &buckets->at(shard.cursor++);
+
+            while (auto node = link->load(std::memory_order_relaxed)) {
+                if (node->instance.expired()) {
+                    // The node may be reclaimed immediately after unlinking.
+                    shard.index.erase(node->tags);
+                    unlink(shard, link);
+                } else {
+                    link = &node->next;
+                }
+            }
+        }
+    }
+
+    /// Doubles the number of buckets.
+    ///
+    /// Nodes are copied rather than relinked, because concurrent readers may still traverse the
+    /// old chains, which therefore must stay intact until they are reclaimed with the old bucket
+    /// array.
+    ///
+    /// \pre the shard mutex must be acquired.
+    auto rehash(shard_t& shard) -> void {
+        const auto buckets = shard.buckets.load(std::memory_order_relaxed);
+        std::unique_ptr<buckets_t> result(new buckets_t(2 * buckets->size()));
+
+        for (std::size_t id = 0; id < buckets->size(); ++id) {
+            auto node = buckets->at(id).load(std::memory_order_relaxed);
+            for (; node != nullptr; node = node->next.load(std::memory_order_relaxed)) {
+                auto& head = result->at(node->tags.hash());
+                const auto next = head.load(std::memory_order_relaxed);
+                head.store(new node_t(node->tags, node->instance, next), std::memory_order_relaxed);
+            }
+        }
+
+        shard.buckets.store(result.release(), std::memory_order_release);
+        epoch_t::instance().retire(buckets);
+    }
+};
+
+}  // namespace detail
+}  // namespace metrics
@@ -1,39 +1,203 @@
 #include "metrics/tags.hpp"
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+
 #include <boost/optional/optional.hpp>
 
+#include "intern.hpp"
+#include "tags.hpp"
+
 namespace metrics {
 
-tags_t::tags_t(std::string name) : container({{"name", std::move(name)}}) {}
+namespace {
+
+const boost::string_ref name_key("name");
+
+auto fnv1a(std::uint64_t hash, boost::string_ref value) noexcept -> std::uint64_t {
+    for (const auto ch : value) {
+        hash ^= static_cast<unsigned char>(ch);
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+/// MurmurHash3 finalizer, that avalanches all bits of the given value.
+auto fmix64(std::uint64_t hash) noexcept -> std::uint64_t {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+}  // namespace
+
+namespace detail {
+
+auto hash(boost::string_ref value) noexcept -> std::size_t {
+    return static_cast<std::size_t>(fmix64(fnv1a(0xcbf29ce484222325ULL, value)));
+}
+
+auto hash(boost::string_ref key, boost::string_ref value) noexcept -> std::size_t {
+    auto result = fnv1a(0xcbf29ce484222325ULL, key);
+    // Separate the key from the value to distinguish, for example, "ab=c" and "a=bc".
+    result = fnv1a(result ^ 0xff, value);
+    return static_cast<std::size_t>(fmix64(result));
+}
+
+auto equal(const tags_view_t& view, const tags_t& tags, std::size_t extra) -> bool {
+    if (view.name() != boost::string_ref(tags.name())) {
+        return false;
+    }
+
+    // Both the name and tag keys are unique, so matching every tag of the view and comparing
+    // sizes is enough. Linear search is fine here, because there are usually only few tags.
+    std::size_t size = 1 + extra;
+    for (const auto& tag : view) {
+        if (tag.first == name_key) {
+            continue;
+        }
+
+        auto it = tags.begin();
+        for (; it != tags.end(); ++it) {
+            if (boost::string_ref(*it->first) == tag.first) {
+                break;
+            }
+        }
+
+        if (it == tags.end() || boost::string_ref(*it->second) != tag.second) {
+            return false;
+        }
+
+        ++size;
+    }
+
+    return size == tags.size();
+}
+
+}  // namespace detail
+
+struct tags_t::data_t {
+    /// Number of tags stored inline, which covers the vast majority of metrics.
+    static constexpr std::size_t inline_size = 8;
+
+    value_type* tags;
+    std::size_t size;
+    const std::string* name;
+    std::size_t hash;
+
+    value_type storage[inline_size];
+    std::unique_ptr<value_type[]> overflow;
+
+    /// Constructs from tags, which are already sorted by key and contain the name.
+    explicit data_t(const container_type& container) :
+        tags(storage),
+        size(0),
+        name(nullptr),
+        hash(0)
+    {
+        if (container.size() > inline_size) {
+            overflow.reset(new value_type[container.size()]);
+            tags = overflow.get();
+        }
+
+        for (const auto& kv : container) {
+            tags[size] = value_type(detail::intern(kv.first), detail::intern(kv.second));
+            hash += detail::hash(kv.first, kv.second);
+
+            if (kv.first == name_key) {
+                name = tags[size].second;
+            }
+
+            ++size;
+        }
+    }
+
+    data_t(const data_t& other) = delete;
+
+    ~data_t() {
+        for (std::size_t id = 0; id < size; ++id) {
+            detail::release(tags[id].first);
+            detail::release(tags[id].second);
+        }
+    }
+
+    auto operator=(const data_t& other) -> data_t& = delete;
+};
 
-tags_t::tags_t(std::string name, container_type tags) : container(std::move(tags)) {
-    container["name"] = std::move(name);
+tags_t::tags_t(std::string name) :
+    d(std::make_shared<data_t>(container_type({{"name", std::move(name)}})))
+{}
+
+tags_t::tags_t(std::string name, container_type tags) {
+    tags["name"] = std::move(name);
+    d = std::make_shared<data_t>(tags);
+}
+
+auto
+tags_t::tags() const noexcept -> range_type {
+    return range_type(begin(), end());
 }
 
-const tags_t::container_type&
-tags_t::tags() const noexcept {
-    return container;
+auto
+tags_t::to_map() const -> container_type {
+    container_type result;
+    for (const auto& tag : *this) {
+        result.insert(result.end(), std::make_pair(*tag.first, *tag.second));
+    }
+
+    return result;
 }
 
 const std::string&
 tags_t::name() const noexcept {
-    return container.at("name");
+    return *d->name;
 }
 
 boost::optional<const std::string&>
 tags_t::tag(const std::string& key) const {
-    const auto it = container.find(key);
+    const auto less = [](const value_type& tag, const std::string& key) -> bool {
+        return *tag.first < key;
+    };
+
+    const auto it = std::lower_bound(begin(), end(), key, less);
 
-    if (it == container.end()) {
+    if (it == end() || *it->first != key) {
         return boost::none;
     }
 
-    return it->second;
+    return *it->second;
+}
+
+std::size_t
+tags_t::size() const noexcept {
+    return d->size;
+}
+
+tags_t::const_iterator
+tags_t::begin() const noexcept {
+    return d->tags;
+}
+
+tags_t::const_iterator
+tags_t::end() const noexcept {
+    return d->tags + d->size;
+}
+
+std::size_t
+tags_t::hash() const noexcept {
+    return d->hash;
 }
 
 bool
 tags_t::operator==(const tags_t& other) const {
-    return container == other.container;
+    // Strings are interned, so comparing their addresses is enough.
+    return d == other.d ||
+        (hash() == other.hash() && size() == other.size() && std::equal(begin(), end(), other.begin()));
 }
 
 bool
@@ -43,22 +207,56 @@ tags_t::operator!=(const tags_t& other) const {
 
 bool
 tags_t::operator<(const tags_t& other) const {
-    return container < other.container;
-}
+    // Lexicographical comparison of (key, value) pairs, where content is compared only for the
+    // first pair that differs by address.
+    const auto size = std::min(this->size(), other.size());
 
-} // namespace metrics
+    for (std::size_t id = 0; id < size; ++id) {
+        const auto& lhs = d->tags[id];
+        const auto& rhs = other.d->tags[id];
 
-std::hash<metrics::tags_t>::result_type
-std::hash<metrics::tags_t>::operator()(const argument_type& v) const {
-    result_type result = std::hash<std::string>()("");
+        if (lhs.first != rhs.first) {
+            return *lhs.first < *rhs.first;
+        }
 
-    for (const auto& kv : v.tags()) {
-        const result_type hk = std::hash<std::string>()(kv.first);
-        const result_type hv = std::hash<std::string>()(kv.second);
+        if (lhs.second != rhs.second) {
+            return *lhs.second < *rhs.second;
+        }
+    }
+
+    return this->size() < other.size();
+}
+
+tags_view_t::tags_view_t(boost::string_ref name) :
+    tags_view_t(name, nullptr, 0)
+{}
+
+tags_view_t::tags_view_t(boost::string_ref name, const value_type* tags, std::size_t size) {
+    d.name = name;
+    d.first = tags;
+    d.last = tags + size;
+    d.hash = detail::hash(name_key, name);
 
-        result ^= (hk << 1);
-        result ^= (hv << 1);
+    for (const auto& tag : *this) {
+        if (tag.first != name_key) {
+            d.hash += detail::hash(tag.first, tag.second);
+        }
     }
+}
 
-    return result;
+bool
+tags_view_t::operator==(const tags_t& other) const {
+    return hash() == other.hash() && detail::equal(*this, other, 0);
+}
+
+bool
+tags_view_t::operator!=(const tags_t& other) const {
+    return !(*this == other);
+}
+
+} // namespace metrics
+
+std::hash<metrics::tags_t>::result_type
+std::hash<metrics::tags_t>::operator()(const argument_type& v) const {
+    return v.hash();
 }
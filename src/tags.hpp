@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+
+#include <boost/utility/string_ref.hpp>
+
+#include "metrics/tags.hpp"
+
+namespace metrics {
+namespace detail {
+
+/// Returns the hash value of the given string.
+auto hash(boost::string_ref value) noexcept -> std::size_t;
+
+/// Returns the hash value of a single tag, mixing both its key and value.
+///
+/// Hash values of all tags are summed up to obtain the hash of the whole tags set. Addition is
+/// commutative, which allows to hash unordered tag views consistently with ordered `tags_t`.
+auto hash(boost::string_ref key, boost::string_ref value) noexcept -> std::size_t;
+
+/// Checks whether the given tags consist of all tags from the view and exactly `extra` other tags,
+/// which allows to match views against tags with implicitly added tags, like metric type.
+///
+/// \note hash values are not compared.
+auto equal(const tags_view_t& view, const tags_t& tags, std::size_t extra) -> bool;
+
+}  // namespace detail
+}  // namespace metrics
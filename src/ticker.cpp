@@ -0,0 +1,88 @@
+#include "metrics/ticker.hpp"
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace metrics {
+
+class ticker_t::inner_t {
+public:
+    typedef std::chrono::steady_clock clock_type;
+
+    const clock_type::duration interval;
+
+    /// Guards both subscribers and the stop flag and is held during the whole tick, which makes
+    /// unsubscription wait for the function to finish.
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopped;
+
+    id_type next;
+    std::map<id_type, std::function<void()>> subscribers;
+
+    std::thread thread;
+
+    explicit inner_t(std::chrono::milliseconds interval) :
+        interval(interval),
+        stopped(false),
+        next(0)
+    {}
+
+    auto run() -> void {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        // Deadlines are advanced by the interval rather than computed from the current time, so
+        // a late tick is followed by an early one and the number of ticks matches the elapsed
+        // time.
+        auto deadline = clock_type::now() + interval;
+        while (true) {
+            if (cv.wait_until(lock, deadline, [&] { return stopped; })) {
+                return;
+            }
+
+            for (auto& subscriber : subscribers) {
+                subscriber.second();
+            }
+
+            deadline += interval;
+        }
+    }
+};
+
+ticker_t::ticker_t(std::chrono::milliseconds interval) :
+    inner(new inner_t(interval))
+{
+    inner->thread = std::thread(&inner_t::run, inner.get());
+}
+
+ticker_t::~ticker_t() {
+    {
+        std::lock_guard<std::mutex> lock(inner->mutex);
+        inner->stopped = true;
+    }
+
+    inner->cv.notify_one();
+    inner->thread.join();
+}
+
+auto ticker_t::interval() const noexcept -> std::chrono::milliseconds {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(inner->interval);
+}
+
+auto ticker_t::subscribe(std::function<void()> fn) -> id_type {
+    std::lock_guard<std::mutex> lock(inner->mutex);
+
+    const auto id = inner->next++;
+    inner->subscribers.emplace(id, std::move(fn));
+
+    return id;
+}
+
+auto ticker_t::unsubscribe(id_type id) -> void {
+    std::lock_guard<std::mutex> lock(inner->mutex);
+    inner->subscribers.erase(id);
+}
+
+}  // namespace metrics
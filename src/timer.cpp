@@ -2,12 +2,20 @@
 
 #include "metrics/accumulator/sliding/window.hpp"
 #include "metrics/accumulator/decaying/exponentially.hpp"
+#include "metrics/accumulator/sketch/tdigest.hpp"
+#include "metrics/accumulator/sketch/ddsketch.hpp"
+#include "metrics/accumulator/sliding/time_window.hpp"
+#include "metrics/accumulator/hdr/histogram.hpp"
+
+#include "histogram.hpp"
+#include "meter.hpp"
+#include "timer.hpp"
 
 namespace metrics {
 
 timer_t::context_t::context_t(timer_t* parent) :
-    parent(parent, empty_deleter()),
-    timestamp(parent->now())
+    parent(parent->sample() ? parent : nullptr, empty_deleter()),
+    timestamp(this->parent != nullptr ? parent->stamp() : time_point())
 {}
 
 timer_t::context_t::~context_t() {
@@ -15,11 +23,8 @@ timer_t::context_t::~context_t() {
         return;
     }
 
-    const auto now = parent->now();
-    const auto elapsed = now - timestamp;
-
     try {
-        parent->update(elapsed);
+        parent->record(timestamp);
     } catch (...) {
         // Ignore this, because of destructor exception safety reasons. Actually update
         // operation should never throw.
@@ -36,8 +41,103 @@ auto timer_t::context() -> context_t {
 
 timer_t::~timer_t() = default;
 
+auto timer_t::update(const duration_type* durations, std::size_t size) -> void {
+    for (std::size_t id = 0; id < size; ++id) {
+        update(durations[id]);
+    }
+}
+
+template<class Accumulate>
+struct static_timer<Accumulate>::data_t {
+    /// Owns the meter and the histogram, while the clock and the sampler are duplicated inline
+    /// for the fast path.
+    detail::timer<timer_clock_t, detail::meter_t, detail::histogram<Accumulate>> inner;
+};
+
+template<class Accumulate>
+static_timer<Accumulate>::static_timer(std::uint32_t every, bool tsc) :
+    d{timer_clock_t(tsc), sampler_t(every), std::unique_ptr<data_t>(new data_t)}
+{
+    d.data->inner.reset_clock(d.clock);
+    d.data->inner.reset_sampler(d.sampler);
+}
+
+template<class Accumulate>
+static_timer<Accumulate>::~static_timer() = default;
+
+template<class Accumulate>
+auto static_timer<Accumulate>::attach(std::shared_ptr<ticker_t> ticker) -> void {
+    d.data->inner.attach(std::move(ticker));
+}
+
+template<class Accumulate>
+auto static_timer<Accumulate>::now() const -> time_point {
+    return d.data->inner.now();
+}
+
+template<class Accumulate>
+auto static_timer<Accumulate>::count() const -> std::uint64_t {
+    return d.data->inner.count();
+}
+
+template<class Accumulate>
+auto static_timer<Accumulate>::m01rate() const -> double {
+    return d.data->inner.m01rate();
+}
+
+template<class Accumulate>
+auto static_timer<Accumulate>::m05rate() const -> double {
+    return d.data->inner.m05rate();
+}
+
+template<class Accumulate>
+auto static_timer<Accumulate>::m15rate() const -> double {
+    return d.data->inner.m15rate();
+}
+
+template<class Accumulate>
+auto static_timer<Accumulate>::snapshot() const -> snapshot_type {
+    return d.data->inner.snapshot();
+}
+
+template<class Accumulate>
+auto static_timer<Accumulate>::summary(const std::vector<double>& quantiles) const -> summary_t {
+    return d.data->inner.summary(quantiles);
+}
+
+template<class Accumulate>
+auto static_timer<Accumulate>::update(duration_type duration) -> void {
+    d.data->inner.update(duration);
+}
+
+template<class Accumulate>
+auto static_timer<Accumulate>::update(const duration_type* durations, std::size_t size) -> void {
+    d.data->inner.update(durations, size);
+}
+
+template<class Accumulate>
+auto static_timer<Accumulate>::skip() -> void {
+    d.data->inner.skip();
+}
+
+template<class Accumulate>
+auto static_timer<Accumulate>::record(duration_type duration, std::uint64_t count) -> void {
+    d.data->inner.record(duration, count);
+}
+
 /// Instantiations.
 template class timer<accumulator::sliding::window_t>;
 template class timer<accumulator::decaying::exponentially_t>;
+template class timer<accumulator::sketch::tdigest_t>;
+template class timer<accumulator::sketch::ddsketch_t>;
+template class timer<accumulator::sliding::time_window_t>;
+template class timer<accumulator::hdr::histogram_t>;
+
+template class static_timer<accumulator::sliding::window_t>;
+template class static_timer<accumulator::decaying::exponentially_t>;
+template class static_timer<accumulator::sketch::tdigest_t>;
+template class static_timer<accumulator::sketch::ddsketch_t>;
+template class static_timer<accumulator::sliding::time_window_t>;
+template class static_timer<accumulator::hdr::histogram_t>;
 
 }  // namespace metrics
@@ -1,27 +1,131 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
+#include "metrics/accumulator/snapshot/uniform.hpp"
+#include "metrics/clock.hpp"
+#include "metrics/ticker.hpp"
 #include "metrics/timer.hpp"
 
+#include "histogram.hpp"
+
 namespace metrics {
 namespace detail {
 
+/// Returns values of the given snapshot at the given quantiles.
+template<class Snapshot>
+auto quantiles(const Snapshot& snapshot, const std::vector<double>& quantiles)
+    -> std::vector<double>
+{
+    std::vector<double> result;
+    result.reserve(quantiles.size());
+
+    for (auto quantile : quantiles) {
+        result.push_back(snapshot.value(quantile));
+    }
+
+    return result;
+}
+
+/// Uniform snapshots evaluate all quantiles together, which saves selection work.
+inline auto quantiles(const accumulator::snapshot::uniform_t& snapshot,
+                      const std::vector<double>& quantiles) -> std::vector<double>
+{
+    return snapshot.value(quantiles);
+}
+
+/// Measures spans using the given clock type.
+///
+/// Timestamps are passed around as the timer interface time points, so clocks with other time
+/// point types are converted.
+template<class Clock>
+struct stopwatch {
+    typedef timer_t::time_point time_point;
+    typedef timer_t::duration_type duration_type;
+
+    static auto now(const Clock& clock) -> time_point {
+        return time_point(std::chrono::duration_cast<duration_type>(
+            clock.now().time_since_epoch()
+        ));
+    }
+
+    static auto stamp(const Clock& clock) -> time_point {
+        return now(clock);
+    }
+
+    static auto elapsed(const Clock& clock, time_point start) -> duration_type {
+        return now(clock) - start;
+    }
+};
+
+/// The time-stamp counter is read in raw ticks, which are converted into nanoseconds only once
+/// per measured span.
+template<>
+struct stopwatch<tsc_clock_t> {
+    typedef timer_t::time_point time_point;
+    typedef timer_t::duration_type duration_type;
+
+    static auto now(const tsc_clock_t& clock) -> time_point {
+        return time_point(std::chrono::duration_cast<duration_type>(
+            clock.now().time_since_epoch()
+        ));
+    }
+
+    static auto stamp(const tsc_clock_t&) -> time_point {
+        return time_point(duration_type(static_cast<duration_type::rep>(tsc_clock_t::ticks())));
+    }
+
+    static auto elapsed(const tsc_clock_t&, time_point start) -> duration_type {
+        const auto ticks = static_cast<std::uint64_t>(start.time_since_epoch().count());
+        return std::chrono::duration_cast<duration_type>(
+            tsc_clock_t::to_duration(tsc_clock_t::ticks() - ticks)
+        );
+    }
+};
+
+template<>
+struct stopwatch<timer_clock_t> {
+    typedef timer_t::time_point time_point;
+    typedef timer_t::duration_type duration_type;
+
+    static auto now(const timer_clock_t& clock) -> time_point {
+        return clock.now();
+    }
+
+    static auto stamp(const timer_clock_t& clock) -> time_point {
+        return clock.stamp();
+    }
+
+    static auto elapsed(const timer_clock_t& clock, time_point start) -> duration_type {
+        return clock.elapsed(start);
+    }
+};
+
 /// A timer metric which aggregates timing durations and provides duration statistics, plus
 /// throughput statistics via `meter`.
 ///
-/// \tparam `Clock` must meet `TrivialClock` requirements and must be steady.
+/// \tparam `Clock` must meet `TrivialClock` requirements and must be steady. It's used for
+///     measuring durations only, so it should be precise, while the meter is free to use a
+///     coarse clock for rates.
 template<class Clock, class Meter, class Histogram>
-class timer : public metrics::timer<typename Histogram::accumulator_type> {
+class timer final : public metrics::timer<typename Histogram::accumulator_type> {
 public:
     typedef Clock clock_type;
-    typedef typename clock_type::time_point time_point;
-    typedef typename clock_type::duration duration_type;
+    typedef timer_t::time_point time_point;
+    typedef timer_t::duration_type duration_type;
 
     typedef Meter meter_type;
     typedef Histogram histogram_type;
     typedef typename histogram_type::snapshot_type snapshot_type;
+    typedef typename metrics::timer<typename Histogram::accumulator_type>::summary_t summary_t;
 
     // TODO: Suppress this check for GCC and pray, because `steady_clock` isn't available until 4.9.
 #ifdef __clang__
@@ -31,6 +135,7 @@ public:
 private:
     struct data_t {
         clock_type clock;
+        sampler_t sampler;
         mutable meter_type meter;
         histogram_type histogram;
 
@@ -46,6 +151,34 @@ public:
         d(std::forward<Args>(args)...)
     {}
 
+    /// Attaches the underlying meter to the given ticker.
+    ///
+    /// \throws std::invalid_argument if the ticker interval isn't 5 seconds.
+    /// \warning must be called before the timer is shared with other threads.
+    auto attach(std::shared_ptr<ticker_t> ticker) -> void {
+        d.meter.attach(std::move(ticker));
+    }
+
+    /// Replaces the clock.
+    ///
+    /// \warning must be called before the timer is shared with other threads.
+    auto reset_clock(clock_type clock) -> void {
+        d.clock = std::move(clock);
+    }
+
+    /// Replaces the sampler, making the timer record only a sample of measured contexts.
+    ///
+    /// Skipped contexts are still counted by the meter, so both the count and rates reflect every
+    /// event, while the histogram receives an unbiased sample of durations. Each sampled duration
+    /// is recorded with the weight of `every`, so histogram counts and snapshot sizes reflect
+    /// every event too. Accumulators, that can't take weights, record durations once and their
+    /// snapshots are scaled by `every` instead.
+    ///
+    /// \warning must be called before the timer is shared with other threads.
+    auto reset_sampler(sampler_t sampler) -> void {
+        d.sampler = sampler;
+    }
+
     /// Dependency observers.
 
     /// Returns a const reference to the clock implementation.
@@ -53,6 +186,11 @@ public:
         return d.clock;
     }
 
+    /// Returns a const reference to the sampler.
+    auto sampler() const noexcept -> const sampler_t& {
+        return d.sampler;
+    }
+
     /// Returns a const reference to the histogram implementation.
     auto histogram() const noexcept -> const histogram_type& {
         return d.histogram;
@@ -65,11 +203,19 @@ public:
     /// Lookup.
 
     auto now() const -> time_point {
-        return clock().now();
+        return stopwatch<clock_type>::now(clock());
     }
 
+    /// Returns the number of events which have occurred.
+    ///
+    /// Sampling timers record only a part of events in the histogram, so count all of them using
+    /// the meter instead.
     auto count() const noexcept -> std::uint64_t {
-        return histogram().count();
+        if (d.sampler.every() == 1) {
+            return histogram().count();
+        }
+
+        return d.meter.count();
     }
 
     /// Returns the one-minute exponentially-weighted moving average rate at which events have
@@ -91,7 +237,33 @@ public:
     }
 
     auto snapshot() const -> snapshot_type {
-        return histogram().snapshot();
+        return scaled(histogram().snapshot(),
+            typename is_weighted<typename histogram_type::accumulator_type>::type());
+    }
+
+    auto summary(const std::vector<double>& quantiles) const -> summary_t {
+        if (quantiles.size() > summary_t::max_quantiles) {
+            throw std::invalid_argument("too many quantiles requested");
+        }
+
+        const auto rates = d.meter.summary();
+        const auto snapshot = this->snapshot();
+        const auto values = detail::quantiles(snapshot, quantiles);
+
+        summary_t result = summary_t();
+        result.count = rates.count;
+        result.mean_rate = rates.mean_rate;
+        result.m01rate = rates.m01rate;
+        result.m05rate = rates.m05rate;
+        result.m15rate = rates.m15rate;
+        result.min = snapshot.min();
+        result.max = snapshot.max();
+        result.mean = snapshot.mean();
+        result.stddev = snapshot.stddev();
+        result.size = values.size();
+        std::copy(values.begin(), values.end(), result.quantiles.begin());
+
+        return result;
     }
 
     /// Modifiers.
@@ -100,6 +272,88 @@ public:
         d.histogram.update(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
         d.meter.mark();
     }
+
+    /// Converts durations in chunks on the stack, so the histogram and the meter are updated once
+    /// per chunk rather than once per duration.
+    auto update(const duration_type* durations, std::size_t size) -> void {
+        std::array<std::uint64_t, 256> values;
+
+        while (size > 0) {
+            const auto chunk = std::min(size, values.size());
+            for (std::size_t id = 0; id < chunk; ++id) {
+                values[id] = static_cast<std::uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(durations[id]).count()
+                );
+            }
+
+            d.histogram.update(values.data(), chunk);
+            d.meter.mark(chunk);
+
+            durations += chunk;
+            size -= chunk;
+        }
+    }
+
+    /// Creates a new measure context, which, unlike the one created through the timer interface,
+    /// updates this timer without virtual calls.
+    auto context() -> static_context<timer> {
+        return static_context<timer>(*this);
+    }
+
+    /// Measures the time consumption of the given callable without virtual calls.
+    template<typename F>
+    auto measure(F fn) -> decltype(fn()) {
+        static_context<timer> context(*this);
+        return fn();
+    }
+
+    /// Measured spans.
+    ///
+    /// These methods are public, which allows to use the timer with `static_context`, and the
+    /// timer is final, so that calls through the concrete type are resolved statically.
+
+    auto sample() -> bool override {
+        if (d.sampler()) {
+            return true;
+        }
+
+        skip();
+        return false;
+    }
+
+    auto stamp() const -> time_point override {
+        return stopwatch<clock_type>::stamp(clock());
+    }
+
+    auto record(time_point start) -> void override {
+        record(stopwatch<clock_type>::elapsed(clock(), start), d.sampler.every());
+    }
+
+    /// Counts a context skipped by sampling.
+    auto skip() -> void {
+        d.meter.mark();
+    }
+
+    /// Records a measured span, that stands for `count` events, because only one of them was
+    /// sampled.
+    auto record(duration_type duration, std::uint64_t count) -> void {
+        const auto value = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        d.histogram.update_n(static_cast<std::uint64_t>(value), count);
+        d.meter.mark();
+    }
+
+private:
+    auto scaled(snapshot_type snapshot, std::true_type) const -> snapshot_type {
+        return snapshot;
+    }
+
+    auto scaled(snapshot_type snapshot, std::false_type) const -> snapshot_type {
+        if (d.sampler.every() == 1) {
+            return snapshot;
+        }
+
+        return snapshot.scaled(d.sampler.every());
+    }
 };
 
 }  // namespace detail
@@ -1,8 +1,10 @@
+#include <algorithm>
 #include <iostream>
 #include <chrono>
 #include <thread>
 #include <random>
 #include <stdexcept>
+#include <vector>
 
 #include <cmath>
 
@@ -14,7 +16,7 @@ namespace metrics {
 namespace accumulator {
 namespace decaying {
 
-constexpr auto RANDOM_SEED = 100500;
+constexpr auto RANDOM_KEY = 100500;
 constexpr auto EPSILON = 150.0;
 
 template<typename Snapshot>
@@ -26,7 +28,7 @@ void dump_snapshot(std::ostream &o, const Snapshot &s) {
 }
 
 TEST(exponentially_t, Accumulate100OutOf1000Elements) {
-    exponentially_t accumulator(100, 0.99, std::chrono::milliseconds(10), RANDOM_SEED);
+    exponentially_t accumulator(100, 0.99, std::chrono::milliseconds(10), RANDOM_KEY);
 
     for (int i = 0; i < 1000; ++i) {
         accumulator.update(i);
@@ -49,7 +51,7 @@ TEST(exponentially_t, Accumulate100OutOf1000Elements) {
 }
 
 TEST(exponentially_t, empty) {
-    exponentially_t acc(1, 1e-10, std::chrono::milliseconds(1), RANDOM_SEED);
+    exponentially_t acc(1, 1e-10, std::chrono::milliseconds(1), RANDOM_KEY);
 
     const auto snapshot = acc.snapshot();
 
@@ -61,7 +63,7 @@ TEST(exponentially_t, empty) {
 }
 
 TEST(exponentially, const_fill_by_10k_vals) {
-    exponentially_t acc(10, 1e-10, std::chrono::milliseconds(100), RANDOM_SEED);
+    exponentially_t acc(10, 1e-10, std::chrono::milliseconds(100), RANDOM_KEY);
 
     constexpr int FILL_VALUE = 100500;
 
@@ -86,8 +88,97 @@ TEST(exponentially_t, wrong_ctor_args) {
     EXPECT_NO_THROW(exponentially_t(13, 10, std::chrono::hours(1)));
 }
 
+TEST(exponentially_t, RetainsEveryValueUntilFull) {
+    exponentially_t accumulator(1000, 0.015, std::chrono::hours(1), RANDOM_KEY);
+
+    for (int i = 0; i < 1000; ++i) {
+        accumulator.update(i);
+    }
+
+    EXPECT_EQ(1000, accumulator.size());
+
+    auto values = accumulator.snapshot().values();
+    std::sort(std::begin(values), std::end(values));
+    for (std::uint64_t i = 0; i < 1000; ++i) {
+        ASSERT_EQ(i, values[i]);
+    }
+}
+
+TEST(exponentially_t, BatchUpdate) {
+    exponentially_t accumulator(100, 0.015, std::chrono::hours(1), RANDOM_KEY);
+
+    std::vector<std::uint64_t> values(1000);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        values[i] = i;
+    }
+
+    accumulator.update(values.data(), 50);
+    EXPECT_EQ(50, accumulator.size());
+
+    accumulator.update(values.data() + 50, values.size() - 50);
+    EXPECT_EQ(100, accumulator.size());
+
+    auto sampled = accumulator.snapshot().values();
+    std::sort(std::begin(sampled), std::end(sampled));
+    EXPECT_EQ(std::end(sampled), std::unique(std::begin(sampled), std::end(sampled)));
+    EXPECT_LT(sampled.back(), 1000);
+}
+
+TEST(exponentially_t, PrefersRecentValues) {
+    const auto now = exponentially_t::clock_type::now();
+    exponentially_t accumulator(10, 1.0, std::chrono::hours(1), RANDOM_KEY);
+
+    for (int i = 0; i < 1000; ++i) {
+        accumulator.update(1, now);
+    }
+
+    // Recent values have a higher weight by a factor of e^10, so they always win the priority.
+    for (int i = 0; i < 10; ++i) {
+        accumulator.update(2, now + std::chrono::seconds(10));
+    }
+
+    EXPECT_EQ(10, accumulator.size());
+    EXPECT_FLOAT_EQ(2, accumulator.snapshot().min());
+}
+
+TEST(exponentially_t, WeightedUpdate) {
+    const auto now = exponentially_t::clock_type::now();
+    exponentially_t accumulator(10, 0.015, std::chrono::hours(1), RANDOM_KEY);
+
+    accumulator.update_n(1, 3, now);
+    accumulator.update(2, now);
+
+    // Weights are normalized, so the value recorded three times weighs three quarters.
+    const auto snapshot = accumulator.snapshot();
+    EXPECT_EQ(2, accumulator.size());
+    EXPECT_DOUBLE_EQ(1.25, snapshot.mean());
+}
+
+TEST(exponentially_t, ConcurrentUpdates) {
+    exponentially_t accumulator(100, 0.015, std::chrono::milliseconds(1), RANDOM_KEY);
+
+    std::vector<std::thread> threads;
+    for (int id = 0; id < 4; ++id) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 10000; ++i) {
+                accumulator.update(i % 1000);
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(100, accumulator.size());
+
+    const auto snapshot = accumulator.snapshot();
+    EXPECT_EQ(100, snapshot.size());
+    EXPECT_NEAR(snapshot.mean(), 500, EPSILON);
+}
+
 TEST(exponentially_t, rescale) {
-    exponentially_t accumulator(100, 0.05, std::chrono::milliseconds(10), RANDOM_SEED);
+    exponentially_t accumulator(100, 0.05, std::chrono::milliseconds(10), RANDOM_KEY);
 
     for (int i = 0; i < 1000; ++i) {
         if (i % 100 == 0) {
@@ -131,7 +222,7 @@ TEST_P(margins_test, marginal_cases_test) {
     std::mt19937 gen; // Defaults to seed = 5489u.
     std::normal_distribution<> norm{test.mean, test.stddev};
 
-    exponentially_t accumulator(test.size, test.alpha, std::chrono::milliseconds{5}, RANDOM_SEED);
+    exponentially_t accumulator(test.size, test.alpha, std::chrono::milliseconds{5}, RANDOM_KEY);
 
     for(int i = 0; i < 1000; ++i) {
         accumulator(std::fmod(std::abs(norm(gen)), 1000));
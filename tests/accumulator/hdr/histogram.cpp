@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <metrics/accumulator/hdr/histogram.hpp>
+
+namespace metrics {
+namespace testing {
+
+using accumulator::hdr::histogram_t;
+
+TEST(hdr_histogram_t, throws_on_invalid_parameters) {
+    EXPECT_THROW(histogram_t(0, 1000), std::invalid_argument);
+    EXPECT_THROW(histogram_t(6, 1000), std::invalid_argument);
+    EXPECT_THROW(histogram_t(2, 1), std::invalid_argument);
+}
+
+TEST(hdr_histogram_t, size) {
+    // 256 sub-buckets, 35 power-of-two ranges to cover one hour in nanoseconds.
+    EXPECT_EQ(36 * 128, histogram_t().size());
+    EXPECT_EQ(2 * 128, histogram_t(2, 255).size());
+    EXPECT_EQ(3 * 128, histogram_t(2, 256).size());
+}
+
+TEST(hdr_histogram_t, empty) {
+    histogram_t acc;
+
+    EXPECT_EQ(0, acc.snapshot().size());
+    EXPECT_EQ(0.0, acc.snapshot().p99());
+}
+
+TEST(hdr_histogram_t, small_values_are_exact) {
+    histogram_t acc;
+
+    for (std::uint64_t value = 0; value < 256; ++value) {
+        acc(value);
+    }
+
+    const auto snapshot = acc.snapshot();
+    EXPECT_EQ(256, snapshot.size());
+    EXPECT_EQ(256, snapshot.buckets().size());
+    EXPECT_EQ(0, snapshot.min());
+    EXPECT_EQ(255, snapshot.max());
+    EXPECT_DOUBLE_EQ(127.5, snapshot.mean());
+    EXPECT_EQ(127.0, snapshot.median());
+}
+
+TEST(hdr_histogram_t, relative_error) {
+    const std::uint64_t values[] = {1000, 12345, 999999, 123456789, 3000000000000ULL};
+    for (auto value : values) {
+        histogram_t single(2, 3600ULL * 1000 * 1000 * 1000);
+        single(value);
+
+        const auto estimate = single.snapshot().value(0.5);
+        EXPECT_NEAR(value, estimate, value * 0.01);
+        EXPECT_DOUBLE_EQ(value, single.snapshot().mean());
+    }
+}
+
+TEST(hdr_histogram_t, quantiles) {
+    histogram_t acc;
+
+    for (std::uint64_t value = 1; value <= 100000; ++value) {
+        acc(value * 1000);
+    }
+
+    const auto snapshot = acc.snapshot();
+    EXPECT_EQ(100000, snapshot.size());
+    EXPECT_NEAR(50000000, snapshot.median(), 50000000 * 0.01);
+    EXPECT_NEAR(99000000, snapshot.p99(), 99000000 * 0.01);
+    EXPECT_NEAR(99900000, snapshot.p999(), 99900000 * 0.01);
+    EXPECT_NEAR(50000500, snapshot.mean(), 1.0);
+}
+
+TEST(hdr_histogram_t, saturates_on_overflow) {
+    histogram_t acc(2, 1000);
+
+    acc(100000);
+
+    const auto snapshot = acc.snapshot();
+    EXPECT_EQ(1, snapshot.size());
+    EXPECT_NEAR(1000, snapshot.max(), 10);
+}
+
+TEST(hdr_histogram_t, concurrent_updates) {
+    histogram_t acc;
+
+    std::vector<std::thread> threads;
+    for (int id = 0; id < 4; ++id) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 10000; ++i) {
+                acc(i);
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(40000, acc.snapshot().size());
+}
+
+TEST(hdr_histogram_t, reset) {
+    histogram_t acc(2, 1000);
+
+    acc(10);
+    acc(20);
+    acc.reset();
+
+    EXPECT_EQ(0, acc.snapshot().size());
+    EXPECT_EQ(0.0, acc.snapshot().mean());
+
+    acc(30);
+    EXPECT_EQ(1, acc.snapshot().size());
+    EXPECT_EQ(30, acc.snapshot().max());
+}
+
+TEST(hdr_histogram_t, batch_update) {
+    histogram_t single(2, 1000000);
+    histogram_t batch(2, 1000000);
+
+    // Covers all ranges including saturated values and is not a multiple of the vector width.
+    std::vector<std::uint64_t> values;
+    for (std::uint64_t value = 0; value < 2000000; value = value * 3 / 2 + 1) {
+        values.push_back(value);
+        values.push_back(value);
+    }
+    values.push_back(std::numeric_limits<std::uint64_t>::max());
+
+    for (auto value : values) {
+        single.update(value);
+    }
+    batch.update(values.data(), values.size());
+
+    EXPECT_EQ(single.snapshot().buckets(), batch.snapshot().buckets());
+    EXPECT_DOUBLE_EQ(single.snapshot().mean(), batch.snapshot().mean());
+}
+
+TEST(hdr_histogram_t, weighted_update) {
+    histogram_t single(2, 1000000);
+    histogram_t weighted(2, 1000000);
+
+    for (int i = 0; i < 3; ++i) {
+        single.update(42);
+        single.update(2000000);
+    }
+
+    weighted.update_n(42, 3);
+    weighted.update_n(2000000, 3);
+
+    EXPECT_EQ(6, weighted.snapshot().size());
+    EXPECT_EQ(single.snapshot().buckets(), weighted.snapshot().buckets());
+    EXPECT_DOUBLE_EQ(single.snapshot().mean(), weighted.snapshot().mean());
+}
+
+}  // namespace testing
+}  // namespace metrics
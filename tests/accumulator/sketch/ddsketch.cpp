@@ -0,0 +1,229 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <metrics/accumulator/sketch/ddsketch.hpp>
+
+namespace metrics {
+namespace testing {
+
+using accumulator::sketch::ddsketch_t;
+
+TEST(ddsketch_t, throws_on_invalid_parameters) {
+    EXPECT_THROW(ddsketch_t(0.0, 2048), std::invalid_argument);
+    EXPECT_THROW(ddsketch_t(1.0, 2048), std::invalid_argument);
+    EXPECT_THROW(ddsketch_t(0.01, 0), std::invalid_argument);
+}
+
+TEST(ddsketch_t, empty) {
+    ddsketch_t acc;
+
+    const auto snapshot = acc.snapshot();
+
+    EXPECT_EQ(0, acc.size());
+    EXPECT_EQ(0, snapshot.size());
+    EXPECT_EQ(0.0, snapshot.p99());
+}
+
+TEST(ddsketch_t, zero) {
+    ddsketch_t acc;
+
+    acc(0);
+    acc(0);
+    acc(100);
+
+    const auto snapshot = acc.snapshot();
+
+    EXPECT_EQ(3, snapshot.size());
+    EXPECT_EQ(0, snapshot.min());
+    EXPECT_EQ(0.0, snapshot.median());
+}
+
+TEST(ddsketch_t, batch_update) {
+    ddsketch_t single;
+    ddsketch_t batch;
+
+    std::vector<std::uint64_t> values;
+    for (std::uint64_t value = 0; value < 1000000000; value = value * 3 / 2 + 1) {
+        values.push_back(value);
+        values.push_back(0);
+    }
+
+    for (auto value : values) {
+        single.update(value);
+    }
+    batch.update(values.data(), values.size());
+
+    EXPECT_EQ(single.size(), batch.size());
+    EXPECT_EQ(single.snapshot().buckets(), batch.snapshot().buckets());
+    EXPECT_DOUBLE_EQ(single.snapshot().mean(), batch.snapshot().mean());
+}
+
+TEST(ddsketch_t, weighted_update) {
+    ddsketch_t single;
+    ddsketch_t weighted;
+
+    for (int i = 0; i < 3; ++i) {
+        single.update(0);
+        single.update(1000);
+    }
+
+    weighted.update_n(0, 3);
+    weighted.update_n(1000, 3);
+
+    EXPECT_EQ(6, weighted.size());
+    EXPECT_EQ(single.snapshot().buckets(), weighted.snapshot().buckets());
+    EXPECT_DOUBLE_EQ(single.snapshot().mean(), weighted.snapshot().mean());
+}
+
+TEST(ddsketch_t, relative_error) {
+    ddsketch_t acc(0.01, 2048);
+
+    for (std::uint64_t value = 1; value <= 100000; ++value) {
+        acc(value * 1000);
+    }
+
+    const auto snapshot = acc.snapshot();
+
+    EXPECT_EQ(100000, snapshot.size());
+    EXPECT_DOUBLE_EQ(50000.5 * 1000, snapshot.mean());
+
+    const double quantiles[] = {0.0, 0.25, 0.5, 0.75, 0.9, 0.99, 0.999, 1.0};
+    for (auto quantile : quantiles) {
+        const auto expected = std::max(1.0, std::ceil(quantile * 100000)) * 1000;
+        EXPECT_NEAR(expected, snapshot.value(quantile), expected * 0.01) << quantile;
+    }
+}
+
+TEST(ddsketch_t, collapses_lowest_buckets) {
+    ddsketch_t acc(0.01, 100);
+
+    for (std::uint64_t value = 1; value <= 1000000; value *= 10) {
+        acc(value);
+    }
+
+    const auto snapshot = acc.snapshot();
+
+    // The highest values are still accurate, while low ones are collapsed together.
+    EXPECT_EQ(7, snapshot.size());
+    EXPECT_NEAR(1000000, snapshot.max(), 10000);
+    EXPECT_GT(snapshot.min(), 10);
+    EXPECT_LE(snapshot.buckets().size(), 100);
+}
+
+TEST(ddsketch_t, merge) {
+    ddsketch_t lhs;
+    ddsketch_t rhs;
+    ddsketch_t all;
+
+    for (std::uint64_t value = 1; value <= 1000; ++value) {
+        (value % 2 == 0 ? lhs : rhs)(value);
+        all(value);
+    }
+
+    lhs.merge(rhs);
+
+    EXPECT_EQ(all.snapshot().buckets(), lhs.snapshot().buckets());
+    EXPECT_DOUBLE_EQ(all.snapshot().mean(), lhs.snapshot().mean());
+}
+
+TEST(ddsketch_t, merge_into_itself) {
+    ddsketch_t acc;
+
+    acc(0);
+    acc(42);
+    acc.merge(acc);
+
+    EXPECT_EQ(4, acc.size());
+}
+
+TEST(ddsketch_t, throws_on_merging_different_accuracy) {
+    ddsketch_t lhs(0.01, 2048);
+    ddsketch_t rhs(0.02, 2048);
+
+    EXPECT_THROW(lhs.merge(rhs), std::invalid_argument);
+}
+
+TEST(ddsketch_t, encode_decode) {
+    ddsketch_t acc(0.02, 512);
+
+    acc(0);
+    for (std::uint64_t value = 1; value <= 1000; ++value) {
+        acc(value * value);
+    }
+
+    const auto data = acc.encode();
+    const auto result = ddsketch_t::decode(data);
+
+    EXPECT_DOUBLE_EQ(0.02, result.accuracy());
+    EXPECT_EQ(512, result.max_bins());
+    EXPECT_EQ(acc.snapshot().buckets(), result.snapshot().buckets());
+    EXPECT_DOUBLE_EQ(acc.snapshot().mean(), result.snapshot().mean());
+
+    // Counts are varint-encoded, so the encoding is compact.
+    EXPECT_LT(data.size(), 2 * result.snapshot().buckets().size() + 32);
+}
+
+TEST(ddsketch_t, throws_on_decoding_malformed_data) {
+    ddsketch_t acc;
+    acc(42);
+
+    const auto data = acc.encode();
+
+    EXPECT_THROW(ddsketch_t::decode(""), std::invalid_argument);
+    EXPECT_THROW(ddsketch_t::decode(std::string("\x02", 1) + data.substr(1)), std::invalid_argument);
+    EXPECT_THROW(ddsketch_t::decode(data.substr(0, data.size() - 1)), std::invalid_argument);
+    EXPECT_THROW(ddsketch_t::decode(data + '\0'), std::invalid_argument);
+}
+
+TEST(ddsketch_t, throws_on_decoding_oversized_data) {
+    ddsketch_t acc;
+    acc(42);
+
+    const auto data = acc.encode();
+
+    // Version, accuracy and varints of max bins, zero count, sum and offset.
+    const auto header = data.substr(0, 9);
+    const std::string bins("\x80\x80\x04", 3);
+    const std::string one("\x01", 1);
+    const std::string two("\x02", 1);
+
+    // Maximum number of buckets of 2^16 + 1.
+    EXPECT_THROW(ddsketch_t::decode(header + std::string("\x81\x80\x04", 3) + data.substr(11)),
+        std::invalid_argument);
+    // 2^16 buckets at offset 1 without the data.
+    EXPECT_THROW(ddsketch_t::decode(header + bins + one + one + two + bins + one), std::invalid_argument);
+    // Offset of 2^20, which is far beyond the highest key.
+    EXPECT_THROW(ddsketch_t::decode(header + bins + one + one + std::string("\x80\x80\x80\x01", 4) + one + one),
+        std::invalid_argument);
+    // Negative offset of -1.
+    EXPECT_THROW(ddsketch_t::decode(header + bins + one + one + one + one + one), std::invalid_argument);
+    // The same, but valid.
+    EXPECT_NO_THROW(ddsketch_t::decode(header + bins + one + one + two + one + one));
+}
+
+TEST(ddsketch_t, concurrent_updates) {
+    ddsketch_t acc;
+
+    std::vector<std::thread> threads;
+    for (int id = 0; id < 4; ++id) {
+        threads.emplace_back([&] {
+            for (std::uint64_t value = 0; value < 10000; ++value) {
+                acc(value);
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(40000, acc.size());
+}
+
+}  // namespace testing
+}  // namespace metrics
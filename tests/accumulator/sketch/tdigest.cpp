@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <metrics/accumulator/sketch/tdigest.hpp>
+
+namespace metrics {
+namespace testing {
+
+using accumulator::sketch::tdigest_t;
+
+TEST(tdigest_t, throws_on_invalid_parameters) {
+    EXPECT_THROW(tdigest_t(0.5, 512), std::invalid_argument);
+    EXPECT_THROW(tdigest_t(100, 0), std::invalid_argument);
+}
+
+TEST(tdigest_t, empty) {
+    tdigest_t acc;
+
+    const auto snapshot = acc.snapshot();
+
+    EXPECT_EQ(0, snapshot.size());
+    EXPECT_EQ(0.0, snapshot.p99());
+}
+
+TEST(tdigest_t, buffered_values) {
+    tdigest_t acc(100, 512);
+
+    acc(1);
+    acc(2);
+    acc(3);
+
+    const auto snapshot = acc.snapshot();
+
+    EXPECT_EQ(3, snapshot.size());
+    EXPECT_EQ(1, snapshot.min());
+    EXPECT_EQ(3, snapshot.max());
+    EXPECT_DOUBLE_EQ(2.0, snapshot.mean());
+}
+
+TEST(tdigest_t, batch_update) {
+    tdigest_t acc(100, 4);
+
+    // Fills the buffer partially, then overflows it, absorbing the rest directly.
+    const std::vector<std::uint64_t> values{5, 1, 4, 2, 3, 9, 7};
+    acc.update(values.data(), 2);
+    acc.update(values.data() + 2, values.size() - 2);
+
+    const auto snapshot = acc.snapshot();
+
+    EXPECT_EQ(7, snapshot.size());
+    EXPECT_EQ(1, snapshot.min());
+    EXPECT_EQ(9, snapshot.max());
+    EXPECT_DOUBLE_EQ(31.0 / 7, snapshot.mean());
+}
+
+TEST(tdigest_t, weighted_update) {
+    tdigest_t acc(100, 2);
+
+    // The third weighted value fills the pending ones up to the buffer size, which compresses
+    // them into the digest, while the last one is still pending.
+    acc.update_n(10, 3);
+    acc.update_n(20, 1);
+    acc.update_n(30, 2);
+    acc.update_n(40, 4);
+    acc.update_n(50, 10);
+
+    const auto snapshot = acc.snapshot();
+
+    EXPECT_EQ(20, snapshot.size());
+    EXPECT_EQ(10, snapshot.min());
+    EXPECT_EQ(50, snapshot.max());
+    EXPECT_DOUBLE_EQ(770.0 / 20, snapshot.mean());
+}
+
+TEST(tdigest_t, bounded_size) {
+    tdigest_t acc(100, 64);
+
+    for (std::uint64_t value = 0; value < 100000; ++value) {
+        acc(value);
+    }
+
+    const auto snapshot = acc.snapshot();
+
+    EXPECT_EQ(100000, snapshot.size());
+    EXPECT_LE(snapshot.centroids().size(), 2 * 100);
+    EXPECT_NEAR(49999.5, snapshot.mean(), 1e-6 * 49999.5);
+}
+
+TEST(tdigest_t, tail_quantiles) {
+    tdigest_t acc;
+
+    std::mt19937 gen(100500);
+    std::exponential_distribution<> dist(1e-6);
+
+    std::vector<std::uint64_t> values;
+    for (int id = 0; id < 1000000; ++id) {
+        values.push_back(static_cast<std::uint64_t>(dist(gen)));
+        acc(values.back());
+    }
+
+    std::sort(values.begin(), values.end());
+
+    const auto snapshot = acc.snapshot();
+
+    EXPECT_EQ(values.front(), snapshot.min());
+    EXPECT_EQ(values.back(), snapshot.max());
+
+    const double quantiles[] = {0.5, 0.9, 0.99, 0.999, 0.9999};
+    for (auto quantile : quantiles) {
+        const auto expected = static_cast<double>(values[static_cast<std::size_t>(quantile * values.size())]);
+        EXPECT_NEAR(expected, snapshot.value(quantile), expected * 0.01) << quantile;
+        EXPECT_NEAR(quantile, snapshot.phi(expected), (1 - quantile) * 0.1) << quantile;
+    }
+}
+
+TEST(tdigest_t, merge) {
+    tdigest_t lhs;
+    tdigest_t rhs;
+
+    std::vector<std::uint64_t> values;
+    for (std::uint64_t value = 0; value < 10000; ++value) {
+        values.push_back(value);
+    }
+
+    std::shuffle(values.begin(), values.end(), std::mt19937(100500));
+
+    for (auto value : values) {
+        (value < 5000 ? lhs : rhs)(value);
+    }
+
+    lhs.merge(rhs);
+
+    const auto snapshot = lhs.snapshot();
+
+    EXPECT_EQ(10000, snapshot.size());
+    EXPECT_EQ(0, snapshot.min());
+    EXPECT_EQ(9999, snapshot.max());
+    EXPECT_NEAR(5000, snapshot.median(), 50);
+    EXPECT_NEAR(9990, snapshot.p999(), 10);
+}
+
+TEST(tdigest_t, merge_into_itself) {
+    tdigest_t acc(100, 4);
+
+    for (std::uint64_t value = 0; value < 10; ++value) {
+        acc(value);
+    }
+
+    acc.merge(acc);
+
+    EXPECT_EQ(20, acc.snapshot().size());
+}
+
+TEST(tdigest_t, concurrent_updates) {
+    tdigest_t acc(100, 64);
+
+    std::vector<std::thread> threads;
+    for (int id = 0; id < 4; ++id) {
+        threads.emplace_back([&] {
+            for (std::uint64_t value = 0; value < 10000; ++value) {
+                acc(value);
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const auto snapshot = acc.snapshot();
+
+    EXPECT_EQ(40000, snapshot.size());
+    EXPECT_EQ(9999, snapshot.max());
+}
+
+}  // namespace testing
+}  // namespace metrics
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <metrics/accumulator/sliding/time_window.hpp>
+
+namespace metrics {
+namespace testing {
+
+using accumulator::sliding::time_window_t;
+
+namespace {
+
+const auto highest = 1000 * 1000;
+
+}  // namespace
+
+TEST(time_window_t, empty) {
+    time_window_t acc(std::chrono::seconds(10), 2, highest);
+
+    const auto snapshot = acc.snapshot();
+
+    EXPECT_EQ(0, snapshot.size());
+    EXPECT_EQ(0, snapshot.max());
+    EXPECT_EQ(std::chrono::seconds(10), acc.window());
+}
+
+TEST(time_window_t, throws_on_empty_window) {
+    EXPECT_THROW(time_window_t(std::chrono::seconds(0), 2, highest), std::invalid_argument);
+}
+
+TEST(time_window_t, throws_on_invalid_sub_histograms) {
+    EXPECT_THROW(time_window_t(std::chrono::seconds(10), 0, highest), std::invalid_argument);
+    EXPECT_THROW(time_window_t(std::chrono::seconds(10), 2, 1), std::invalid_argument);
+}
+
+TEST(time_window_t, default_window) {
+    time_window_t acc;
+    const auto now = time_window_t::clock_type::now();
+
+    acc.update(1000, now);
+
+    EXPECT_EQ(std::chrono::seconds(10), acc.window());
+    EXPECT_EQ(1, acc.snapshot(now).size());
+    EXPECT_EQ(0, acc.snapshot(now + std::chrono::seconds(10)).size());
+}
+
+TEST(time_window_t, merges_live_seconds) {
+    time_window_t acc(std::chrono::seconds(10), 2, highest);
+    const auto now = time_window_t::clock_type::now();
+
+    acc.update(10, now);
+    acc.update(20, now + std::chrono::seconds(1));
+    acc.update(30, now + std::chrono::seconds(2));
+
+    const auto snapshot = acc.snapshot(now + std::chrono::seconds(2));
+
+    EXPECT_EQ(3, snapshot.size());
+    EXPECT_EQ(10, snapshot.min());
+    EXPECT_EQ(30, snapshot.max());
+    EXPECT_DOUBLE_EQ(20.0, snapshot.mean());
+}
+
+TEST(time_window_t, batch_update) {
+    time_window_t acc(std::chrono::seconds(10), 2, highest);
+    const auto now = time_window_t::clock_type::now();
+
+    const std::vector<std::uint64_t> values{10, 20, 30};
+    acc.update(values.data(), values.size(), now);
+    acc.update(values.data(), values.size(), now - std::chrono::seconds(10));
+
+    const auto snapshot = acc.snapshot(now);
+
+    EXPECT_EQ(3, snapshot.size());
+    EXPECT_EQ(10, snapshot.min());
+    EXPECT_EQ(30, snapshot.max());
+    EXPECT_DOUBLE_EQ(20.0, snapshot.mean());
+}
+
+TEST(time_window_t, weighted_update) {
+    time_window_t acc(std::chrono::seconds(10), 2, highest);
+    const auto now = time_window_t::clock_type::now();
+
+    acc.update_n(10, 3, now);
+    acc.update_n(30, 1, now - std::chrono::seconds(1));
+
+    const auto snapshot = acc.snapshot(now);
+
+    EXPECT_EQ(4, snapshot.size());
+    EXPECT_EQ(10, snapshot.min());
+    EXPECT_EQ(30, snapshot.max());
+    EXPECT_DOUBLE_EQ(15.0, snapshot.mean());
+}
+
+TEST(time_window_t, forgets_expired_seconds) {
+    time_window_t acc(std::chrono::seconds(10), 2, highest);
+    const auto now = time_window_t::clock_type::now();
+
+    acc.update(10, now);
+    acc.update(20, now + std::chrono::seconds(5));
+
+    EXPECT_EQ(2, acc.snapshot(now + std::chrono::seconds(9)).size());
+    EXPECT_EQ(1, acc.snapshot(now + std::chrono::seconds(10)).size());
+    EXPECT_EQ(0, acc.snapshot(now + std::chrono::seconds(15)).size());
+
+    // The slot of the first second is reused on the next lap.
+    acc.update(30, now + std::chrono::seconds(10));
+
+    const auto snapshot = acc.snapshot(now + std::chrono::seconds(10));
+    EXPECT_EQ(2, snapshot.size());
+    EXPECT_EQ(20, snapshot.min());
+    EXPECT_EQ(30, snapshot.max());
+}
+
+TEST(time_window_t, ignores_values_from_previous_laps) {
+    time_window_t acc(std::chrono::seconds(10), 2, highest);
+    const auto now = time_window_t::clock_type::now();
+
+    acc.update(10, now + std::chrono::seconds(10));
+    acc.update(20, now);
+
+    const auto snapshot = acc.snapshot(now + std::chrono::seconds(10));
+    EXPECT_EQ(1, snapshot.size());
+    EXPECT_EQ(10, snapshot.max());
+}
+
+TEST(time_window_t, concurrent_updates) {
+    time_window_t acc(std::chrono::seconds(10), 2, highest);
+    const auto now = time_window_t::clock_type::now();
+
+    std::vector<std::thread> threads;
+    for (int id = 0; id < 4; ++id) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 10000; ++i) {
+                acc.update(100, now + std::chrono::seconds(i % 3));
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(40000, acc.snapshot(now + std::chrono::seconds(2)).size());
+}
+
+}  // namespace testing
+}  // namespace metrics
@@ -1,11 +1,50 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
 #include <metrics/accumulator/sliding/window.hpp>
 
 namespace metrics {
+namespace accumulator {
+namespace sliding {
+
+struct window_access {
+    /// Claims a slot without storing into it, returning the claim sequence number.
+    static auto claim(window_t& acc) -> std::size_t {
+        return acc.count.fetch_add(1);
+    }
+
+    static auto store(window_t& acc, std::size_t id, std::uint64_t value) -> void {
+        acc.store(id, value);
+    }
+
+    /// Returns the current slot values sorted, bypassing the snapshot cache.
+    static auto contents(const window_t& acc) -> std::vector<std::uint64_t> {
+        std::vector<std::uint64_t> result;
+        for (const auto& measurement : acc.measurements) {
+            result.push_back(measurement.load());
+        }
+
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    static auto cached(const window_t& acc) -> bool {
+        return acc.cache != nullptr;
+    }
+};
+
+}  // namespace sliding
+}  // namespace accumulator
+
 namespace testing {
 
 using accumulator::sliding::window_t;
+using accumulator::sliding::window_access;
 
 TEST(window_t, small) {
     window_t acc(3);
@@ -28,5 +67,158 @@ TEST(window_t, keep_most_recent) {
     EXPECT_EQ(std::vector<std::uint64_t>({2, 3, 4}), acc.snapshot().values());
 }
 
+TEST(window_t, keeps_highest_value) {
+    window_t acc(4);
+
+    const auto highest = std::numeric_limits<std::uint64_t>::max();
+    acc(1);
+    acc(highest);
+
+    EXPECT_EQ(std::vector<std::uint64_t>({1, highest}), acc.snapshot().values());
+
+    acc(highest);
+    EXPECT_EQ(std::vector<std::uint64_t>({1, highest, highest}), acc.snapshot().values());
+}
+
+TEST(window_t, batch_update) {
+    window_t acc(100);
+
+    std::vector<std::uint64_t> values(250);
+    for (std::size_t id = 0; id < values.size(); ++id) {
+        values[id] = id;
+    }
+
+    acc.update(values.data(), values.size());
+
+    EXPECT_EQ(100, acc.size());
+    EXPECT_EQ(std::vector<std::uint64_t>(values.end() - 100, values.end()), acc.snapshot().values());
+}
+
+TEST(window_t, concurrent_updates) {
+    window_t acc(1024);
+
+    std::vector<std::thread> threads;
+    for (int id = 0; id < 4; ++id) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 10000; ++i) {
+                acc(42);
+            }
+        });
+    }
+
+    for (int i = 0; i < 100; ++i) {
+        for (auto value : acc.snapshot().values()) {
+            EXPECT_EQ(42, value);
+        }
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(1024, acc.size());
+    EXPECT_EQ(std::vector<std::uint64_t>(1024, 42), acc.snapshot().values());
+}
+
+TEST(window_t, stalled_writer) {
+    window_t acc(128);
+
+    for (std::uint64_t value = 0; value < 128; ++value) {
+        acc(value);
+    }
+    acc.snapshot();
+
+    // A writer claims the first slot of the second lap, but stalls before storing into it, while
+    // the window moves far beyond the patching range.
+    const auto id = window_access::claim(acc);
+    for (std::uint64_t value = 1000; value < 1100; ++value) {
+        acc(value);
+        acc.snapshot();
+    }
+
+    window_access::store(acc, id, 42);
+
+    EXPECT_EQ(window_access::contents(acc), acc.snapshot().values());
+}
+
+TEST(window_t, concurrent_snapshots_match_final_contents) {
+    window_t acc(256);
+
+    // Distinct values, so that any stale slot in the snapshot is noticed. Both single and batch
+    // writers race with snapshots, which mostly patch the small window.
+    std::vector<std::thread> threads;
+    for (std::uint64_t id = 0; id < 4; ++id) {
+        threads.emplace_back([&acc, id] {
+            std::vector<std::uint64_t> batch(3);
+            for (std::uint64_t i = 0; i < 20000; ++i) {
+                if (id % 2 == 0) {
+                    acc(id * 1000000 + i);
+                } else {
+                    for (std::uint64_t offset = 0; offset < batch.size(); ++offset) {
+                        batch[offset] = id * 1000000 + i * batch.size() + offset;
+                    }
+                    acc.update(batch.data(), batch.size());
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i < 2000; ++i) {
+        EXPECT_GE(256, acc.snapshot().size());
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(window_access::contents(acc), acc.snapshot().values());
+}
+
+TEST(window_t, lazy_cache) {
+    window_t acc(16);
+
+    acc(1);
+    EXPECT_FALSE(window_access::cached(acc));
+
+    acc.snapshot();
+    EXPECT_TRUE(window_access::cached(acc));
+}
+
+TEST(window_t, cached_snapshot) {
+    window_t acc(16);
+
+    acc(2);
+    acc(1);
+
+    const auto first = acc.snapshot();
+    const auto second = acc.snapshot();
+
+    EXPECT_EQ(&first.values(), &second.values());
+    EXPECT_EQ(std::vector<std::uint64_t>({1, 2}), second.values());
+
+    acc(3);
+
+    const auto third = acc.snapshot();
+    EXPECT_EQ(std::vector<std::uint64_t>({1, 2}), first.values());
+    EXPECT_EQ(std::vector<std::uint64_t>({1, 2, 3}), third.values());
+}
+
+TEST(window_t, patched_snapshot) {
+    window_t acc(1024);
+
+    std::mt19937 gen(100500);
+    std::uniform_int_distribution<std::uint64_t> dist(0, 100);
+
+    // Both small changes, which are patched, and large ones, which are sorted from scratch.
+    const std::size_t steps[] = {3000, 1, 10, 100, 64, 500, 7, 2048, 128};
+    for (auto step : steps) {
+        for (std::size_t id = 0; id < step; ++id) {
+            acc(dist(gen));
+        }
+
+        ASSERT_EQ(window_access::contents(acc), acc.snapshot().values()) << step;
+    }
+}
+
 }  // namespace testing
 }  // namespace metrics
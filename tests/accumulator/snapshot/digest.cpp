@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <stdexcept>
+
+#include <metrics/accumulator/snapshot/digest.hpp>
+
+namespace metrics {
+namespace testing {
+
+using accumulator::snapshot::digest_t;
+
+TEST(digest_t, empty) {
+    digest_t snapshot({}, 0, 0);
+
+    EXPECT_EQ(0, snapshot.size());
+    EXPECT_EQ(0, snapshot.min());
+    EXPECT_EQ(0, snapshot.max());
+    EXPECT_EQ(0.0, snapshot.mean());
+    EXPECT_EQ(0.0, snapshot.value(0.5));
+    EXPECT_EQ(0.0, snapshot.phi(42));
+}
+
+TEST(digest_t, statistics) {
+    digest_t snapshot({{10, 1}, {20, 2}, {30, 1}}, 10, 30);
+
+    EXPECT_EQ(4, snapshot.size());
+    EXPECT_EQ(10, snapshot.min());
+    EXPECT_EQ(30, snapshot.max());
+    EXPECT_DOUBLE_EQ(20.0, snapshot.mean());
+    EXPECT_NEAR(7.071, snapshot.stddev(), 1e-3);
+}
+
+TEST(digest_t, interpolates_quantiles) {
+    digest_t snapshot({{10, 2}, {20, 2}}, 0, 40);
+
+    EXPECT_DOUBLE_EQ(0.0, snapshot.value(0.0));
+    EXPECT_DOUBLE_EQ(5.0, snapshot.value(0.125));
+    EXPECT_DOUBLE_EQ(10.0, snapshot.value(0.25));
+    EXPECT_DOUBLE_EQ(15.0, snapshot.median());
+    EXPECT_DOUBLE_EQ(20.0, snapshot.p75());
+    EXPECT_DOUBLE_EQ(40.0, snapshot.value(1.0));
+}
+
+TEST(digest_t, phi_is_inverse_of_value) {
+    digest_t snapshot({{10, 2}, {20, 2}}, 0, 40);
+
+    EXPECT_DOUBLE_EQ(0.0, snapshot.phi(-1));
+    EXPECT_DOUBLE_EQ(0.125, snapshot.phi(5));
+    EXPECT_DOUBLE_EQ(0.25, snapshot.phi(10));
+    EXPECT_DOUBLE_EQ(0.5, snapshot.phi(15));
+    EXPECT_DOUBLE_EQ(0.875, snapshot.phi(30));
+    EXPECT_DOUBLE_EQ(1.0, snapshot.phi(40));
+}
+
+TEST(digest_t, throws_on_invalid_quantile) {
+    digest_t snapshot({{1, 1}}, 1, 1);
+
+    EXPECT_THROW(snapshot.value(std::numeric_limits<double>::quiet_NaN()), std::invalid_argument);
+    EXPECT_THROW(snapshot.value(-0.5), std::invalid_argument);
+    EXPECT_THROW(snapshot.value(1.5), std::invalid_argument);
+}
+
+}  // namespace testing
+}  // namespace metrics
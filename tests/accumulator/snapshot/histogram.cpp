@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <metrics/accumulator/snapshot/histogram.hpp>
+
+namespace metrics {
+namespace testing {
+
+using accumulator::snapshot::histogram_t;
+
+TEST(histogram_t, empty) {
+    histogram_t snapshot({});
+
+    EXPECT_EQ(0, snapshot.size());
+    EXPECT_EQ(0, snapshot.min());
+    EXPECT_EQ(0, snapshot.max());
+    EXPECT_EQ(0.0, snapshot.mean());
+    EXPECT_EQ(0.0, snapshot.stddev());
+    EXPECT_EQ(0.0, snapshot.value(0.5));
+}
+
+TEST(histogram_t, statistics) {
+    histogram_t snapshot({{1, 1}, {2, 2}, {3, 1}});
+
+    EXPECT_EQ(4, snapshot.size());
+    EXPECT_EQ(1, snapshot.min());
+    EXPECT_EQ(3, snapshot.max());
+    EXPECT_DOUBLE_EQ(2.0, snapshot.mean());
+    EXPECT_NEAR(0.8165, snapshot.stddev(), 1e-3);
+}
+
+TEST(histogram_t, exact_sum) {
+    histogram_t snapshot({{10, 2}}, 21);
+
+    EXPECT_DOUBLE_EQ(10.5, snapshot.mean());
+}
+
+TEST(histogram_t, quantiles) {
+    histogram_t snapshot({{1, 1}, {2, 2}, {3, 1}, {100, 1}});
+
+    EXPECT_EQ(1.0, snapshot.value(0.0));
+    EXPECT_EQ(1.0, snapshot.value(0.2));
+    EXPECT_EQ(2.0, snapshot.value(0.5));
+    EXPECT_EQ(3.0, snapshot.value(0.8));
+    EXPECT_EQ(100.0, snapshot.p99());
+    EXPECT_EQ(100.0, snapshot.value(1.0));
+}
+
+TEST(histogram_t, merge) {
+    histogram_t snapshot({{1, 1}, {3, 1}}, 4);
+    snapshot.merge(histogram_t({{2, 2}, {3, 1}, {5, 1}}, 12));
+
+    const std::vector<histogram_t::bucket_type> expected{{1, 1}, {2, 2}, {3, 2}, {5, 1}};
+    EXPECT_EQ(expected, snapshot.buckets());
+    EXPECT_EQ(6, snapshot.size());
+    EXPECT_DOUBLE_EQ(16.0 / 6, snapshot.mean());
+}
+
+TEST(histogram_t, throws_on_invalid_quantile) {
+    histogram_t snapshot({{1, 1}});
+
+    EXPECT_THROW(snapshot.value(std::numeric_limits<double>::quiet_NaN()), std::invalid_argument);
+    EXPECT_THROW(snapshot.value(-0.5), std::invalid_argument);
+    EXPECT_THROW(snapshot.value(1.5), std::invalid_argument);
+}
+
+}  // namespace testing
+}  // namespace metrics
@@ -1,7 +1,11 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <limits>
+#include <random>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 
 #include <metrics/accumulator/snapshot/uniform.hpp>
 
@@ -142,5 +146,77 @@ TEST(uniform_t, stddev_on_singleton) {
     EXPECT_NEAR(0.0, snapshot.stddev(), 1e-6);
 }
 
+TEST(uniform_t, lazy_values) {
+    uniform_t snapshot({5, 1, 3, 2, 4});
+
+    EXPECT_EQ(5, snapshot.size());
+    EXPECT_EQ(1, snapshot.min());
+    EXPECT_EQ(5, snapshot.max());
+    EXPECT_DOUBLE_EQ(3.0, snapshot.mean());
+    EXPECT_NEAR(1.5811, snapshot.stddev(), 1e-3);
+    EXPECT_NEAR(3, snapshot.median(), 1e-3);
+
+    EXPECT_EQ(std::vector<std::uint64_t>({1, 2, 3, 4, 5}), snapshot.values());
+    EXPECT_NEAR(3, snapshot.median(), 1e-3);
+}
+
+TEST(uniform_t, sorted) {
+    uniform_t snapshot(uniform_t::sorted_t(), {1, 2, 3, 4, 5});
+
+    EXPECT_EQ(1, snapshot.min());
+    EXPECT_EQ(5, snapshot.max());
+    EXPECT_NEAR(3, snapshot.median(), 1e-3);
+    EXPECT_EQ(std::vector<std::uint64_t>({1, 2, 3, 4, 5}), snapshot.values());
+}
+
+TEST(uniform_t, selection_matches_sorting) {
+    std::mt19937 gen(100500);
+    std::uniform_int_distribution<std::uint64_t> dist(0, 1000);
+
+    std::vector<std::uint64_t> values;
+    for (int id = 0; id < 10000; ++id) {
+        values.push_back(dist(gen));
+    }
+
+    uniform_t selected(values);
+    std::sort(values.begin(), values.end());
+    uniform_t sorted(uniform_t::sorted_t(), values);
+
+    const std::vector<double> quantiles{0.99, 0.0, 0.5, 0.999, 0.75, 0.25, 0.9, 1.0, 0.5};
+
+    const auto result = selected.value(quantiles);
+    ASSERT_EQ(quantiles.size(), result.size());
+
+    for (std::size_t id = 0; id < quantiles.size(); ++id) {
+        EXPECT_DOUBLE_EQ(sorted.value(quantiles[id]), result[id]) << quantiles[id];
+        EXPECT_DOUBLE_EQ(sorted.value(quantiles[id]), selected.value(quantiles[id])) << quantiles[id];
+    }
+
+    EXPECT_EQ(values, selected.values());
+}
+
+TEST(uniform_t, concurrent_quantiles) {
+    std::vector<std::uint64_t> values;
+    for (std::uint64_t value = 0; value < 10000; ++value) {
+        values.push_back((value * 7919) % 10000);
+    }
+
+    const uniform_t snapshot(values);
+
+    std::vector<std::thread> threads;
+    for (int id = 0; id < 4; ++id) {
+        threads.emplace_back([&, id] {
+            for (int i = 0; i < 100; ++i) {
+                const auto quantile = (id * 100 + i) / 400.0;
+                EXPECT_NEAR(quantile * 10001 - 1, snapshot.value(quantile), 1.0);
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
 }  // namespace testing
 }  // namespace metrics
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+#include <metrics/clock.hpp>
+
+namespace metrics {
+namespace testing {
+
+TEST(coarse_clock_t, Monotonic) {
+    const auto first = coarse_clock_t::now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const auto second = coarse_clock_t::now();
+
+    EXPECT_LE(first, second);
+    EXPECT_GE(second - first, std::chrono::milliseconds(10));
+}
+
+TEST(tsc_clock_t, MatchesSteadyClock) {
+    typedef std::chrono::steady_clock clock_type;
+
+    // Calibrate first, so that the calibration spin isn't measured.
+    tsc_clock_t::calibrate();
+
+    const auto begin = clock_type::now();
+    const auto ticks = tsc_clock_t::ticks();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    const auto span = tsc_clock_t::ticks() - ticks;
+    const auto expected = clock_type::now() - begin;
+
+    const auto elapsed = tsc_clock_t::to_duration(span);
+
+    // Allow a generous error, because both clocks are read at slightly different moments.
+    EXPECT_NEAR(std::chrono::duration_cast<std::chrono::microseconds>(expected).count(),
+                std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count(),
+                5000);
+}
+
+TEST(timer_clock_t, FallsBackWithoutInvariantCounter) {
+    EXPECT_FALSE(timer_clock_t().reads_tsc());
+    EXPECT_FALSE(timer_clock_t(false, true).reads_tsc());
+    EXPECT_FALSE(timer_clock_t(true, false).reads_tsc());
+    EXPECT_TRUE(timer_clock_t(true, true).reads_tsc());
+    EXPECT_EQ(tsc_clock_t::invariant(), timer_clock_t(true).reads_tsc());
+
+    // The fallback clock measures in regular time points rather than raw ticks.
+    const timer_clock_t clock(true, false);
+    const auto start = clock.stamp();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    const auto elapsed = clock.elapsed(start);
+
+    EXPECT_GE(elapsed, std::chrono::milliseconds(9));
+    EXPECT_LE(elapsed, std::chrono::seconds(1));
+    EXPECT_LE(clock.now() - timer_clock_t::precise_type::now(), std::chrono::seconds(1));
+}
+
+}  // namespace testing
+}  // namespace metrics
@@ -2,6 +2,7 @@
 
 #include <boost/optional/optional.hpp>
 
+#include <metrics/counter.hpp>
 #include <metrics/registry.hpp>
 
 namespace metrics {
@@ -158,5 +159,52 @@ TEST(Counter, DifferentByTagsDec) {
     EXPECT_EQ(0, counter2->load());
 }
 
+TEST(StripedCounter, Factory) {
+    registry_t registry;
+
+    auto counter = registry.striped_counter("metrics.testing.counter");
+
+    // Default value is 0.
+    EXPECT_EQ(0, counter->get());
+}
+
+TEST(StripedCounter, IncDec) {
+    registry_t registry;
+
+    auto counter = registry.striped_counter("metrics.testing.counter");
+
+    counter->inc();
+    counter->inc(41);
+    EXPECT_EQ(42, counter->get());
+
+    counter->dec(50);
+    EXPECT_EQ(-8, counter->get());
+}
+
+TEST(StripedCounter, Shared) {
+    registry_t registry;
+
+    auto counter = registry.striped_counter("metrics.testing.counter");
+    counter->inc();
+
+    auto other = registry.striped_counter("metrics.testing.counter");
+    other->inc();
+
+    EXPECT_EQ(2, counter->get());
+}
+
+TEST(StripedCounter, DoesNotClashWithAtomicCounter) {
+    registry_t registry;
+
+    auto counter = registry.striped_counter("metrics.testing.counter");
+    counter->inc();
+
+    auto other = registry.counter<std::int64_t>("metrics.testing.counter");
+
+    EXPECT_EQ(1, counter->get());
+    EXPECT_EQ(0, other->load());
+    EXPECT_EQ("counter", counter.type());
+}
+
 }  // namespace testing
 }  // namespace metrics
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include <src/counter.hpp>
+
+namespace metrics {
+namespace testing {
+
+using detail::striped_counter_t;
+
+TEST(striped_counter_t, Constructor) {
+    striped_counter_t counter;
+
+    EXPECT_EQ(0, counter.get());
+    EXPECT_LE(1, counter.size());
+}
+
+TEST(striped_counter_t, SizeIsPowerOfTwo) {
+    EXPECT_EQ(1, striped_counter_t(0).size());
+    EXPECT_EQ(1, striped_counter_t(1).size());
+    EXPECT_EQ(4, striped_counter_t(3).size());
+    EXPECT_EQ(8, striped_counter_t(8).size());
+}
+
+TEST(striped_counter_t, IncDec) {
+    striped_counter_t counter(4);
+
+    counter.inc();
+    counter.inc(41);
+    EXPECT_EQ(42, counter.get());
+
+    counter.dec();
+    counter.dec(51);
+    EXPECT_EQ(-10, counter.get());
+}
+
+TEST(striped_counter_t, ConcurrentInc) {
+    striped_counter_t counter(4);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([&] {
+            for (int j = 0; j < 10000; ++j) {
+                counter.inc();
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(80000, counter.get());
+}
+
+}  // namespace testing
+}  // namespace metrics
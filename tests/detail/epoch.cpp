@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+#include <src/epoch.hpp>
+
+namespace metrics {
+namespace testing {
+
+using detail::epoch_t;
+
+TEST(epoch_t, RetireWithoutReaders) {
+    auto& domain = epoch_t::instance();
+
+    auto called = false;
+    domain.retire([&] {
+        called = true;
+    });
+
+    EXPECT_TRUE(called);
+}
+
+TEST(epoch_t, RetireIsDeferredWhileReaderIsActive) {
+    auto& domain = epoch_t::instance();
+
+    auto called = false;
+    {
+        epoch_t::guard_t guard(domain);
+        domain.retire([&] {
+            called = true;
+        });
+
+        EXPECT_FALSE(called);
+    }
+
+    // Any further retirement reclaims pending objects.
+    domain.retire([] {});
+    EXPECT_TRUE(called);
+}
+
+TEST(epoch_t, NestedGuards) {
+    auto& domain = epoch_t::instance();
+
+    auto called = false;
+    {
+        epoch_t::guard_t outer(domain);
+        {
+            epoch_t::guard_t inner(domain);
+        }
+
+        domain.retire([&] {
+            called = true;
+        });
+
+        domain.retire([] {});
+        EXPECT_FALSE(called);
+    }
+
+    domain.retire([] {});
+    EXPECT_TRUE(called);
+}
+
+TEST(epoch_t, RetireIsDeferredWhileOtherThreadIsReader) {
+    auto& domain = epoch_t::instance();
+
+    std::atomic<int> stage(0);
+    std::thread reader([&] {
+        epoch_t::guard_t guard(domain);
+        stage = 1;
+        while (stage != 2) {
+            std::this_thread::yield();
+        }
+    });
+
+    while (stage != 1) {
+        std::this_thread::yield();
+    }
+
+    std::atomic<bool> called(false);
+    domain.retire([&] {
+        called = true;
+    });
+
+    EXPECT_FALSE(called);
+
+    stage = 2;
+    reader.join();
+
+    domain.retire([] {});
+    EXPECT_TRUE(called);
+}
+
+}  // namespace testing
+}  // namespace metrics
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include <src/index.hpp>
+
+namespace metrics {
+namespace testing {
+
+using detail::index_t;
+
+namespace {
+
+auto contains(const std::vector<tags_t>& result, const tags_t& tags) -> bool {
+    return std::find(result.begin(), result.end(), tags) != result.end();
+}
+
+}  // namespace
+
+TEST(index_t, SelectEq) {
+    const tags_t t1("n1", {{"source", "node"}});
+    const tags_t t2("n2", {{"source", "node"}});
+    const tags_t t3("n3", {{"source", "core"}});
+
+    index_t index;
+    index.insert(t1);
+    index.insert(t2);
+    index.insert(t3);
+
+    const auto result = index.select(filter_t::eq("source", "node"));
+
+    EXPECT_EQ(2, result.size());
+    EXPECT_TRUE(contains(result, t1));
+    EXPECT_TRUE(contains(result, t2));
+}
+
+TEST(index_t, SelectPrefix) {
+    index_t index;
+    index.insert(tags_t("a.b.c"));
+    index.insert(tags_t("a.b.d"));
+    index.insert(tags_t("a.c"));
+    index.insert(tags_t("a.b"));
+
+    EXPECT_EQ(3, index.select(filter_t::prefix("name", "a.b")).size());
+    EXPECT_EQ(2, index.select(filter_t::prefix("name", "a.b.")).size());
+    EXPECT_EQ(0, index.select(filter_t::prefix("name", "b")).size());
+}
+
+TEST(index_t, SelectConjunction) {
+    const tags_t t1("n1", {{"source", "node"}, {"service", "storage"}});
+    const tags_t t2("n2", {{"source", "node"}, {"service", "locator"}});
+
+    index_t index;
+    index.insert(t1);
+    index.insert(t2);
+
+    const auto filter = filter_t::eq("source", "node") && filter_t::eq("service", "storage");
+    const auto result = index.select(filter);
+
+    ASSERT_EQ(1, result.size());
+    EXPECT_EQ(t1, result[0]);
+}
+
+TEST(index_t, SelectUnknown) {
+    index_t index;
+    index.insert(tags_t("n1", {{"source", "node"}}));
+
+    EXPECT_TRUE(index.select(filter_t::eq("other", "node")).empty());
+    EXPECT_TRUE(index.select(filter_t::eq("source", "other")).empty());
+}
+
+TEST(index_t, InsertIsIdempotent) {
+    index_t index;
+    index.insert(tags_t("n1"));
+    index.insert(tags_t("n1"));
+
+    EXPECT_EQ(1, index.select(filter_t::eq("name", "n1")).size());
+}
+
+TEST(index_t, Erase) {
+    const tags_t t1("n1", {{"source", "node"}});
+
+    index_t index;
+    index.insert(t1);
+    index.erase(t1);
+
+    EXPECT_TRUE(index.select(filter_t::eq("source", "node")).empty());
+    EXPECT_TRUE(index.select(filter_t::eq("name", "n1")).empty());
+}
+
+}  // namespace testing
+}  // namespace metrics
@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <metrics/tags.hpp>
+
+#include <src/intern.hpp>
+
+namespace metrics {
+namespace testing {
+
+TEST(intern, SameContentSameAddress) {
+    const std::string value("metrics.testing.intern");
+
+    const auto v1 = detail::intern(value);
+    const auto v2 = detail::intern("metrics.testing.intern");
+
+    EXPECT_EQ(value, *v1);
+    EXPECT_EQ(v1, v2);
+
+    detail::release(v1);
+    detail::release(v2);
+}
+
+TEST(intern, DifferentContentDifferentAddress) {
+    const auto a = detail::intern("a");
+    const auto b = detail::intern("b");
+    const auto empty = detail::intern("");
+
+    EXPECT_NE(a, b);
+    EXPECT_NE(empty, a);
+
+    detail::release(a);
+    detail::release(b);
+    detail::release(empty);
+}
+
+TEST(intern, ReleasesUnreferencedStrings) {
+    const auto size = detail::interned();
+
+    {
+        const tags_t tags("metrics.testing.intern.released", {{"id", "metrics.testing.intern.42"}});
+        const auto copy = tags;
+
+        // The name, the value and both keys, unless interned by other tests.
+        EXPECT_LE(size + 2, detail::interned());
+    }
+
+    EXPECT_EQ(size, detail::interned());
+}
+
+}  // namespace testing
+}  // namespace metrics
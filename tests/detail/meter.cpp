@@ -2,6 +2,10 @@
 #include <gtest/gtest.h>
 
 #include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 #include <src/meter.hpp>
 
@@ -70,5 +74,75 @@ TEST(meter, mark) {
     EXPECT_NEAR(0.1988, meter.m15rate(), 1e-3);
 }
 
+TEST(meter, ticks_count_increments) {
+    meter_type meter;
+
+    EXPECT_CALL(meter.clock(), now())
+        .WillOnce(Return(mock::clock_t::time_point()))
+        .WillOnce(Return(mock::clock_t::time_point(std::chrono::seconds(6))))
+        .WillRepeatedly(Return(mock::clock_t::time_point(std::chrono::seconds(12))));
+
+    meter.mark(5);
+    meter.mark(3);
+    meter.mark(1);
+
+    // Each tick must see only events marked since the previous one.
+    auto expected = detail::ewma_t::m01rate();
+    expected.tick(5);
+    expected.tick(3);
+
+    EXPECT_EQ(9, meter.count());
+    EXPECT_DOUBLE_EQ(expected.rate<std::chrono::seconds>(), meter.m01rate());
+}
+
+TEST(meter, summary) {
+    meter_type meter;
+
+    EXPECT_CALL(meter.clock(), now())
+        .Times(3)
+        .WillOnce(Return(mock::clock_t::time_point()))
+        .WillRepeatedly(Return(mock::clock_t::time_point(std::chrono::seconds(10))));
+
+    meter.mark();
+    meter.mark(2);
+
+    // Reads the clock only once.
+    const auto summary = meter.summary();
+
+    EXPECT_EQ(3, summary.count);
+    EXPECT_FLOAT_EQ(0.3, summary.mean_rate);
+    EXPECT_NEAR(0.1840, summary.m01rate, 1e-3);
+    EXPECT_NEAR(0.1966, summary.m05rate, 1e-3);
+    EXPECT_NEAR(0.1988, summary.m15rate, 1e-3);
+}
+
+TEST(meter, attach_rejects_unexpected_interval) {
+    meter_type meter;
+
+    EXPECT_THROW(meter.attach(std::make_shared<ticker_t>(std::chrono::milliseconds(1))),
+                 std::invalid_argument);
+    EXPECT_NO_THROW(meter.attach(std::make_shared<ticker_t>(std::chrono::seconds(5))));
+}
+
+TEST(meter, concurrent_marks) {
+    meter_type meter;
+
+    // More threads than the meter has counter cells, so some of them share a cell.
+    std::vector<std::thread> threads;
+    for (int id = 0; id < 8; ++id) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 10000; ++i) {
+                meter.mark();
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(80000, meter.count());
+}
+
 }  // namespace testing
 }  // namespace metrics
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <random>
+#include <vector>
+
+#include <src/stats.hpp>
+
+namespace metrics {
+namespace detail {
+namespace testing {
+
+namespace {
+
+/// Two-pass reference implementation.
+auto expected(const std::vector<std::uint64_t>& values, const std::vector<double>& weights)
+    -> moments_t
+{
+    moments_t result{0.0, 0.0, 0.0, values.empty() ? 0 : values[0], 0};
+
+    for (std::size_t id = 0; id < values.size(); ++id) {
+        result.weight += weights[id];
+        result.sum += weights[id] * values[id];
+        result.min = std::min(result.min, values[id]);
+        result.max = std::max(result.max, values[id]);
+    }
+
+    for (std::size_t id = 0; id < values.size(); ++id) {
+        const auto diff = values[id] - result.mean();
+        result.m2 += weights[id] * diff * diff;
+    }
+
+    return result;
+}
+
+auto check(const moments_t& expected, const moments_t& actual) -> void {
+    EXPECT_NEAR(expected.weight, actual.weight, 1e-9 * expected.weight);
+    EXPECT_NEAR(expected.sum, actual.sum, 1e-9 * expected.sum);
+    EXPECT_NEAR(expected.m2, actual.m2, 1e-6 * expected.m2);
+    EXPECT_EQ(expected.min, actual.min);
+    EXPECT_EQ(expected.max, actual.max);
+}
+
+}  // namespace
+
+TEST(moments, empty) {
+    const auto result = moments(nullptr, 0);
+
+    EXPECT_EQ(0.0, result.weight);
+    EXPECT_EQ(0.0, result.mean());
+    EXPECT_EQ(0.0, result.m2);
+    EXPECT_EQ(0, result.min);
+    EXPECT_EQ(0, result.max);
+}
+
+TEST(moments, match_reference) {
+    std::mt19937_64 gen(100500);
+
+    // Sizes both below and above the vector width with all possible tails.
+    for (std::size_t size : {1, 2, 3, 4, 5, 7, 8, 17, 1000, 1023}) {
+        std::vector<std::uint64_t> values(size);
+        std::vector<double> weights(size);
+        for (std::size_t id = 0; id < size; ++id) {
+            values[id] = 1000000 + gen() % 100000;
+            weights[id] = std::generate_canonical<double, 53>(gen);
+        }
+
+        check(expected(values, std::vector<double>(size, 1.0)), moments(values.data(), size));
+        check(expected(values, std::vector<double>(size, 1.0)), scalar::moments(values.data(), size));
+        check(expected(values, weights), moments(values.data(), weights.data(), size));
+        check(expected(values, weights), scalar::moments(values.data(), weights.data(), size));
+
+#ifdef METRICS_STATS_SIMD
+        if (__builtin_cpu_supports("sse4.2")) {
+            check(expected(values, std::vector<double>(size, 1.0)), sse::moments(values.data(), size));
+            check(expected(values, weights), sse::moments(values.data(), weights.data(), size));
+        }
+
+        if (__builtin_cpu_supports("avx2")) {
+            check(expected(values, std::vector<double>(size, 1.0)), avx2::moments(values.data(), size));
+            check(expected(values, weights), avx2::moments(values.data(), weights.data(), size));
+        }
+#endif
+    }
+}
+
+TEST(moments, large_offset_with_tiny_spread) {
+    typedef moments_t (*unweighted_type)(const std::uint64_t*, std::size_t);
+    typedef moments_t (*weighted_type)(const std::uint64_t*, const double*, std::size_t);
+
+    std::vector<std::pair<unweighted_type, weighted_type>> tiers{
+        {&scalar::moments, &scalar::moments},
+    };
+
+#ifdef METRICS_STATS_SIMD
+    if (__builtin_cpu_supports("sse4.2")) {
+        tiers.push_back({&sse::moments, &sse::moments});
+    }
+
+    if (__builtin_cpu_supports("avx2")) {
+        tiers.push_back({&avx2::moments, &avx2::moments});
+    }
+#endif
+
+    const auto stddev = [](const moments_t& moments) -> double {
+        return std::sqrt(moments.m2 / moments.weight);
+    };
+
+    // 1e12 ± 1, spanning several blocks.
+    std::vector<std::uint64_t> values(5000);
+    std::vector<double> weights(values.size(), 1.0);
+    for (std::size_t id = 0; id < values.size(); ++id) {
+        values[id] = 1000000000000 + id % 3 - 1;
+    }
+
+    // The first value is an outlier, which has a negligible weight though.
+    values[0] = 0;
+    weights[0] = 1e-30;
+
+    const auto reference = expected(values, weights);
+    ASSERT_NEAR(0.8165, stddev(reference), 1e-4);
+
+    // The reference itself is off by about 1e-8, because its mean is rounded to the nearest
+    // representable value of about 1e-4 precision.
+    for (const auto& tier : tiers) {
+        EXPECT_NEAR(stddev(reference), stddev(tier.second(values.data(), weights.data(), values.size())), 1e-6);
+
+        // Without the outlier, unweighted.
+        const auto unweighted = tier.first(values.data() + 1, values.size() - 1);
+        const auto reference = expected(std::vector<std::uint64_t>(values.begin() + 1, values.end()),
+                                        std::vector<double>(values.size() - 1, 1.0));
+        EXPECT_NEAR(stddev(reference), stddev(unweighted), 1e-6);
+        EXPECT_DOUBLE_EQ(reference.mean(), unweighted.mean());
+    }
+}
+
+TEST(moments, extreme_values) {
+    // Values above 2^63 must be neither treated as negative nor truncated on conversion.
+    const std::vector<std::uint64_t> values{
+        0xffffffffffffffff, 1, 0x8000000000000000, 0x7fffffffffffffff, 0, 42, 0x100000000, 3,
+    };
+
+    const auto result = moments(values.data(), values.size());
+    const auto reference = expected(values, std::vector<double>(values.size(), 1.0));
+
+    EXPECT_EQ(0, result.min);
+    EXPECT_EQ(0xffffffffffffffff, result.max);
+    EXPECT_DOUBLE_EQ(reference.sum, result.sum);
+}
+
+}  // namespace testing
+}  // namespace detail
+}  // namespace metrics
@@ -0,0 +1,257 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/optional/optional.hpp>
+
+#include <src/table.hpp>
+
+namespace metrics {
+namespace testing {
+
+using detail::epoch_t;
+
+typedef detail::table<int> table_type;
+
+namespace {
+
+auto find(const table_type& table, const tags_t& tags) -> std::shared_ptr<int> {
+    const auto eq = [&](const tags_t& other) -> bool {
+        return other == tags;
+    };
+
+    epoch_t::guard_t guard(epoch_t::instance());
+    if (auto node = table.find(tags.hash(), eq)) {
+        return node->instance.lock();
+    }
+
+    return nullptr;
+}
+
+auto size(const table_type& table) -> std::size_t {
+    std::size_t result = 0;
+    table.for_each([&](const tags_t&, std::shared_ptr<int>) {
+        ++result;
+    });
+
+    return result;
+}
+
+}  // namespace
+
+TEST(table, FindNonExisting) {
+    table_type table;
+
+    EXPECT_EQ(nullptr, find(table, tags_t("n")));
+}
+
+TEST(table, GetOrInsert) {
+    table_type table;
+
+    const auto v1 = table.get_or_insert(tags_t("n"), [] {
+        return std::make_shared<int>(42);
+    });
+
+    const auto v2 = table.get_or_insert(tags_t("n"), [] {
+        return std::make_shared<int>(100500);
+    });
+
+    EXPECT_EQ(v1, v2);
+    EXPECT_EQ(42, *v2);
+    EXPECT_EQ(v1, find(table, tags_t("n")));
+}
+
+TEST(table, GetOrInsertReplacesExpired) {
+    table_type table;
+
+    table.get_or_insert(tags_t("n"), [] {
+        return std::make_shared<int>(42);
+    });
+
+    EXPECT_EQ(nullptr, find(table, tags_t("n")));
+    EXPECT_EQ(0, size(table));
+
+    const auto value = table.get_or_insert(tags_t("n"), [] {
+        return std::make_shared<int>(100500);
+    });
+
+    EXPECT_EQ(100500, *value);
+    EXPECT_EQ(value, find(table, tags_t("n")));
+}
+
+TEST(table, Erase) {
+    table_type table;
+
+    const auto value = table.get_or_insert(tags_t("n"), [] {
+        return std::make_shared<int>(42);
+    });
+
+    EXPECT_TRUE(table.erase(tags_t("n")));
+    EXPECT_FALSE(table.erase(tags_t("n")));
+    EXPECT_EQ(nullptr, find(table, tags_t("n")));
+    EXPECT_EQ(42, *value);
+}
+
+TEST(table, ManyKeysSurviveRehash) {
+    table_type table;
+
+    std::vector<std::shared_ptr<int>> values;
+    for (int id = 0; id < 1024; ++id) {
+        values.push_back(table.get_or_insert(tags_t(std::to_string(id)), [=] {
+            return std::make_shared<int>(id);
+        }));
+    }
+
+    EXPECT_EQ(1024, size(table));
+
+    for (int id = 0; id < 1024; ++id) {
+        const auto value = find(table, tags_t(std::to_string(id)));
+        ASSERT_NE(nullptr, value);
+        EXPECT_EQ(id, *value);
+    }
+}
+
+TEST(table, Expired) {
+    table_type table;
+
+    auto value = table.get_or_insert(tags_t("n"), [] {
+        return std::make_shared<int>(42);
+    });
+
+    EXPECT_EQ(1, table.size());
+    EXPECT_EQ(0, table.expired());
+
+    value.reset();
+
+    EXPECT_EQ(1, table.size());
+    EXPECT_EQ(1, table.expired());
+}
+
+TEST(table, ExpiredAreReclaimedOnInsertion) {
+    table_type table;
+
+    // Simulate short-living metrics, for example per-connection ones.
+    for (int id = 0; id < 100000; ++id) {
+        table.get_or_insert(tags_t(std::to_string(id)), [=] {
+            return std::make_shared<int>(id);
+        });
+    }
+
+    EXPECT_GT(1000, table.size());
+    EXPECT_EQ(table.size(), table.expired());
+}
+
+TEST(table, AliveAreNotReclaimed) {
+    table_type table;
+
+    std::vector<std::shared_ptr<int>> values;
+    for (int id = 0; id < 10000; ++id) {
+        auto value = table.get_or_insert(tags_t(std::to_string(id)), [=] {
+            return std::make_shared<int>(id);
+        });
+
+        if (id % 2 == 0) {
+            values.push_back(std::move(value));
+        }
+    }
+
+    EXPECT_LE(5000, table.size());
+    EXPECT_EQ(table.size() - 5000, table.expired());
+
+    for (int id = 0; id < 10000; id += 2) {
+        EXPECT_EQ(values[id / 2], find(table, tags_t(std::to_string(id))));
+    }
+}
+
+TEST(table, ConcurrentLookupsAndInsertions) {
+    table_type table;
+
+    const auto value = table.get_or_insert(tags_t("n"), [] {
+        return std::make_shared<int>(42);
+    });
+
+    std::atomic<bool> done(false);
+    std::atomic<int> misses(0);
+
+    std::vector<std::thread> readers;
+    for (int id = 0; id < 4; ++id) {
+        readers.emplace_back([&] {
+            while (!done) {
+                if (find(table, tags_t("n")) != value) {
+                    ++misses;
+                }
+            }
+        });
+    }
+
+    // Force several rehashes while readers are active.
+    std::vector<std::shared_ptr<int>> values;
+    for (int id = 0; id < 4096; ++id) {
+        values.push_back(table.get_or_insert(tags_t(std::to_string(id)), [=] {
+            return std::make_shared<int>(id);
+        }));
+    }
+
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_EQ(0, misses);
+    EXPECT_EQ(4097, size(table));
+}
+
+TEST(table, ConcurrentFilteredVisitsAndInsertions) {
+    table_type table;
+
+    // Metrics of the same source spread over all shards.
+    std::vector<std::shared_ptr<int>> values;
+    for (int id = 0; id < 256; ++id) {
+        values.push_back(table.get_or_insert(tags_t(std::to_string(id), {{"source", "node"}}), [=] {
+            return std::make_shared<int>(id);
+        }));
+    }
+
+    const auto filter = filter_t::eq("source", "node");
+
+    std::atomic<bool> done(false);
+    std::atomic<int> misses(0);
+
+    std::thread reader([&] {
+        while (!done) {
+            std::size_t visited = 0;
+            table.for_each(filter, [&](const tags_t&, std::shared_ptr<int>) {
+                ++visited;
+            });
+
+            if (visited < 256) {
+                ++misses;
+            }
+        }
+    });
+
+    // Registrations of other sources never match, but share the shards with matched metrics.
+    for (int id = 0; id < 4096; ++id) {
+        values.push_back(table.get_or_insert(tags_t(std::to_string(id), {{"source", "core"}}), [=] {
+            return std::make_shared<int>(id);
+        }));
+    }
+
+    done = true;
+    reader.join();
+
+    std::size_t visited = 0;
+    table.for_each(filter, [&](const tags_t& tags, std::shared_ptr<int>) {
+        EXPECT_EQ("node", *tags.tag("source"));
+        ++visited;
+    });
+
+    EXPECT_EQ(0, misses);
+    EXPECT_EQ(256, visited);
+}
+
+}  // namespace testing
+}  // namespace metrics
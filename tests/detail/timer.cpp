@@ -1,10 +1,14 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <limits>
 #include <stdexcept>
+#include <type_traits>
 
 #include <metrics/accumulator/snapshot/uniform.hpp>
 
+#include <metrics/meter.hpp>
+
 #include <src/timer.hpp>
 
 namespace metrics {
@@ -23,10 +27,14 @@ struct clock_t {
 
 struct meter_t {
     MOCK_CONST_METHOD0(mark, void());
+    MOCK_CONST_METHOD1(mark, void(std::uint64_t));
+    MOCK_CONST_METHOD0(count, std::uint64_t());
 
     MOCK_CONST_METHOD0(m01rate, double());
     MOCK_CONST_METHOD0(m05rate, double());
     MOCK_CONST_METHOD0(m15rate, double());
+
+    MOCK_CONST_METHOD0(summary, metrics::meter_t::summary_t());
 };
 
 struct histogram_t {
@@ -42,6 +50,8 @@ struct histogram_t {
 
     MOCK_CONST_METHOD0(count, std::uint64_t());
     MOCK_CONST_METHOD1(update, void(std::uint64_t));
+    MOCK_CONST_METHOD2(update, void(const std::uint64_t*, std::size_t));
+    MOCK_CONST_METHOD2(update_n, void(std::uint64_t, std::uint64_t));
     MOCK_CONST_METHOD0(snapshot, snapshot_type());
 };
 
@@ -85,6 +95,30 @@ TEST(Timer, UpdatesCountOnUpdate) {
     EXPECT_EQ(1, timer.count());
 }
 
+TEST(Timer, UpdatesBatch) {
+    timer_type timer;
+
+    std::vector<std::uint64_t> recorded;
+    EXPECT_CALL(timer.histogram(), update(::testing::_, 3))
+        .Times(1)
+        .WillOnce(::testing::Invoke([&](const std::uint64_t* values, std::size_t size) {
+            recorded.assign(values, values + size);
+        }));
+
+    EXPECT_CALL(timer.meter(), mark(3))
+        .Times(1);
+
+    const std::vector<timer_type::duration_type> durations{
+        std::chrono::seconds(1),
+        std::chrono::milliseconds(2),
+        std::chrono::microseconds(3),
+    };
+
+    timer.update(durations.data(), durations.size());
+
+    EXPECT_EQ((std::vector<std::uint64_t>{1000000000, 2000000, 3000}), recorded);
+}
+
 TEST(Timer, MeasureCallable) {
     timer_type timer;
 
@@ -93,7 +127,7 @@ TEST(Timer, MeasureCallable) {
         .WillOnce(Return(mock::clock_t::time_point()))
         .WillRepeatedly(Return(mock::clock_t::time_point(std::chrono::milliseconds(50))));
 
-    EXPECT_CALL(timer.histogram(), update(50000000))
+    EXPECT_CALL(timer.histogram(), update_n(50000000, 1))
         .Times(1);
 
     EXPECT_CALL(timer.meter(), mark())
@@ -114,7 +148,7 @@ TEST(Timer, MeasureCallableOnThrow) {
         .WillOnce(Return(mock::clock_t::time_point()))
         .WillRepeatedly(Return(mock::clock_t::time_point(std::chrono::milliseconds(50))));
 
-    EXPECT_CALL(timer.histogram(), update(50000000))
+    EXPECT_CALL(timer.histogram(), update_n(50000000, 1))
         .Times(1);
 
     EXPECT_CALL(timer.meter(), mark())
@@ -147,5 +181,127 @@ TEST(Timer, DelegatesRateCalls) {
     EXPECT_DOUBLE_EQ(0.1, timer.m15rate());
 }
 
+TEST(Timer, StaticContext) {
+    timer_type timer;
+
+    EXPECT_CALL(timer.clock(), now())
+        .Times(2)
+        .WillOnce(Return(mock::clock_t::time_point()))
+        .WillRepeatedly(Return(mock::clock_t::time_point(std::chrono::milliseconds(50))));
+
+    EXPECT_CALL(timer.histogram(), update_n(50000000, 1))
+        .Times(1);
+
+    EXPECT_CALL(timer.meter(), mark())
+        .Times(1);
+
+    {
+        auto context = timer.context();
+        auto moved = std::move(context);
+    }
+}
+
+TEST(Timer, StaticContextDiscard) {
+    timer_type timer;
+
+    EXPECT_CALL(timer.clock(), now())
+        .Times(1)
+        .WillOnce(Return(mock::clock_t::time_point()));
+
+    EXPECT_CALL(timer.histogram(), update_n(::testing::_, ::testing::_))
+        .Times(0);
+
+    auto context = timer.context();
+    context.discard();
+}
+
+TEST(Timer, StaticContextSuppressesErrors) {
+    timer_type timer;
+
+    EXPECT_CALL(timer.clock(), now())
+        .Times(2)
+        .WillOnce(Return(mock::clock_t::time_point()))
+        .WillRepeatedly(Return(mock::clock_t::time_point(std::chrono::milliseconds(50))));
+
+    EXPECT_CALL(timer.histogram(), update_n(50000000, 1))
+        .Times(1)
+        .WillOnce(::testing::Throw(std::runtime_error("failed")));
+
+    EXPECT_NO_THROW(timer.context());
+}
+
+TEST(Timer, SkippedContext) {
+    timer_type timer;
+    timer.reset_sampler(sampler_t(std::numeric_limits<std::uint32_t>::max()));
+
+    // Skipped contexts neither read the clock nor update the histogram, but are still counted.
+    EXPECT_CALL(timer.clock(), now())
+        .Times(0);
+
+    EXPECT_CALL(timer.histogram(), update_n(::testing::_, ::testing::_))
+        .Times(0);
+
+    EXPECT_CALL(timer.meter(), mark())
+        .Times(1);
+
+    timer.context();
+}
+
+TEST(Sampler, Rate) {
+    sampler_t every(1);
+    sampler_t tenth(10);
+
+    int sampled = 0;
+    for (int i = 0; i < 10000; ++i) {
+        EXPECT_TRUE(every());
+        sampled += tenth() ? 1 : 0;
+    }
+
+    EXPECT_EQ(1, sampler_t(0).every());
+    EXPECT_GE(sampled, 820);
+    EXPECT_LE(sampled, 1180);
+}
+
+TEST(Timer, Summary) {
+    timer_type timer;
+
+    EXPECT_CALL(timer.meter(), summary())
+        .Times(1)
+        .WillOnce(Return(metrics::meter_t::summary_t{4, 2.0, 1.0, 0.5, 0.1}));
+
+    EXPECT_CALL(timer.histogram(), snapshot())
+        .Times(1)
+        .WillOnce(Return(accumulator::snapshot::uniform_t({40, 10, 30, 20})));
+
+    const auto summary = timer.summary({0.0, 0.5, 1.0});
+
+    EXPECT_EQ(4, summary.count);
+    EXPECT_DOUBLE_EQ(2.0, summary.mean_rate);
+    EXPECT_DOUBLE_EQ(1.0, summary.m01rate);
+    EXPECT_DOUBLE_EQ(0.5, summary.m05rate);
+    EXPECT_DOUBLE_EQ(0.1, summary.m15rate);
+    EXPECT_EQ(10, summary.min);
+    EXPECT_EQ(40, summary.max);
+    EXPECT_DOUBLE_EQ(25.0, summary.mean);
+    ASSERT_EQ(3, summary.size);
+    EXPECT_DOUBLE_EQ(10.0, summary.quantiles[0]);
+    EXPECT_DOUBLE_EQ(25.0, summary.quantiles[1]);
+    EXPECT_DOUBLE_EQ(40.0, summary.quantiles[2]);
+    EXPECT_DOUBLE_EQ(0.0, summary.quantiles[3]);
+}
+
+TEST(Timer, SummaryIsPod) {
+    EXPECT_TRUE(std::is_pod<timer_type::summary_t>::value);
+}
+
+TEST(Timer, SummaryThrowsOnTooManyQuantiles) {
+    timer_type timer;
+
+    EXPECT_CALL(timer.histogram(), snapshot())
+        .Times(0);
+
+    EXPECT_THROW(timer.summary(std::vector<double>(9, 0.5)), std::invalid_argument);
+}
+
 }  // namespace testing
 }  // namespace metrics
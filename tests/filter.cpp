@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+
+#include <metrics/filter.hpp>
+#include <metrics/tags.hpp>
+
+namespace metrics {
+namespace testing {
+
+TEST(filter_t, EmptyMatchesAll) {
+    filter_t filter;
+
+    EXPECT_TRUE(filter.empty());
+    EXPECT_TRUE(filter.match(tags_t("name")));
+}
+
+TEST(filter_t, Eq) {
+    const auto filter = filter_t::eq("source", "node");
+
+    EXPECT_TRUE(filter.match(tags_t("name", {{"source", "node"}})));
+    EXPECT_FALSE(filter.match(tags_t("name", {{"source", "node1"}})));
+    EXPECT_FALSE(filter.match(tags_t("name")));
+}
+
+TEST(filter_t, Prefix) {
+    const auto filter = filter_t::prefix("name", "metrics.testing.");
+
+    EXPECT_TRUE(filter.match(tags_t("metrics.testing.")));
+    EXPECT_TRUE(filter.match(tags_t("metrics.testing.name")));
+    EXPECT_FALSE(filter.match(tags_t("metrics.other")));
+}
+
+TEST(filter_t, Conjunction) {
+    const auto filter = filter_t::eq("source", "node") && filter_t::prefix("service", "stor");
+
+    EXPECT_EQ(2, filter.clauses().size());
+    EXPECT_TRUE(filter.match(tags_t("name", {{"source", "node"}, {"service", "storage"}})));
+    EXPECT_FALSE(filter.match(tags_t("name", {{"source", "node"}, {"service", "locator"}})));
+    EXPECT_FALSE(filter.match(tags_t("name", {{"service", "storage"}})));
+}
+
+}  // namespace testing
+}  // namespace metrics
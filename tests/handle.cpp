@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include <metrics/accumulator/sliding/window.hpp>
+#include <metrics/handle.hpp>
+#include <metrics/meter.hpp>
+#include <metrics/registry.hpp>
+#include <metrics/timer.hpp>
+
+namespace metrics {
+namespace testing {
+
+namespace {
+
+typedef metrics::timer<accumulator::sliding::window_t> timer_type;
+
+auto timer(const registry_t& registry) -> const handle<timer_type>& {
+    return METRICS_CACHED(registry, timer("<test>"));
+}
+
+}  // namespace
+
+TEST(handle, Default) {
+    handle<meter_t> handle;
+
+    EXPECT_FALSE(handle.valid());
+    EXPECT_EQ(nullptr, handle.get());
+}
+
+TEST(handle, Resolve) {
+    registry_t registry;
+
+    const auto handle = registry.resolve([](const registry_t& registry) {
+        return registry.timer("<test>");
+    });
+
+    EXPECT_TRUE(handle.valid());
+    EXPECT_TRUE(handle.issued_by(registry.generation()));
+    EXPECT_EQ(registry.timer("<test>").get(), handle.get());
+}
+
+TEST(handle, InvalidatedByRemove) {
+    registry_t registry;
+
+    const auto handle = registry.resolve([](const registry_t& registry) {
+        return registry.timer("<test>");
+    });
+
+    EXPECT_FALSE(registry.remove<timer_type>("<other>", {}));
+    EXPECT_TRUE(handle.valid());
+
+    EXPECT_TRUE(registry.remove<timer_type>("<test>", {}));
+    EXPECT_FALSE(handle.valid());
+
+    // The detached metric is still safe to use.
+    handle->context();
+    EXPECT_EQ(1, handle->count());
+}
+
+TEST(handle, InvalidatedByRegistryDestruction) {
+    std::unique_ptr<registry_t> registry(new registry_t);
+
+    const auto handle = registry->resolve([](const registry_t& registry) {
+        return registry.meter("<test>");
+    });
+
+    registry.reset();
+    EXPECT_FALSE(handle.valid());
+
+    handle->mark();
+    EXPECT_EQ(1, handle->count());
+}
+
+TEST(handle, Cached) {
+    registry_t registry;
+
+    const auto& h1 = timer(registry);
+    const auto& h2 = timer(registry);
+
+    EXPECT_EQ(&h1, &h2);
+    EXPECT_EQ(registry.timer("<test>").get(), h1.get());
+}
+
+TEST(handle, CachedResolvesAgainAfterRemove) {
+    registry_t registry;
+
+    const auto t1 = timer(registry).get();
+    registry.remove<timer_type>("<test>", {});
+    const auto t2 = timer(registry).get();
+
+    EXPECT_NE(t1, t2);
+    EXPECT_EQ(registry.timer("<test>").get(), t2);
+}
+
+TEST(handle, CachedResolvesAgainForOtherRegistry) {
+    registry_t r1;
+    registry_t r2;
+
+    const auto t1 = timer(r1).get();
+    const auto t2 = timer(r2).get();
+
+    EXPECT_NE(t1, t2);
+    EXPECT_EQ(r2.timer("<test>").get(), t2);
+}
+
+}  // namespace testing
+}  // namespace metrics
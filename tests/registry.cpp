@@ -2,8 +2,20 @@
 
 #include <gtest/gtest.h>
 
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <metrics/accumulator/hdr/histogram.hpp>
+#include <metrics/accumulator/sketch/ddsketch.hpp>
+#include <metrics/accumulator/sketch/tdigest.hpp>
+#include <metrics/accumulator/sliding/time_window.hpp>
+#include <metrics/accumulator/sliding/window.hpp>
+#include <metrics/counter.hpp>
 #include <metrics/registry.hpp>
 #include <metrics/tags.hpp>
+#include <metrics/timer.hpp>
 
 namespace metrics {
 namespace {
@@ -25,6 +37,36 @@ TEST(resistry_t, Query) {
     EXPECT_EQ(1, r2.size());
 }
 
+TEST(resistry_t, SelectByFilter) {
+    registry_t registry;
+    auto c1 = registry.counter<std::int64_t>("hostname.testing.accepted", {{"source", "node"}});
+    auto c2 = registry.counter<std::int64_t>("hostname.testing.rejected", {{"source", "node"}});
+    auto c3 = registry.counter<std::int64_t>("hostname.testing.rejected", {{"source", "non-node"}});
+    auto m1 = registry.meter("hostname.testing.meter", {{"source", "node"}});
+
+    EXPECT_EQ(3, registry.select(filter_t::eq("source", "node")).size());
+    EXPECT_EQ(1, registry.select(filter_t::eq("source", "non-node")).size());
+    EXPECT_EQ(4, registry.select(filter_t::prefix("name", "hostname.testing.")).size());
+    EXPECT_EQ(2, registry.counters<std::int64_t>(filter_t::eq("source", "node")).size());
+    EXPECT_EQ(1, registry.meters(filter_t::eq("source", "node")).size());
+    EXPECT_EQ(2, registry.select(filter_t::eq("name", "hostname.testing.rejected")).size());
+
+    const auto filter = filter_t::eq("source", "node") && filter_t::eq("type", "meter");
+    EXPECT_EQ(1, registry.select(filter).size());
+    EXPECT_EQ(4, registry.select(filter_t()).size());
+}
+
+TEST(resistry_t, SelectByFilterSkipsRemovedAndExpired) {
+    registry_t registry;
+    auto c1 = registry.counter<std::int64_t>("<test>", {{"source", "node"}});
+    registry.counter<std::int64_t>("<expired>", {{"source", "node"}});
+
+    EXPECT_EQ(1, registry.select(filter_t::eq("source", "node")).size());
+
+    registry.remove<std::atomic<std::int64_t>>("<test>", {{"source", "node"}});
+    EXPECT_EQ(0, registry.select(filter_t::eq("source", "node")).size());
+}
+
 TEST(resistry_t, QueryAll) {
     registry_t registry;
     auto c1 = registry.counter<std::int64_t>("hostname.testing.accepted", {{"source", "node"}});
@@ -82,6 +124,30 @@ TEST(resistry_t, RemoveCounter) {
     EXPECT_FALSE(registry.remove<std::atomic<std::int64_t>>(name, {}));
 }
 
+TEST(resistry_t, SameStripedCounterExactSize) {
+    const auto name = "<test>";
+
+    registry_t registry;
+    auto c1 = registry.striped_counter(name);
+    EXPECT_EQ(1, registry.striped_counters().size());
+
+    auto r1 = registry.striped_counter(name);
+    EXPECT_EQ(1, registry.striped_counters().size());
+}
+
+TEST(resistry_t, RemoveStripedCounter) {
+    const auto name = "<test>";
+
+    registry_t registry;
+    auto c1 = registry.striped_counter(name);
+    EXPECT_EQ(1, registry.select().size());
+
+    EXPECT_TRUE(registry.remove<counter_t>(name, {}));
+    EXPECT_EQ(0, registry.striped_counters().size());
+
+    EXPECT_FALSE(registry.remove<counter_t>(name, {}));
+}
+
 TEST(resistry_t, SameMeterExactSize) {
     const auto name = "<test>";
 
@@ -128,5 +194,285 @@ TEST(resistry_t, RemoveTimer) {
     EXPECT_FALSE(registry.remove<timer<accumulator::sliding::window_t>>(name, {}));
 }
 
+TEST(resistry_t, TimerByView) {
+    registry_t registry;
+    auto t1 = registry.timer("<test>", {{"source", "node"}, {"service", "storage"}});
+
+    const tags_view_t::value_type tags[] = {{"service", "storage"}, {"source", "node"}};
+    auto t2 = registry.timer(tags_view_t("<test>", tags));
+
+    EXPECT_EQ(t1.get(), t2.get());
+    EXPECT_TRUE(t1.tags() == t2.tags());
+    EXPECT_EQ(1, registry.timers().size());
+}
+
+TEST(resistry_t, TimerByViewCreates) {
+    registry_t registry;
+
+    const tags_view_t::value_type tags[] = {{"source", "node"}};
+    auto t1 = registry.timer(tags_view_t("<test>", tags));
+    auto t2 = registry.timer("<test>", {{"source", "node"}});
+
+    EXPECT_EQ(t1.get(), t2.get());
+    EXPECT_EQ("timer", t1.type());
+    EXPECT_EQ("node", *t1.tag("source"));
+    EXPECT_EQ(1, registry.timers().size());
+}
+
+TEST(resistry_t, TimerByViewDistinguishesTags) {
+    registry_t registry;
+    auto t1 = registry.timer("<test>", {{"source", "node"}, {"service", "storage"}});
+
+    const tags_view_t::value_type tags[] = {{"source", "node"}};
+    auto t2 = registry.timer(tags_view_t("<test>", tags));
+
+    EXPECT_NE(t1.get(), t2.get());
+    EXPECT_EQ(2, registry.timers().size());
+}
+
+TEST(resistry_t, TimerByViewWithTypeTag) {
+    registry_t registry;
+    auto t1 = registry.timer("<test>");
+
+    // The type tag is always overridden by the registry.
+    const tags_view_t::value_type tags[] = {{"type", "gauge"}};
+    auto t2 = registry.timer(tags_view_t("<test>", tags));
+
+    EXPECT_EQ(t1.get(), t2.get());
+}
+
+TEST(resistry_t, CounterAndMeterByView) {
+    registry_t registry;
+    auto c1 = registry.counter<std::int64_t>("<test>");
+    auto s1 = registry.striped_counter("<test>");
+    auto m1 = registry.meter("<test>");
+
+    const tags_view_t view("<test>");
+    EXPECT_EQ(c1.get(), registry.counter<std::int64_t>(view).get());
+    EXPECT_EQ(s1.get(), registry.striped_counter(view).get());
+    EXPECT_EQ(m1.get(), registry.meter(view).get());
+}
+
+TEST(resistry_t, ManyMetrics) {
+    registry_t registry;
+
+    std::vector<shared_metric<std::atomic<std::int64_t>>> counters;
+    for (int id = 0; id < 1000; ++id) {
+        counters.push_back(registry.counter<std::int64_t>("<test>", {{"id", std::to_string(id)}}));
+    }
+
+    EXPECT_EQ(1000, registry.counters<std::int64_t>().size());
+
+    for (int id = 0; id < 1000; ++id) {
+        const auto value = std::to_string(id);
+        const tags_view_t::value_type tags[] = {{"id", value}};
+
+        EXPECT_EQ(counters[id].get(), registry.counter<std::int64_t>(tags_view_t("<test>", tags)).get());
+    }
+}
+
+TEST(resistry_t, HdrTimer) {
+    registry_t registry;
+
+    auto t1 = registry.timer<accumulator::hdr::histogram_t>("<test>");
+    t1->update(std::chrono::microseconds(10));
+
+    EXPECT_EQ(t1.get(), registry.timer<accumulator::hdr::histogram_t>("<test>").get());
+    EXPECT_EQ(1, registry.timers<accumulator::hdr::histogram_t>().size());
+    EXPECT_EQ(1, registry.select().size());
+    EXPECT_NEAR(10000, t1->snapshot().max(), 100);
+
+    EXPECT_TRUE(registry.remove<metrics::timer<accumulator::hdr::histogram_t>>("<test>", {}));
+}
+
+TEST(resistry_t, TimeWindowTimer) {
+    registry_t registry;
+
+    auto t1 = registry.timer<accumulator::sliding::time_window_t>("<test>");
+    t1->update(std::chrono::microseconds(10));
+
+    EXPECT_EQ(t1.get(), registry.timer<accumulator::sliding::time_window_t>("<test>").get());
+    EXPECT_EQ(1, registry.timers<accumulator::sliding::time_window_t>().size());
+    EXPECT_EQ(1, t1->snapshot().size());
+}
+
+TEST(resistry_t, SketchTimer) {
+    registry_t registry;
+
+    auto t1 = registry.timer<accumulator::sketch::ddsketch_t>("<test>");
+    t1->update(std::chrono::microseconds(10));
+
+    EXPECT_EQ(1, registry.timers<accumulator::sketch::ddsketch_t>().size());
+    EXPECT_NEAR(10000, t1->snapshot().p99(), 100);
+}
+
+TEST(resistry_t, DigestTimer) {
+    registry_t registry;
+
+    auto t1 = registry.timer<accumulator::sketch::tdigest_t>("<test>");
+    t1->update(std::chrono::microseconds(10));
+
+    EXPECT_EQ(1, registry.timers<accumulator::sketch::tdigest_t>().size());
+    EXPECT_EQ(10000, t1->snapshot().max());
+}
+
+TEST(resistry_t, TscTimer) {
+    registry_t registry;
+
+    auto t1 = registry.tsc_timer<accumulator::hdr::histogram_t>("<test>");
+    EXPECT_EQ(t1.get(), registry.timer<accumulator::hdr::histogram_t>("<test>").get());
+
+    t1->measure([] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    });
+
+    EXPECT_EQ(1, t1->count());
+    EXPECT_GE(t1->snapshot().max(), 9000000);
+    EXPECT_LE(t1->snapshot().max(), 1000000000);
+}
+
+TEST(resistry_t, SampledTimer) {
+    registry_t registry;
+
+    auto t1 = registry.timer<accumulator::sketch::tdigest_t>("<test>", {}, 10);
+    EXPECT_EQ(t1.get(), registry.timer<accumulator::sketch::tdigest_t>("<test>").get());
+
+    for (int i = 0; i < 10000; ++i) {
+        t1->context();
+    }
+
+    // Every event is counted, while only about a tenth is recorded with the weight of ten;
+    // bounds are about 6 sigmas.
+    EXPECT_EQ(10000, t1->count());
+    EXPECT_GE(t1->snapshot().size(), 8200);
+    EXPECT_LE(t1->snapshot().size(), 11800);
+}
+
+TEST(resistry_t, SampledWindowTimer) {
+    registry_t registry;
+
+    auto t1 = registry.timer("<test>", {}, 10);
+
+    for (int i = 0; i < 5000; ++i) {
+        t1->context();
+    }
+
+    // The window can't weight values, so its snapshot is scaled instead.
+    const auto snapshot = t1->snapshot();
+    EXPECT_EQ(10 * snapshot.values().size(), snapshot.size());
+    EXPECT_GE(snapshot.size(), 3200);
+    EXPECT_LE(snapshot.size(), 6800);
+}
+
+TEST(resistry_t, SampledTimerRateMismatch) {
+    registry_t registry;
+
+    auto t1 = registry.timer<accumulator::sketch::tdigest_t>("<test>", {}, 10);
+    auto t2 = registry.timer("<other>");
+
+    EXPECT_NO_THROW(registry.timer<accumulator::sketch::tdigest_t>("<test>", {}, 10));
+    EXPECT_THROW(registry.timer<accumulator::sketch::tdigest_t>("<test>", {}, 100), std::invalid_argument);
+    EXPECT_THROW(registry.tsc_timer<accumulator::sketch::tdigest_t>("<test>", {}, 1), std::invalid_argument);
+    EXPECT_NO_THROW(registry.timer("<other>", {}, 0));
+    EXPECT_THROW(registry.timer("<other>", {}, 2), std::invalid_argument);
+}
+
+TEST(resistry_t, SampledTscTimer) {
+    registry_t registry;
+
+    auto t1 = registry.tsc_timer<accumulator::sketch::tdigest_t>("<test>", {}, 10);
+    EXPECT_EQ(t1.get(), registry.timer<accumulator::sketch::tdigest_t>("<test>").get());
+
+    for (int i = 0; i < 10000; ++i) {
+        t1->context();
+    }
+
+    const auto summary = t1->summary({0.5});
+
+    // The summary counts every event, while the snapshot holds about a tenth of them, each
+    // weighted by ten.
+    EXPECT_EQ(10000, t1->count());
+    EXPECT_EQ(10000, summary.count);
+    EXPECT_GE(t1->snapshot().size(), 8200);
+    EXPECT_LE(t1->snapshot().size(), 11800);
+}
+
+TEST(resistry_t, StaticTimer) {
+    registry_t registry;
+
+    auto t1 = registry.static_timer<accumulator::sketch::tdigest_t>("<test>", {}, 10);
+    auto t2 = registry.tsc_timer("<other>");
+
+    EXPECT_EQ(t1.get(), registry.timer<accumulator::sketch::tdigest_t>("<test>").get());
+    EXPECT_EQ(t2.get(), registry.static_timer("<other>").get());
+    EXPECT_EQ(10, t1->sampler().every());
+    EXPECT_THROW(registry.static_timer<accumulator::sketch::tdigest_t>("<test>"), std::invalid_argument);
+
+    for (int i = 0; i < 10000; ++i) {
+        t1->context();
+    }
+
+    EXPECT_EQ(1, t1->measure([] { return 1; }));
+    EXPECT_EQ(10001, t1->count());
+    EXPECT_EQ(10001, t1->summary({0.5}).count);
+}
+
+TEST(resistry_t, Stats) {
+    registry_t registry;
+
+    auto c1 = registry.counter<std::int64_t>("<test>");
+    registry.timer("<test>");
+
+    const auto stats = registry.stats();
+    EXPECT_EQ(2, stats.size);
+    EXPECT_EQ(1, stats.expired);
+}
+
+TEST(resistry_t, ExpiredAreReclaimed) {
+    registry_t registry;
+
+    for (int id = 0; id < 10000; ++id) {
+        registry.timer("<test>", {{"connection", std::to_string(id)}});
+    }
+
+    const auto stats = registry.stats();
+    EXPECT_GT(1000, stats.size);
+    EXPECT_EQ(stats.size, stats.expired);
+}
+
+TEST(resistry_t, GaugeLookup) {
+    registry_t registry;
+
+    EXPECT_THROW(registry.gauge<std::int64_t>("<test>"), std::out_of_range);
+
+    {
+        auto g1 = registry.register_gauge<std::int64_t>("<test>", {}, [] {
+            return 42;
+        });
+
+        EXPECT_EQ(g1.get(), registry.gauge<std::int64_t>("<test>").get());
+    }
+
+    EXPECT_THROW(registry.gauge<std::int64_t>("<test>"), std::invalid_argument);
+}
+
+TEST(resistry_t, ConcurrentLookups) {
+    registry_t registry;
+    auto t1 = registry.timer<accumulator::sliding::window_t>("<test>");
+
+    std::vector<std::thread> threads;
+    for (int id = 0; id < 4; ++id) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 1000; ++i) {
+                EXPECT_EQ(t1.get(), registry.timer<accumulator::sliding::window_t>("<test>").get());
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
 } // namespace
 } // namespace metrics
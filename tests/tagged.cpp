@@ -51,5 +51,121 @@ TEST(tags_t, Less) {
     EXPECT_TRUE (tags3 < tags2);
 }
 
+TEST(tags_t, HashRespectsPairing) {
+    tags_t tags1("name", {{"a", "b"}, {"c", "d"}});
+    tags_t tags2("name", {{"a", "d"}, {"c", "b"}});
+
+    EXPECT_NE(std::hash<tags_t>()(tags1), std::hash<tags_t>()(tags2));
+}
+
+TEST(tags_t, CopiesAreEqual) {
+    tags_t tags1("name", {{"tag", "value"}});
+    tags_t tags2 = tags1;
+
+    EXPECT_TRUE(tags1 == tags2);
+    EXPECT_EQ(tags1.hash(), tags2.hash());
+}
+
+TEST(tags_t, FlatSortedByKey) {
+    tags_t tags("name", {{"service", "storage"}, {"scope", "testing"}});
+
+    ASSERT_EQ(3, tags.size());
+    EXPECT_EQ("name", *tags.begin()[0].first);
+    EXPECT_EQ("scope", *tags.begin()[1].first);
+    EXPECT_EQ("service", *tags.begin()[2].first);
+    EXPECT_EQ("storage", *tags.begin()[2].second);
+}
+
+TEST(tags_t, StringsAreInterned) {
+    tags_t tags1("name", {{"tag", "value"}});
+    tags_t tags2("other", {{"tag", "value"}});
+
+    EXPECT_EQ(tags1.begin()[1].first, tags2.begin()[1].first);
+    EXPECT_EQ(tags1.begin()[1].second, tags2.begin()[1].second);
+}
+
+TEST(tags_t, TagNotFound) {
+    tags_t tags("name", {{"tag", "value"}});
+
+    EXPECT_FALSE(tags.tag("other"));
+    EXPECT_EQ("name", *tags.tag("name"));
+}
+
+TEST(tags_t, Tags) {
+    const tags_t::container_type expected({{"name", "name"}, {"tag", "value"}});
+
+    EXPECT_EQ(expected, tags_t("name", {{"tag", "value"}}).to_map());
+}
+
+TEST(tags_t, TagsRange) {
+    const tags_t tags("name", {{"tag", "value"}});
+    const auto range = tags.tags();
+
+    ASSERT_EQ(2, range.size());
+    EXPECT_EQ(tags.begin(), range.begin());
+    EXPECT_EQ("name", *range.front().first);
+    EXPECT_EQ("value", *range.back().second);
+}
+
+TEST(tags_t, ManyTags) {
+    tags_t::container_type container;
+    for (int id = 0; id < 16; ++id) {
+        container[std::to_string(id)] = std::to_string(id * 2);
+    }
+
+    const tags_t tags("name", container);
+    container["name"] = "name";
+
+    EXPECT_EQ(17, tags.size());
+    EXPECT_EQ(container, tags.to_map());
+    EXPECT_EQ("14", *tags.tag("7"));
+    EXPECT_TRUE(tags == tags_t("name", container));
+}
+
+TEST(tags_t, LessBySize) {
+    tags_t tags1("name");
+    tags_t tags2("name", {{"tag", "value"}});
+
+    EXPECT_TRUE(tags1 < tags2);
+    EXPECT_FALSE(tags2 < tags1);
+}
+
+TEST(tags_view_t, Name) {
+    tags_view_t view("name");
+
+    EXPECT_EQ("name", view.name());
+    EXPECT_TRUE(view.begin() == view.end());
+}
+
+TEST(tags_view_t, EqualsToTags) {
+    const tags_view_t::value_type tags[] = {{"service", "storage"}, {"scope", "testing"}};
+    tags_view_t view("name", tags);
+
+    tags_t expected("name", {{"scope", "testing"}, {"service", "storage"}});
+
+    EXPECT_TRUE(view == expected);
+    EXPECT_EQ(expected.hash(), view.hash());
+}
+
+TEST(tags_view_t, NotEqualsToTags) {
+    const tags_view_t::value_type tags[] = {{"service", "storage"}};
+    tags_view_t view("name", tags);
+
+    EXPECT_TRUE(view != tags_t("name"));
+    EXPECT_TRUE(view != tags_t("other", {{"service", "storage"}}));
+    EXPECT_TRUE(view != tags_t("name", {{"service", "other"}}));
+    EXPECT_TRUE(view != tags_t("name", {{"service", "storage"}, {"scope", "testing"}}));
+}
+
+TEST(tags_view_t, IgnoresNameTag) {
+    const tags_view_t::value_type tags[] = {{"name", "other"}, {"service", "storage"}};
+    tags_view_t view("name", tags);
+
+    tags_t expected("name", {{"name", "other"}, {"service", "storage"}});
+
+    EXPECT_TRUE(view == expected);
+    EXPECT_EQ(expected.hash(), view.hash());
+}
+
 }  // namespace testing
 }  // namespace metrics
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include <metrics/accumulator/sliding/window.hpp>
+#include <metrics/meter.hpp>
+#include <metrics/registry.hpp>
+#include <metrics/ticker.hpp>
+#include <metrics/timer.hpp>
+
+namespace metrics {
+namespace testing {
+
+namespace {
+
+/// Waits until the given predicate becomes true, giving up after a second.
+template<typename F>
+auto eventually(F fn) -> bool {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+
+    while (!fn()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return true;
+}
+
+}  // namespace
+
+TEST(ticker_t, CallsSubscribers) {
+    ticker_t ticker(std::chrono::milliseconds(1));
+
+    std::atomic<int> ticks(0);
+    const auto id = ticker.subscribe([&] {
+        ++ticks;
+    });
+
+    EXPECT_TRUE(eventually([&] { return ticks.load() >= 3; }));
+
+    ticker.unsubscribe(id);
+    const auto last = ticks.load();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_EQ(last, ticks.load());
+}
+
+TEST(ticker_t, Interval) {
+    ticker_t ticker(std::chrono::milliseconds(1));
+    EXPECT_EQ(std::chrono::milliseconds(1), ticker.interval());
+    EXPECT_EQ(std::chrono::seconds(5), ticker_t().interval());
+}
+
+TEST(ticker_t, AttachesRegistryMeters) {
+    const auto ticker = std::make_shared<ticker_t>();
+    registry_t registry(ticker);
+
+    auto meter = registry.meter("meter");
+    auto timer = registry.timer<accumulator::sliding::window_t>("timer");
+
+    meter->mark(10);
+    timer->update(std::chrono::milliseconds(1));
+
+    EXPECT_EQ(10, meter->count());
+    EXPECT_EQ(1, timer->count());
+}
+
+TEST(ticker_t, RejectsUnexpectedInterval) {
+    // Moving averages expect 5 second ticks, so faster ticks would inflate rates.
+    EXPECT_THROW(registry_t(std::make_shared<ticker_t>(std::chrono::milliseconds(1))),
+                 std::invalid_argument);
+    EXPECT_THROW(registry_t(std::make_shared<ticker_t>(std::chrono::seconds(10))),
+                 std::invalid_argument);
+    EXPECT_NO_THROW(registry_t(std::make_shared<ticker_t>(std::chrono::seconds(5))));
+}
+
+}  // namespace testing
+}  // namespace metrics